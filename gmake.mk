@@ -21,10 +21,10 @@ CFLAGS := -I$(SRC_ROOT)/include
 OUT_DIR := $(BUILD_ROOT)/lib$(DEBUG_SUFFIX)$(NO_STRING_SUFFIX)$(UNICODE_SUFFIX)
 OBJ_DIR := $(BUILD_ROOT)/tmp$(DEBUG_SUFFIX)$(NO_STRING_SUFFIX)$(UNICODE_SUFFIX)
 
-GLOBAL_DEP := $(SRC_ROOT)/include/dropt.h $(SRC_ROOT)/include/dropt_string.h
+GLOBAL_DEP := $(SRC_ROOT)/include/dropt.h $(SRC_ROOT)/include/dropt_string.h $(SRC_ROOT)/include/dropt_index.h
 GLOBALXX_DEP := $(GLOBAL_DEP) $(SRC_ROOT)/include/droptxx.hpp
 LIB_OBJ_FILES := $(OBJ_DIR)/dropt.o $(OBJ_DIR)/dropt_handlers.o $(OBJ_DIR)/dropt_string.o
-OBJ_FILES := $(LIB_OBJ_FILES) $(OBJ_DIR)/test_dropt.o
+OBJ_FILES := $(LIB_OBJ_FILES) $(OBJ_DIR)/test_dropt.o $(OBJ_DIR)/dropt_gen.o $(OBJ_DIR)/bench_dropt.o
 OBJXX_FILES := $(OBJ_DIR)/droptxx.o
 
 DROPT_LIB := $(OUT_DIR)/libdropt.a
@@ -32,15 +32,19 @@ DROPTXX_LIB := $(OUT_DIR)/libdroptxx.a
 EXAMPLE_EXE := $(OBJ_DIR)/dropt_example
 EXAMPLEXX_EXE := $(OBJ_DIR)/droptxx_example
 TEST_EXE := $(OBJ_DIR)/test_dropt
+GEN_EXE := $(OBJ_DIR)/dropt_gen
+BENCH_EXE := $(OBJ_DIR)/bench_dropt
 
 
 # Targets --------------------------------------------------------------
 
-.PHONY: default all lib libxx
+.PHONY: default all lib libxx gen bench
 default: lib libxx
-all: default example examplexx test
+all: default example examplexx gen test
 lib: $(DROPT_LIB)
 libxx: $(DROPTXX_LIB)
+gen: $(GEN_EXE)
+bench: $(BENCH_EXE)
 
 
 .PHONY: example examplexx skip_example
@@ -81,7 +85,7 @@ $(EXAMPLEXX_EXE): $(OBJ_DIR)/%: $(OBJ_DIR)/%.o $(DROPTXX_LIB)
 	$(CXX) $(CFLAGS) $(CXXFLAGS) $< -L$(OUT_DIR) -ldroptxx -o $@
 
 $(OBJ_DIR)/%: $(OBJ_DIR)/%.o $(DROPT_LIB)
-	$(CC) $(CFLAGS) $< -L$(OUT_DIR) -ldropt -o $@
+	$(CC) $(CFLAGS) $< -L$(OUT_DIR) -ldropt -lm -o $@
 
 $(OBJ_FILES): $(OBJ_DIR)/%.o: $(SRC_ROOT)/src/%.c $(GLOBAL_DEP)
 $(OBJ_DIR)/dropt_example.o: $(OBJ_DIR)/%.o: $(SRC_ROOT)/%.c $(GLOBAL_DEP)
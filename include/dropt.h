@@ -77,6 +77,8 @@ enum
     dropt_error_mismatch,
     dropt_error_overflow,
     dropt_error_underflow,
+    dropt_error_response_file_depth,
+    dropt_error_ambiguous_option,
 
     /* Errors in the range [0x80, 0xFFFF] are free for clients to use. */
     dropt_error_custom_start = 0x80,
@@ -127,8 +129,15 @@ typedef dropt_error dropt_option_handler_decl(dropt_context* context,
 typedef dropt_option_handler_decl* dropt_option_handler_func;
 
 /** `dropt_error_handler_func` callbacks are responsible for generating error
-  * messages.  The returned string must be allocated on the heap and must be
-  * freeable with `free()`.
+  * messages.  The returned string must be allocated with the global allocator
+  * (e.g. with `dropt_strdup` or `dropt_asprintf`) and must be freeable with
+  * `dropt_free()`.
+  *
+  * Compatibility note: Prior to the introduction of `dropt_allocator`, the
+  * returned string had to be freeable with `free()`.  With the default
+  * global allocator, `dropt_free()` calls `free()`, so existing handlers
+  * that allocate with `malloc()` keep working unless a custom global
+  * allocator is installed with `dropt_set_allocator`.
   */
 typedef dropt_char* (*dropt_error_handler_func)(dropt_error error,
                                                 const dropt_char* optionName,
@@ -209,6 +218,41 @@ enum
 };
 
 
+/** `dropt_allocator` routes dropt's heap allocations to a custom allocator
+  * (see `dropt_set_allocator` and `dropt_set_context_allocator`).
+  *
+  * Memory that dropt returns to callers (e.g. from `dropt_strdup`,
+  * `dropt_asprintf`, `dropt_ssfinalize` and `dropt_get_help`) comes from the
+  * global allocator and must be released with `dropt_free()`, not `free()`.
+  * This breaks compatibility with code that calls `free()` on such memory,
+  * but only once a custom global allocator is installed: the default one
+  * uses `realloc` and `free`.
+  *
+  * reallocate:
+  *     Has the semantics of `realloc`.  dropt never requests 0 bytes.
+  *
+  * deallocate:
+  *     Has the semantics of `free`.  dropt never passes `NULL`.
+  *
+  * user_data:
+  *     Passed as the first argument to both functions.
+  */
+typedef struct dropt_allocator
+{
+    void* (*reallocate)(void* userData, void* p, size_t size);
+    void (*deallocate)(void* userData, void* p);
+    void* user_data;
+} dropt_allocator;
+
+
+/* The longest option name or argument that `dropt_arena_size` reserves
+ * space for in the error details.
+ */
+#ifndef DROPT_ARENA_ERROR_LENGTH
+#define DROPT_ARENA_ERROR_LENGTH 256
+#endif
+
+
 typedef struct dropt_help_params
 {
     unsigned int indent;
@@ -217,26 +261,273 @@ typedef struct dropt_help_params
 } dropt_help_params;
 
 
+/** `dropt_parse_result` holds the outcome of parsing one list of arguments
+  * with `dropt_parse_batch`.
+  */
+typedef struct dropt_parse_result
+{
+    /* The error encountered while parsing, if any. */
+    dropt_error err;
+
+    /* A pointer to the first unprocessed argument. */
+    dropt_char** rest;
+
+    /* The position and number of the entries recorded for this list on
+     * the context's result tape (see `dropt_set_result_tape`), if any.
+     */
+    size_t tape_start;
+    size_t tape_length;
+} dropt_parse_result;
+
+
+/** `dropt_arg_source` supplies arguments to `dropt_parse_source` on
+  * demand.
+  *
+  * peek:
+  *     Returns the next argument without consuming it, or `NULL` if there
+  *     are no more.  Calls without an intervening call to `next` must
+  *     return the same argument.
+  *
+  * next:
+  *     Consumes the argument returned by `peek`.
+  *
+  * source_data:
+  *     Passed to `peek` and `next`.
+  *
+  * Option handlers may keep pointers to arguments (as `dropt_handle_string`
+  * does), as may result tapes (see `dropt_set_result_tape`), so consumed
+  * arguments must remain valid for as long as those are in use.
+  */
+typedef struct dropt_arg_source
+{
+    dropt_char* (*peek)(void* sourceData);
+    void (*next)(void* sourceData);
+    void* source_data;
+} dropt_arg_source;
+
+
+/** `dropt_chunk_status` describes the outcome of `dropt_parse_chunk`.
+  *
+  * dropt_chunk_parsed:
+  *     The entire chunk was processed.
+  *
+  * dropt_chunk_need_argument:
+  *     The chunk ended with an option that is waiting for its value from
+  *     the next chunk.
+  *
+  * dropt_chunk_done:
+  *     Option processing stopped, either normally or because of an error.
+  */
+typedef enum
+{
+    dropt_chunk_parsed,
+    dropt_chunk_need_argument,
+    dropt_chunk_done
+} dropt_chunk_status;
+
+
+/** `dropt_tape_entry` records one matched option when parsing to a result
+  * tape (see `dropt_set_result_tape`).
+  *
+  * option_index:
+  *     The index of the matched option in the context's option list.  For
+  *     a subcommand's context (see `dropt_get_subcommand_context`), options
+  *     inherited from the parent context are numbered after the
+  *     subcommand's own, as if the parent's options were appended to them.
+  *     `dropt_get_option` maps the index back to the option.
+  *
+  * argument:
+  *     The option's argument, or `NULL` if none was specified.  This points
+  *     into the parsed argument list.
+  *
+  * argument_length:
+  *     The length of the argument, in `dropt_char`s.
+  */
+typedef struct dropt_tape_entry
+{
+    size_t option_index;
+    const dropt_char* argument;
+    size_t argument_length;
+} dropt_tape_entry;
+
+
+/** `dropt_subcommand` describes a subcommand, as in
+  * `prog [global options] <subcommand> [subcommand options]`.  Lists of
+  * subcommands (see `dropt_set_subcommands`) are terminated by an entry
+  * whose name is `NULL`.
+  *
+  * name:
+  *     The subcommand's name.  Subcommand names are matched exactly.
+  *
+  * options:
+  *     The subcommand's list of option specifications.  The list is *not*
+  *     copied and must outlive any dropt contexts created for it.
+  *
+  * description:
+  *     A description of the subcommand.  May be `NULL`.  dropt itself
+  *     doesn't use it.
+  */
+typedef struct dropt_subcommand
+{
+    const dropt_char* name;
+    const dropt_option* options;
+    const dropt_char* description;
+} dropt_subcommand;
+
+
+/** `dropt_quoting` selects how strings are split into arguments (see
+  * `dropt_split_command_line` and `dropt_enable_response_files`).  In all
+  * cases, arguments are separated by whitespace.
+  *
+  * dropt_quoting_none:
+  *     No splitting.  (Response files are not expanded.)
+  *
+  * dropt_quoting_gnu:
+  *     Single and double quotes group characters, and a backslash escapes
+  *     any character, as with GCC response files.
+  *
+  * dropt_quoting_msvc:
+  *     Double quotes group characters, and backslashes are literal except
+  *     before double quotes, as with `CommandLineToArgvW`.
+  *
+  * dropt_quoting_posix:
+  *     Quotes and backslashes work as with the POSIX shell: a backslash
+  *     escapes any character (and removes a following newline) outside of
+  *     quotes, nothing is special within single quotes, and a backslash
+  *     escapes only '$', '`', '"', '\\' and newline within double quotes.
+  *     There are no expansions or comments.
+  */
+typedef enum
+{
+    dropt_quoting_none,
+    dropt_quoting_gnu,
+    dropt_quoting_msvc,
+    dropt_quoting_posix
+} dropt_quoting;
+
+
+/* The default limit on how deeply response files may be nested. */
+#ifndef DROPT_RESPONSE_FILE_MAX_DEPTH
+#define DROPT_RESPONSE_FILE_MAX_DEPTH 16
+#endif
+
+
+/** `dropt_error_location` locates the cause of a parsing error in the
+  * parsed argument list (see `dropt_defer_error_details`).
+  *
+  * option_index:
+  *     The index of the argument with the option name.
+  *
+  * option_offset, option_length:
+  *     The position and length, in `dropt_char`s, of the option name within
+  *     that argument.  For long options, this includes the leading dashes.
+  *     For short options, this covers only the option's character.
+  *
+  * has_argument:
+  *     Whether the error involves an option argument.
+  *
+  * argument_index, argument_offset:
+  *     The index of the argument with the option argument and the option
+  *     argument's position within it.  The option argument extends to the
+  *     end of the argument.
+  */
+typedef struct dropt_error_location
+{
+    size_t option_index;
+    size_t option_offset;
+    size_t option_length;
+    dropt_bool has_argument;
+    size_t argument_index;
+    size_t argument_offset;
+} dropt_error_location;
+
+
+void dropt_set_allocator(const dropt_allocator* allocator);
+void dropt_get_allocator(dropt_allocator* allocator);
+void dropt_free(void* p);
+
 dropt_context* dropt_new_context(const dropt_option* options);
+dropt_context* dropt_new_composite_context(dropt_context* const* parts,
+                                           size_t numParts);
+size_t dropt_arena_size(const dropt_option* options);
+dropt_context* dropt_new_context_in_arena(const dropt_option* options,
+                                          void* buffer, size_t bufferSize);
+size_t dropt_context_size(size_t numOptions, size_t maxNameLength);
+dropt_context* dropt_init_context_in(void* buffer, size_t bufferSize,
+                                     const dropt_option* options);
+void dropt_reset_context(dropt_context* context);
+dropt_context* dropt_new_context_from_index(const dropt_option* options,
+                                            const void* index,
+                                            size_t indexSize);
 void dropt_free_context(dropt_context* context);
 
+dropt_error dropt_freeze_context(dropt_context* context);
+dropt_context* dropt_new_parse_context(const dropt_context* frozenContext);
+
+size_t dropt_serialize_index(dropt_context* context,
+                             void* buffer, size_t bufferSize);
+
+void dropt_set_subcommands(dropt_context* context,
+                           const dropt_subcommand* subcommands);
+const dropt_subcommand* dropt_find_subcommand(dropt_context* context,
+                                              const dropt_char* name);
+dropt_context* dropt_get_subcommand_context(dropt_context* context,
+                                            const dropt_subcommand* subcommand);
+
 const dropt_option* dropt_get_options(const dropt_context* context);
+const dropt_option* dropt_get_option(const dropt_context* context,
+                                     size_t index);
 
 void dropt_set_error_handler(dropt_context* context,
                              dropt_error_handler_func handler,
                              void* handlerData);
 void dropt_set_strncmp(dropt_context* context, dropt_strncmp_func cmp);
+void dropt_set_case_insensitive(dropt_context* context, dropt_bool enable);
+void dropt_enable_hashed_lookup(dropt_context* context, dropt_bool enable);
+void dropt_allow_abbreviations(dropt_context* context, dropt_bool allow);
+void dropt_enable_suggestions(dropt_context* context,
+                              unsigned int maxSuggestions);
+void dropt_set_context_allocator(dropt_context* context,
+                                 const dropt_allocator* allocator);
+void dropt_defer_error_details(dropt_context* context, dropt_bool defer);
+void dropt_enable_response_files(dropt_context* context,
+                                 dropt_quoting syntax,
+                                 unsigned int maxDepth);
+
+void dropt_set_result_tape(dropt_context* context,
+                           dropt_tape_entry* tape, size_t capacity);
+size_t dropt_get_tape_length(const dropt_context* context);
 
 /* Use this only for backward compatibility purposes. */
 void dropt_allow_concatenated_arguments(dropt_context* context,
                                         dropt_bool allow);
 
+size_t dropt_split_command_line(const dropt_char* commandLine,
+                                dropt_quoting quoting,
+                                dropt_char* buffer,
+                                dropt_char** argv, size_t maxArgs);
+
 dropt_char** dropt_parse(dropt_context* context, int argc, dropt_char** argv);
+dropt_error dropt_parse_source(dropt_context* context,
+                               const dropt_arg_source* source);
+void dropt_begin_incremental_parse(dropt_context* context);
+dropt_chunk_status dropt_parse_chunk(dropt_context* context,
+                                     int argc, dropt_char** argv,
+                                     dropt_char*** rest);
+dropt_error dropt_end_incremental_parse(dropt_context* context);
+size_t dropt_parse_batch(dropt_context* context, size_t n,
+                         const int* argcs, dropt_char** const* argvs,
+                         dropt_parse_result* results);
 
 dropt_error dropt_get_error(const dropt_context* context);
 void dropt_get_error_details(const dropt_context* context,
                              dropt_char** optionName,
                              dropt_char** optionArgument);
+dropt_bool dropt_get_error_location(const dropt_context* context,
+                                    dropt_error_location* location);
+size_t dropt_get_error_candidates(const dropt_context* context,
+                                  const dropt_option** candidates,
+                                  size_t maxCandidates);
 const dropt_char* dropt_get_error_message(dropt_context* context);
 void dropt_clear_error(dropt_context* context);
 
@@ -259,9 +550,19 @@ dropt_option_handler_decl dropt_handle_verbose_bool;
 dropt_option_handler_decl dropt_handle_int;
 dropt_option_handler_decl dropt_handle_uint;
 dropt_option_handler_decl dropt_handle_double;
+dropt_option_handler_decl dropt_handle_float;
+dropt_option_handler_decl dropt_handle_long_double;
 dropt_option_handler_decl dropt_handle_string;
 dropt_option_handler_decl dropt_handle_const;
 
+/* Locale-independent number parsers used by the stock handlers. */
+dropt_error dropt_parse_long(const dropt_char* s, int base, long* out);
+dropt_error dropt_parse_ulong(const dropt_char* s, int base, unsigned long* out);
+dropt_error dropt_parse_double(const dropt_char* s, double* out);
+dropt_error dropt_parse_float(const dropt_char* s, float* out);
+dropt_error dropt_parse_long_double(const dropt_char* s, long double* out);
+
+
 #define DROPT_MISUSE(message) dropt_misuse(message, __FILE__, __LINE__)
 void dropt_misuse(const char* message, const char* filename, int line);
 
@@ -0,0 +1,78 @@
+/** dropt_index.h
+  *
+  * The layout of serialized dropt lookup indices (see
+  * `dropt_serialize_index`), shared by dropt and by code that generates
+  * indices itself (e.g. droptxx_static.hpp).
+  *
+  * Copyright (C) 2006-2018 James D. Lin <jamesdlin@berkeley.edu>
+  *
+  * The latest version of this file can be downloaded from:
+  * <http://www.taenarum.com/software/dropt/>
+  *
+  * This software is provided 'as-is', without any express or implied
+  * warranty.  In no event will the authors be held liable for any damages
+  * arising from the use of this software.
+  *
+  * Permission is granted to anyone to use this software for any purpose,
+  * including commercial applications, and to alter it and redistribute it
+  * freely, subject to the following restrictions:
+  *
+  * 1. The origin of this software must not be misrepresented; you must not
+  *    claim that you wrote the original software. If you use this software
+  *    in a product, an acknowledgment in the product documentation would be
+  *    appreciated but is not required.
+  *
+  * 2. Altered source versions must be plainly marked as such, and must not be
+  *    misrepresented as being the original software.
+  *
+  * 3. This notice may not be removed or altered from any source distribution.
+  */
+
+#ifndef DROPT_INDEX_H
+#define DROPT_INDEX_H
+
+/* A serialized index is a sequence of 32-bit values in the native byte
+ * order.  It begins with a header of `DROPT_INDEX_HEADER_LENGTH` values:
+ * the magic number, the version, the size of `dropt_char`, the number of
+ * options, the number of long names, the number of short-name slots, the
+ * number of hash buckets and the number of hash slots.  Positions within
+ * the header are given by the `DROPT_INDEX_FIELD_*` macros.
+ *
+ * The header is followed by:
+ *
+ *   * The long names' lengths, their option indices (sorted by name), and
+ *     then their first `DROPT_INDEX_PREFIX_LENGTH` characters, padded with
+ *     `NUL`s.
+ *   * The short-name slots.  For narrow characters, there is one slot per
+ *     byte value, holding an option index or `DROPT_INDEX_EMPTY_SLOT`.
+ *   * The optional long-name hash.
+ */
+
+/* The magic number also catches indices produced on machines with a
+ * different byte order.
+ */
+#define DROPT_INDEX_MAGIC 0x54504F44UL /* "DOPT" */
+#define DROPT_INDEX_VERSION 1
+
+#define DROPT_INDEX_HEADER_LENGTH 8
+
+#define DROPT_INDEX_FIELD_MAGIC 0
+#define DROPT_INDEX_FIELD_VERSION 1
+#define DROPT_INDEX_FIELD_CHAR_SIZE 2
+#define DROPT_INDEX_FIELD_NUM_OPTIONS 3
+#define DROPT_INDEX_FIELD_LONG_COUNT 4
+#define DROPT_INDEX_FIELD_NUM_SHORT_SLOTS 5
+#define DROPT_INDEX_FIELD_NUM_HASH_BUCKETS 6
+#define DROPT_INDEX_FIELD_NUM_HASH_SLOTS 7
+
+/* The number of leading characters of each long name stored inline.
+ * `DROPT_INDEX_PREFIX_LENGTH * sizeof (dropt_char)` must be a multiple of 4.
+ */
+#define DROPT_INDEX_PREFIX_LENGTH 8
+
+/* The number of short-name slots for narrow characters. */
+#define DROPT_INDEX_NARROW_SHORT_SLOTS 256
+
+#define DROPT_INDEX_EMPTY_SLOT 0xFFFFFFFFUL
+
+#endif /* DROPT_INDEX_H */
@@ -41,6 +41,8 @@
     #define dropt_strtol wcstol
     #define dropt_strtoul wcstoul
     #define dropt_strtod wcstod
+    #define dropt_strtof wcstof
+    #define dropt_strtold wcstold
     #define dropt_tolower towlower
     #define dropt_fputs fputws
 #else
@@ -51,6 +53,8 @@
     #define dropt_strtol strtol
     #define dropt_strtoul strtoul
     #define dropt_strtod strtod
+    #define dropt_strtof strtof
+    #define dropt_strtold strtold
     #define dropt_tolower tolower
     #define dropt_fputs fputs
 #endif
@@ -60,6 +64,10 @@
 extern "C" {
 #endif
 
+void* dropt_allocator_realloc(const dropt_allocator* allocator,
+                              void* p, size_t numElements, size_t elementSize);
+void dropt_allocator_free(const dropt_allocator* allocator, void* p);
+
 void* dropt_safe_malloc(size_t numElements, size_t elementSize);
 void* dropt_safe_realloc(void* p, size_t numElements, size_t elementSize);
 
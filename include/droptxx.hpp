@@ -29,6 +29,7 @@
 #ifndef DROPT_HPP
 #define DROPT_HPP
 
+#include <cstddef>
 #include <string>
 #include <iostream>
 
@@ -85,20 +86,52 @@ public:
     dropt_context* raw();
 
     const dropt_option* get_options() const;
+    const dropt_option* get_option(std::size_t index) const;
 
     void set_error_handler(dropt_error_handler_func handler, void* handlerData);
     void set_strncmp(dropt_strncmp_func cmp);
+    void set_case_insensitive(bool enable = true);
+    void enable_hashed_lookup(bool enable = true);
+    void allow_abbreviations(bool allow = true);
+    void enable_suggestions(unsigned int maxSuggestions);
+
+    std::size_t serialize_index(void* buffer, std::size_t bufferSize);
+
+    void set_subcommands(const dropt_subcommand* subcommands);
+    const dropt_subcommand* find_subcommand(const dropt_char* name);
+    dropt_context* get_subcommand_context(const dropt_subcommand* subcommand);
+
+    dropt_error freeze();
+    void set_allocator(const dropt_allocator* allocator);
+    void defer_error_details(bool defer = true);
+    void enable_response_files(dropt_quoting syntax,
+                               unsigned int maxDepth = 0);
+
+    void set_result_tape(dropt_tape_entry* tape, std::size_t capacity);
+    std::size_t get_tape_length() const;
 
     // Use this only for backward compatibility purposes.
     void allow_concatenated_arguments(bool allow = true);
 
     dropt_char** parse(int argc, dropt_char** argv);
     dropt_char** parse(dropt_char** argv);
+    dropt_error parse_source(const dropt_arg_source& source);
+    void begin_incremental_parse();
+    dropt_chunk_status parse_chunk(int argc, dropt_char** argv,
+                                   dropt_char*** rest = NULL);
+    dropt_error end_incremental_parse();
+    std::size_t parse_batch(std::size_t n, const int* argcs,
+                            dropt_char** const* argvs,
+                            dropt_parse_result* results);
 
     dropt_error get_error() const;
     void get_error_details(dropt_char** optionName, dropt_char** optionArgument) const;
+    bool get_error_location(dropt_error_location* location) const;
+    std::size_t get_error_candidates(const dropt_option** candidates,
+                                     std::size_t maxCandidates) const;
     const dropt_char* get_error_message();
     void clear_error();
+    void reset();
 
 #ifndef DROPT_NO_STRING_BUFFERS
     string get_help(const help_params& helpParams = help_params()) const;
@@ -117,6 +150,9 @@ class context
 {
 public:
     explicit context(const dropt_option* options);
+    context(dropt_context* const* parts, std::size_t numParts);
+    context(const dropt_option* options,
+            const void* index, std::size_t indexSize);
     ~context();
 
 private:
@@ -136,6 +172,8 @@ dropt_option_handler_decl handle_string;
 dropt_option_handler_decl handle_int;
 dropt_option_handler_decl handle_uint;
 dropt_option_handler_decl handle_double;
+dropt_option_handler_decl handle_float;
+dropt_option_handler_decl handle_long_double;
 
 
 } // namespace dropt
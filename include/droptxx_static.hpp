@@ -0,0 +1,391 @@
+/** droptxx_static.hpp
+  *
+  * Compile-time option tables for dropt.  Requires C++17.
+  *
+  * Copyright (C) 2008-2018 James D. Lin <jamesdlin@berkeley.edu>
+  *
+  * The latest version of this file can be downloaded from:
+  * <http://www.taenarum.com/software/dropt/>
+  *
+  * This software is provided 'as-is', without any express or implied
+  * warranty.  In no event will the authors be held liable for any damages
+  * arising from the use of this software.
+  *
+  * Permission is granted to anyone to use this software for any purpose,
+  * including commercial applications, and to alter it and redistribute it
+  * freely, subject to the following restrictions:
+  *
+  * 1. The origin of this software must not be misrepresented; you must not
+  *    claim that you wrote the original software. If you use this software
+  *    in a product, an acknowledgment in the product documentation would be
+  *    appreciated but is not required.
+  *
+  * 2. Altered source versions must be plainly marked as such, and must not be
+  *    misrepresented as being the original software.
+  *
+  * 3. This notice may not be removed or altered from any source distribution.
+  */
+
+#ifndef DROPT_STATIC_HPP
+#define DROPT_STATIC_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "droptxx.hpp"
+#include "dropt_index.h"
+
+
+// The layout of the precomputed index depends on the byte order.
+#if    (defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) \
+    || (!defined __BYTE_ORDER__ && defined _WIN32)
+    #define DROPT_STATIC_LITTLE_ENDIAN 1
+#elif defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    #define DROPT_STATIC_BIG_ENDIAN 1
+#endif
+
+
+namespace dropt
+{
+
+
+namespace detail
+{
+
+
+// Compares strings the same way that `dropt_strncmp` does, treating a
+// string that is a prefix of another as the lesser one.
+constexpr int
+static_compare(std::basic_string_view<dropt_char> s,
+               std::basic_string_view<dropt_char> t)
+{
+    typedef std::conditional_t<sizeof (dropt_char) == 1,
+                               unsigned char, dropt_char> unit;
+    std::size_t n = (s.size() < t.size()) ? s.size() : t.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        if (s[i] != t[i])
+        {
+            return (static_cast<unit>(s[i]) < static_cast<unit>(t[i])) ? -1 : +1;
+        }
+    }
+    return (s.size() < t.size()) ? -1 : (s.size() > t.size()) ? +1 : 0;
+}
+
+
+constexpr bool
+is_sentinel(const dropt_option& option)
+{
+    return    option.long_name == nullptr
+           && option.short_name == DROPT_TEXT_LITERAL('\0')
+           && option.description == nullptr
+           && option.arg_description == nullptr
+           && option.handler == nullptr
+           && option.dest == nullptr
+           && option.attr == 0
+           && option.extra_data == 0;
+}
+
+
+// The serialized index format (see dropt_index.h).
+enum : std::uint32_t
+{
+    index_magic = DROPT_INDEX_MAGIC,
+    index_version = DROPT_INDEX_VERSION,
+    index_header_size = DROPT_INDEX_HEADER_LENGTH,
+    index_prefix_length = DROPT_INDEX_PREFIX_LENGTH,
+    index_prefix_words = index_prefix_length * sizeof (dropt_char)
+                         / sizeof (std::uint32_t),
+    index_short_slots = DROPT_INDEX_NARROW_SHORT_SLOTS,
+    index_empty_slot = DROPT_INDEX_EMPTY_SLOT
+};
+
+
+} // namespace detail
+
+
+/** `dropt::static_table` validates and sorts an option table at compile
+  * time.  Declare both the options and the table `constexpr`:
+  *
+  *     static constexpr dropt_option options[] = { ..., { 0 } };
+  *     static constexpr auto table = dropt::make_static_table(options);
+  *
+  * The options must end with the usual sentinel.  Duplicate names and names
+  * containing '=' fail the build (or throw `std::invalid_argument` if the
+  * table is constructed at run-time).
+  *
+  * The table can look up options by itself, and it precomputes the lookup
+  * index that `dropt_new_context_from_index` expects, so contexts created
+  * from it don't sort or allocate lookup tables at run-time.  The index is
+  * unavailable (and `index_size()` returns 0) for `wchar_t` builds and for
+  * platforms with an unknown byte order; `dropt::context` then falls back to
+  * building the index itself.
+  */
+template<std::size_t N>
+class static_table
+{
+    static_assert(N >= 1, "The option table must end with a sentinel.");
+
+public:
+    constexpr explicit static_table(const dropt_option (&options)[N]);
+
+    constexpr const dropt_option* options() const { return mOptions; }
+    constexpr std::size_t size() const { return N - 1; }
+
+    constexpr const dropt_option* find_long(std::basic_string_view<dropt_char> longName) const;
+    constexpr const dropt_option* find_short(dropt_char shortName) const;
+
+    const void* index() const { return mIndex.data(); }
+    constexpr std::size_t index_size() const { return mIndexSize; }
+
+private:
+    static constexpr std::size_t index_capacity
+        = detail::index_header_size
+          + N * (2 + detail::index_prefix_words)
+          + detail::index_short_slots;
+
+    constexpr std::basic_string_view<dropt_char> long_name(std::size_t i) const
+    {
+        return mOptions[i].long_name;
+    }
+
+    constexpr void build_index();
+
+    const dropt_option* mOptions;
+
+    // Indices of the options with long names, sorted by name.
+    std::array<std::size_t, N> mSortedByLong {};
+    std::size_t mNumLong = 0;
+
+    // Indices of the options with short names, sorted by name.
+    std::array<std::size_t, N> mSortedByShort {};
+    std::size_t mNumShort = 0;
+
+    std::array<std::uint32_t, index_capacity> mIndex {};
+    std::size_t mIndexSize = 0;
+};
+
+
+/** dropt::static_table::static_table
+  *
+  *     `dropt::static_table` constructor.
+  *
+  * PARAMETERS:
+  *     IN options : The list of option specifications, including the
+  *                    terminating sentinel.
+  *                  The list is *not* copied and must outlive the table.
+  */
+template<std::size_t N>
+constexpr
+static_table<N>::static_table(const dropt_option (&options)[N])
+: mOptions(options)
+{
+    if (!detail::is_sentinel(options[N - 1]))
+    {
+        throw std::invalid_argument("The option table must end with a sentinel.");
+    }
+
+    for (std::size_t i = 0; i + 1 < N; i++)
+    {
+        const dropt_option& option = options[i];
+        if (detail::is_sentinel(option))
+        {
+            throw std::invalid_argument("Unexpected sentinel in the option table.");
+        }
+
+        if (option.short_name != DROPT_TEXT_LITERAL('\0'))
+        {
+            if (option.short_name == DROPT_TEXT_LITERAL('='))
+            {
+                throw std::invalid_argument("'=' may not be used in an option name.");
+            }
+
+            // Insertion sort.
+            std::size_t j = mNumShort++;
+            for (; j > 0; j--)
+            {
+                dropt_char other = options[mSortedByShort[j - 1]].short_name;
+                if (other == option.short_name)
+                {
+                    throw std::invalid_argument("Duplicate short option name.");
+                }
+                if (detail::static_compare({ &other, 1 }, { &option.short_name, 1 }) < 0)
+                {
+                    break;
+                }
+                mSortedByShort[j] = mSortedByShort[j - 1];
+            }
+            mSortedByShort[j] = i;
+        }
+
+        if (option.long_name != nullptr)
+        {
+            std::basic_string_view<dropt_char> name = option.long_name;
+            if (name.find(DROPT_TEXT_LITERAL('=')) != name.npos)
+            {
+                throw std::invalid_argument("'=' may not be used in an option name.");
+            }
+
+            std::size_t j = mNumLong++;
+            for (; j > 0; j--)
+            {
+                int ret = detail::static_compare(long_name(mSortedByLong[j - 1]), name);
+                if (ret == 0)
+                {
+                    throw std::invalid_argument("Duplicate long option name.");
+                }
+                if (ret < 0) { break; }
+                mSortedByLong[j] = mSortedByLong[j - 1];
+            }
+            mSortedByLong[j] = i;
+        }
+    }
+
+    build_index();
+}
+
+
+/** dropt::static_table::find_long
+  *
+  * PARAMETERS:
+  *     IN longName : The long option name to search for (excluding leading
+  *                     dashes).
+  *
+  * RETURNS:
+  *     A pointer to the corresponding option specification or `nullptr` if
+  *       not found.
+  */
+template<std::size_t N>
+constexpr const dropt_option*
+static_table<N>::find_long(std::basic_string_view<dropt_char> longName) const
+{
+    std::size_t lo = 0;
+    std::size_t hi = mNumLong;
+    while (lo < hi)
+    {
+        std::size_t mid = lo + (hi - lo) / 2;
+        int ret = detail::static_compare(longName, long_name(mSortedByLong[mid]));
+        if (ret == 0) { return &mOptions[mSortedByLong[mid]]; }
+        if (ret < 0) { hi = mid; } else { lo = mid + 1; }
+    }
+    return nullptr;
+}
+
+
+/** dropt::static_table::find_short
+  *
+  * PARAMETERS:
+  *     IN shortName : The short option name to search for.
+  *
+  * RETURNS:
+  *     A pointer to the corresponding option specification or `nullptr` if
+  *       not found.
+  */
+template<std::size_t N>
+constexpr const dropt_option*
+static_table<N>::find_short(dropt_char shortName) const
+{
+    std::size_t lo = 0;
+    std::size_t hi = mNumShort;
+    while (lo < hi)
+    {
+        std::size_t mid = lo + (hi - lo) / 2;
+        const dropt_char* other = &mOptions[mSortedByShort[mid]].short_name;
+        int ret = detail::static_compare({ &shortName, 1 }, { other, 1 });
+        if (ret == 0) { return &mOptions[mSortedByShort[mid]]; }
+        if (ret < 0) { hi = mid; } else { lo = mid + 1; }
+    }
+    return nullptr;
+}
+
+
+/** dropt::static_table::build_index
+  *
+  *     Builds the serialized lookup index (see `dropt_serialize_index`).
+  */
+template<std::size_t N>
+constexpr void
+static_table<N>::build_index()
+{
+#if    !defined DROPT_USE_WCHAR \
+    && (defined DROPT_STATIC_LITTLE_ENDIAN || defined DROPT_STATIC_BIG_ENDIAN)
+    // The header.  There is no hash.
+    mIndex[DROPT_INDEX_FIELD_MAGIC] = detail::index_magic;
+    mIndex[DROPT_INDEX_FIELD_VERSION] = detail::index_version;
+    mIndex[DROPT_INDEX_FIELD_CHAR_SIZE] = sizeof (dropt_char);
+    mIndex[DROPT_INDEX_FIELD_NUM_OPTIONS] = static_cast<std::uint32_t>(N - 1);
+    mIndex[DROPT_INDEX_FIELD_LONG_COUNT] = static_cast<std::uint32_t>(mNumLong);
+    mIndex[DROPT_INDEX_FIELD_NUM_SHORT_SLOTS] = detail::index_short_slots;
+    mIndex[DROPT_INDEX_FIELD_NUM_HASH_BUCKETS] = 0;
+    mIndex[DROPT_INDEX_FIELD_NUM_HASH_SLOTS] = 0;
+    std::size_t p = detail::index_header_size;
+
+    // The long name index: lengths, option indices, then prefixes.
+    for (std::size_t i = 0; i < mNumLong; i++)
+    {
+        mIndex[p++] = static_cast<std::uint32_t>(long_name(mSortedByLong[i]).size());
+    }
+    for (std::size_t i = 0; i < mNumLong; i++)
+    {
+        mIndex[p++] = static_cast<std::uint32_t>(mSortedByLong[i]);
+    }
+    for (std::size_t i = 0; i < mNumLong; i++)
+    {
+        std::basic_string_view<dropt_char> name = long_name(mSortedByLong[i]);
+        for (std::size_t w = 0; w < detail::index_prefix_words; w++)
+        {
+            std::uint32_t word = 0;
+            for (std::size_t b = 0; b < sizeof (std::uint32_t); b++)
+            {
+                std::size_t k = w * sizeof (std::uint32_t) + b;
+                std::uint32_t c = (k < name.size())
+                                  ? static_cast<unsigned char>(name[k])
+                                  : 0;
+    #ifdef DROPT_STATIC_LITTLE_ENDIAN
+                word |= c << (8 * b);
+    #else
+                word |= c << (8 * (sizeof (std::uint32_t) - 1 - b));
+    #endif
+            }
+            mIndex[p++] = word;
+        }
+    }
+
+    // The short name table.
+    for (std::size_t i = 0; i < detail::index_short_slots; i++)
+    {
+        mIndex[p + i] = detail::index_empty_slot;
+    }
+    for (std::size_t i = 0; i < mNumShort; i++)
+    {
+        unsigned char c = static_cast<unsigned char>(mOptions[mSortedByShort[i]].short_name);
+        mIndex[p + c] = static_cast<std::uint32_t>(mSortedByShort[i]);
+    }
+    p += detail::index_short_slots;
+
+    mIndexSize = p * sizeof (std::uint32_t);
+#endif
+}
+
+
+/** dropt::make_static_table
+  *
+  *     Creates a `dropt::static_table` without needing to spell out the
+  *     number of options.
+  */
+template<std::size_t N>
+constexpr static_table<N>
+make_static_table(const dropt_option (&options)[N])
+{
+    return static_table<N>(options);
+}
+
+
+} // namespace dropt
+
+
+#endif // DROPT_STATIC_HPP
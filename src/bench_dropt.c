@@ -0,0 +1,870 @@
+/** bench_dropt.c
+  *
+  * Microbenchmarks for dropt.
+  *
+  * Usage: bench_dropt [FILTER]
+  *
+  * Runs every benchmark whose name contains FILTER (or all of them) and
+  * reports the time per argument and the number of heap allocations that
+  * dropt makes per parse.  Each benchmark runs for at least `min_seconds`, doubling its
+  * iteration count until then.
+  *
+  * Copyright (C) 2007-2018 James D. Lin <jamesdlin@berkeley.edu>
+  *
+  * This software is provided 'as-is', without any express or implied
+  * warranty.  In no event will the authors be held liable for any damages
+  * arising from the use of this software.
+  *
+  * Permission is granted to anyone to use this software for any purpose,
+  * including commercial applications, and to alter it and redistribute it
+  * freely, subject to the following restrictions:
+  *
+  * 1. The origin of this software must not be misrepresented; you must not
+  *    claim that you wrote the original software. If you use this software
+  *    in a product, an acknowledgment in the product documentation would be
+  *    appreciated but is not required.
+  * 2. Altered source versions must be plainly marked as such, and must not be
+  *    misrepresented as being the original software.
+  * 3. This notice may not be removed or altered from any source distribution.
+  */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+#if !defined _WIN32 && !defined _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "dropt.h"
+#include "dropt_string.h"
+
+/* For convenience. */
+#define T(s) DROPT_TEXT_LITERAL(s)
+
+#ifndef ARRAY_LENGTH
+#define ARRAY_LENGTH(array) (sizeof (array) / sizeof (array)[0])
+#endif
+
+#if __STDC_VERSION__ >= 199901L
+    #include <stdbool.h>
+#else
+    typedef enum { false, true } bool;
+#endif
+
+enum
+{
+    /* The number of arguments parsed by each iteration of the parsing
+     * benchmarks.
+     */
+    args_per_parse = 32,
+
+    max_name_length = 16
+};
+
+static const double min_seconds = 0.25;
+
+static const char* benchFilter = NULL;
+
+
+/* Allocation counting ------------------------------------------------ */
+
+static unsigned long allocCount = 0;
+
+
+/** counting_reallocate
+  *
+  *     A `dropt_allocator` reallocation function that counts allocations.
+  */
+static void*
+counting_reallocate(void* userData, void* p, size_t size)
+{
+    (void) userData;
+    allocCount++;
+    return realloc(p, size);
+}
+
+
+static void
+counting_deallocate(void* userData, void* p)
+{
+    (void) userData;
+    free(p);
+}
+
+
+/* Timing ------------------------------------------------------------- */
+
+/** now
+  *
+  * RETURNS:
+  *     A monotonic time in seconds.
+  */
+static double
+now(void)
+{
+#if defined _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double) counter.QuadPart / (double) frequency.QuadPart;
+#elif defined CLOCK_MONOTONIC
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+
+/* A benchmark body runs `iterations` iterations of the measured work. */
+typedef void (*bench_func)(unsigned long iterations, void* data);
+
+
+/** run_benchmark
+  *
+  *     Runs a benchmark until it takes at least `min_seconds` and prints its
+  *     results.
+  *
+  * PARAMETERS:
+  *     IN name          : The name of the benchmark.
+  *     IN func          : The benchmark body.
+  *     IN data          : Data to pass to `func`.
+  *     IN argsPerIter   : The number of arguments (or items) that each
+  *                          iteration processes.
+  */
+static void
+run_benchmark(const char* name, bench_func func, void* data,
+              size_t argsPerIter)
+{
+    unsigned long iterations = 1;
+    unsigned long allocs = 0;
+    double elapsed;
+
+    if (benchFilter != NULL && strstr(name, benchFilter) == NULL) { return; }
+
+    /* Warm up (and let contexts build their lookup tables). */
+    func(1, data);
+
+    for (;;)
+    {
+        double start;
+        allocCount = 0;
+        start = now();
+        func(iterations, data);
+        elapsed = now() - start;
+        allocs = allocCount;
+
+        if (elapsed >= min_seconds || iterations >= (unsigned long) -1 / 2)
+        {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    printf("%-28s %12lu %12.1f ns/arg %10.2f allocs/parse\n",
+           name, iterations, elapsed * 1e9 / ((double) iterations * argsPerIter),
+           (double) allocs / iterations);
+}
+
+
+/* Option tables ------------------------------------------------------ */
+
+static dropt_bool boolSink;
+static int intSink;
+
+typedef struct
+{
+    dropt_option* options;
+    dropt_char* names;
+    dropt_context* context;
+    dropt_char** args;
+    dropt_char* argBuf;
+    size_t numArgs;
+} parse_bench;
+
+
+/** format_name
+  *
+  *     Writes "<prefix><n><suffix>" to a buffer, truncating it to
+  *     `max_name_length - 1` characters if necessary.
+  *
+  * PARAMETERS:
+  *     OUT buf     : The output buffer.
+  *                   Must have room for `max_name_length` characters.
+  *     IN prefix   : The prefix.
+  *     IN n        : The number to append.
+  *     IN suffix   : A suffix to append.  May be `NULL`.
+  */
+static void
+format_name(dropt_char* buf, const char* prefix, size_t n,
+            const char* suffix)
+{
+    /* Each byte of an unsigned long needs fewer than 3 decimal digits. */
+    char digits[3 * sizeof (unsigned long) + 1];
+    const char* parts[3];
+    size_t len = 0;
+    size_t i;
+
+    sprintf(digits, "%lu", (unsigned long) n);
+    parts[0] = prefix;
+    parts[1] = digits;
+    parts[2] = (suffix == NULL) ? "" : suffix;
+
+    for (i = 0; i < ARRAY_LENGTH(parts); i++)
+    {
+        const char* s;
+        for (s = parts[i]; *s != '\0' && len < max_name_length - 1; s++)
+        {
+            buf[len++] = (dropt_char) *s;
+        }
+    }
+    buf[len] = T('\0');
+}
+
+
+/** init_parse_bench
+  *
+  *     Creates an option table of `numOptions` long options named "oN" and
+  *     a list of arguments that use options spread across the table.
+  *
+  * PARAMETERS:
+  *     OUT bench       : The benchmark data to initialize.
+  *     IN numOptions   : The number of options.
+  *     IN argPrefix    : The prefix of each argument ("--o" or "--O").
+  *     IN argSuffix    : A suffix for each argument (e.g. "=123").
+  *                       May be `NULL`.
+  *     IN handler      : The handler for every option.
+  *     IN dest         : The destination for every option.
+  *
+  * RETURNS:
+  *     `true` on success, `false` on failure.
+  */
+static bool
+init_parse_bench(parse_bench* bench, size_t numOptions,
+                 const char* argPrefix, const char* argSuffix,
+                 dropt_option_handler_func handler, void* dest)
+{
+    size_t i;
+
+    memset(bench, 0, sizeof *bench);
+
+    bench->options = calloc(numOptions + 1, sizeof *bench->options);
+    bench->names = calloc(numOptions, max_name_length * sizeof *bench->names);
+    bench->args = calloc(args_per_parse + 1, sizeof *bench->args);
+    bench->argBuf = calloc(args_per_parse,
+                           max_name_length * sizeof *bench->argBuf);
+    if (   bench->options == NULL || bench->names == NULL
+        || bench->args == NULL || bench->argBuf == NULL)
+    {
+        return false;
+    }
+
+    for (i = 0; i < numOptions; i++)
+    {
+        dropt_char* name = &bench->names[i * max_name_length];
+        format_name(name, "o", i, NULL);
+        bench->options[i].long_name = name;
+        bench->options[i].description = T("A generated option.");
+        bench->options[i].arg_description = (argSuffix == NULL)
+                                            ? NULL
+                                            : T("value");
+        bench->options[i].handler = handler;
+        bench->options[i].dest = dest;
+    }
+
+    for (i = 0; i < args_per_parse; i++)
+    {
+        dropt_char* arg = &bench->argBuf[i * max_name_length];
+        format_name(arg, argPrefix, (i * 7919) % numOptions, argSuffix);
+        bench->args[i] = arg;
+    }
+    bench->numArgs = args_per_parse;
+
+    bench->context = dropt_new_context(bench->options);
+    return bench->context != NULL;
+}
+
+
+static void
+free_parse_bench(parse_bench* bench)
+{
+    dropt_free_context(bench->context);
+    free(bench->argBuf);
+    free(bench->args);
+    free(bench->names);
+    free(bench->options);
+}
+
+
+static void
+bench_parse(unsigned long iterations, void* data)
+{
+    parse_bench* bench = data;
+    unsigned long i;
+    for (i = 0; i < iterations; i++)
+    {
+        dropt_char** rest = dropt_parse(bench->context, (int) bench->numArgs,
+                                        bench->args);
+        if (*rest != NULL || dropt_get_error(bench->context) != dropt_error_none)
+        {
+            fprintf(stderr, "Unexpected parse failure.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+static void
+bench_suggest(unsigned long iterations, void* data)
+{
+    parse_bench* bench = data;
+    unsigned long i;
+    size_t j;
+    for (i = 0; i < iterations; i++)
+    {
+        for (j = 0; j < bench->numArgs; j++)
+        {
+            dropt_parse(bench->context, 1, &bench->args[j]);
+            if (   dropt_get_error(bench->context) != dropt_error_invalid_option
+                || dropt_get_error_candidates(bench->context, NULL, 0) == 0)
+            {
+                fprintf(stderr, "Unexpected parse result.\n");
+                exit(EXIT_FAILURE);
+            }
+            dropt_clear_error(bench->context);
+        }
+    }
+}
+
+
+/* Subcommands -------------------------------------------------------- */
+
+typedef struct
+{
+    const dropt_option* options;
+    dropt_subcommand* subcommands;
+    dropt_char* names;
+    dropt_char* args[4];
+    dropt_char argBuf[3][max_name_length];
+} subcommand_bench;
+
+
+/** init_subcommand_bench
+  *
+  *     Creates `numSubcommands` subcommands named "sN" that share an option
+  *     table and a command-line that invokes the last one.
+  *
+  * PARAMETERS:
+  *     OUT bench          : The benchmark data to initialize.
+  *     IN options         : The global and subcommand options.
+  *     IN numSubcommands  : The number of subcommands.
+  *
+  * RETURNS:
+  *     `true` on success, `false` on failure.
+  */
+static bool
+init_subcommand_bench(subcommand_bench* bench, const dropt_option* options,
+                      size_t numSubcommands)
+{
+    size_t i;
+
+    memset(bench, 0, sizeof *bench);
+    bench->options = options;
+    bench->subcommands = calloc(numSubcommands + 1, sizeof *bench->subcommands);
+    bench->names = calloc(numSubcommands, max_name_length * sizeof *bench->names);
+    if (bench->subcommands == NULL || bench->names == NULL) { return false; }
+
+    for (i = 0; i < numSubcommands; i++)
+    {
+        dropt_char* name = &bench->names[i * max_name_length];
+        format_name(name, "s", i, NULL);
+        bench->subcommands[i].name = name;
+        bench->subcommands[i].options = options;
+    }
+
+    format_name(bench->argBuf[0], "--o", 1, NULL);
+    format_name(bench->argBuf[1], "s", numSubcommands - 1, NULL);
+    format_name(bench->argBuf[2], "--o", 2, NULL);
+    for (i = 0; i < ARRAY_LENGTH(bench->argBuf); i++)
+    {
+        bench->args[i] = bench->argBuf[i];
+    }
+    return true;
+}
+
+
+static void
+free_subcommand_bench(subcommand_bench* bench)
+{
+    free(bench->names);
+    free(bench->subcommands);
+}
+
+
+/* Measures start-up: creating the context, registering the subcommands, and
+ * parsing a command-line that invokes one of them.
+ */
+static void
+bench_subcommand(unsigned long iterations, void* data)
+{
+    subcommand_bench* bench = data;
+    unsigned long i;
+    for (i = 0; i < iterations; i++)
+    {
+        dropt_context* context = dropt_new_context(bench->options);
+        dropt_context* child = NULL;
+        dropt_char** rest;
+
+        if (context == NULL)
+        {
+            fprintf(stderr, "Insufficient memory.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        dropt_set_subcommands(context, bench->subcommands);
+        rest = dropt_parse(context, -1, bench->args);
+        if (dropt_get_error(context) == dropt_error_none && *rest != NULL)
+        {
+            const dropt_subcommand* subcommand = dropt_find_subcommand(context, *rest);
+            if (subcommand != NULL)
+            {
+                child = dropt_get_subcommand_context(context, subcommand);
+            }
+        }
+
+        if (child == NULL)
+        {
+            fprintf(stderr, "Unexpected parse result.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        dropt_parse(child, -1, rest + 1);
+        if (dropt_get_error(child) != dropt_error_none)
+        {
+            fprintf(stderr, "Unexpected parse result.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        dropt_free_context(context);
+    }
+}
+
+
+/* Composite contexts ------------------------------------------------- */
+
+enum { num_composite_parts = 4 };
+
+typedef struct
+{
+    /* All of the options in a single list. */
+    parse_bench whole;
+
+    /* The same options, split into `num_composite_parts` lists. */
+    dropt_option* lists;
+    dropt_context* parts[num_composite_parts];
+} composite_bench;
+
+
+/** init_composite_bench
+  *
+  *     Splits the options of a `parse_bench` into several contexts.
+  *
+  * PARAMETERS:
+  *     OUT bench     : The benchmark data to initialize.
+  *     IN numOptions : The total number of options.
+  *
+  * RETURNS:
+  *     `true` on success, `false` on failure.
+  */
+static bool
+init_composite_bench(composite_bench* bench, size_t numOptions)
+{
+    size_t perPart = numOptions / num_composite_parts;
+    size_t i;
+
+    memset(bench, 0, sizeof *bench);
+    if (!init_parse_bench(&bench->whole, numOptions, "--o", NULL,
+                          dropt_handle_bool, &boolSink))
+    {
+        return false;
+    }
+
+    bench->lists = calloc(numOptions + num_composite_parts,
+                          sizeof *bench->lists);
+    if (bench->lists == NULL) { return false; }
+
+    for (i = 0; i < num_composite_parts; i++)
+    {
+        dropt_option* list = &bench->lists[i * (perPart + 1)];
+        memcpy(list, &bench->whole.options[i * perPart],
+               perPart * sizeof *list);
+
+        /* The parts' lookup tables are built once and shared. */
+        bench->parts[i] = dropt_new_context(list);
+        if (   bench->parts[i] == NULL
+            || dropt_freeze_context(bench->parts[i]) != dropt_error_none)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static void
+free_composite_bench(composite_bench* bench)
+{
+    size_t i;
+    for (i = 0; i < num_composite_parts; i++)
+    {
+        dropt_free_context(bench->parts[i]);
+    }
+    free(bench->lists);
+    free_parse_bench(&bench->whole);
+}
+
+
+/* Measures start-up: creating a context over all of the options and parsing
+ * with it once.
+ */
+static void
+bench_composite(unsigned long iterations, void* data)
+{
+    composite_bench* bench = data;
+    unsigned long i;
+    for (i = 0; i < iterations; i++)
+    {
+        dropt_context* context = dropt_new_composite_context(bench->parts,
+                                                             num_composite_parts);
+        if (context == NULL)
+        {
+            fprintf(stderr, "Insufficient memory.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        bench->whole.context = context;
+        bench_parse(1, &bench->whole);
+        bench->whole.context = NULL;
+        dropt_free_context(context);
+    }
+}
+
+
+static void
+bench_concatenated(unsigned long iterations, void* data)
+{
+    composite_bench* bench = data;
+    unsigned long i;
+    for (i = 0; i < iterations; i++)
+    {
+        dropt_context* context = dropt_new_context(bench->whole.options);
+        if (context == NULL)
+        {
+            fprintf(stderr, "Insufficient memory.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        bench->whole.context = context;
+        bench_parse(1, &bench->whole);
+        bench->whole.context = NULL;
+        dropt_free_context(context);
+    }
+}
+
+
+/* Short option groups ------------------------------------------------ */
+
+static dropt_option shortOptions[53];
+static dropt_char shortNames[] = T("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ");
+
+static dropt_char* shortArgs[] = {
+    T("-abcdefgh"), T("-ijklmnop"), T("-qrstuvwx"), T("-yzABCDEF"),
+    T("-GHIJKLMN"), T("-OPQRSTUV"), T("-WXYZabcd"), T("-efghijkl"),
+    NULL
+};
+
+
+static bool
+init_short_bench(parse_bench* bench)
+{
+    size_t i;
+    for (i = 0; shortNames[i] != T('\0'); i++)
+    {
+        shortOptions[i].short_name = shortNames[i];
+        shortOptions[i].description = T("A short option.");
+        shortOptions[i].handler = dropt_handle_bool;
+        shortOptions[i].dest = &boolSink;
+    }
+
+    memset(bench, 0, sizeof *bench);
+    bench->args = shortArgs;
+    bench->numArgs = ARRAY_LENGTH(shortArgs) - 1;
+    bench->context = dropt_new_context(shortOptions);
+    return bench->context != NULL;
+}
+
+
+/* Command-line splitting -------------------------------------------- */
+
+typedef struct
+{
+    dropt_quoting quoting;
+    const dropt_char* commandLine;
+    dropt_char buffer[256];
+    dropt_char* argv[64];
+} split_bench;
+
+
+static const dropt_char splitCommandLine[]
+    = T("--output=/var/tmp/build/objects/module.o --include-path /usr/local/include ")
+      T("-DNAME=\"some value\" --verbose --jobs 8 'a quoted argument' ")
+      T("--define-macro=ANOTHER_LONG_MACRO_NAME path/to/the/source/file.c");
+
+
+static void
+bench_split(unsigned long iterations, void* data)
+{
+    split_bench* bench = data;
+    unsigned long i;
+    for (i = 0; i < iterations; i++)
+    {
+        dropt_split_command_line(bench->commandLine, bench->quoting,
+                                 bench->buffer,
+                                 bench->argv, ARRAY_LENGTH(bench->argv));
+    }
+}
+
+
+/* Help generation ---------------------------------------------------- */
+
+#ifndef DROPT_NO_STRING_BUFFERS
+static void
+bench_get_help(unsigned long iterations, void* data)
+{
+    parse_bench* bench = data;
+    dropt_help_params helpParams;
+    unsigned long i;
+
+    dropt_init_help_params(&helpParams);
+    for (i = 0; i < iterations; i++)
+    {
+        dropt_char* help = dropt_get_help(bench->context, &helpParams);
+        if (help == NULL)
+        {
+            fprintf(stderr, "Insufficient memory.\n");
+            exit(EXIT_FAILURE);
+        }
+        dropt_free(help);
+    }
+}
+#endif
+
+
+/* Stock handlers ----------------------------------------------------- */
+
+typedef struct
+{
+    dropt_context* context;
+    dropt_option option;
+    const dropt_char* argument;
+} handler_bench;
+
+
+static void
+bench_handler(unsigned long iterations, void* data)
+{
+    handler_bench* bench = data;
+    unsigned long i;
+    for (i = 0; i < iterations; i++)
+    {
+        dropt_error err = bench->option.handler(bench->context, &bench->option,
+                                                bench->argument,
+                                                bench->option.dest);
+        if (err != dropt_error_none)
+        {
+            fprintf(stderr, "Unexpected handler failure.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+static void
+run_handler_benchmarks(dropt_context* context)
+{
+    static unsigned int uintSink;
+    static double doubleSink;
+    static float floatSink;
+    static dropt_char* stringSink;
+    static dropt_uintptr constSink;
+
+    static const struct
+    {
+        const char* name;
+        dropt_option_handler_func handler;
+        void* dest;
+        const dropt_char* argument;
+    } handlers[] = {
+        { "handler/bool", dropt_handle_bool, &boolSink, T("1") },
+        { "handler/verbose_bool", dropt_handle_verbose_bool, &boolSink, T("true") },
+        { "handler/int", dropt_handle_int, &intSink, T("-123456") },
+        { "handler/uint", dropt_handle_uint, &uintSink, T("123456") },
+        { "handler/uint/10_digits", dropt_handle_uint, &uintSink, T("4000000000") },
+        { "handler/double", dropt_handle_double, &doubleSink, T("3.14159265") },
+        { "handler/double/17_digits", dropt_handle_double, &doubleSink, T("3.1415926535897931") },
+        { "handler/double/hex", dropt_handle_double, &doubleSink, T("0x1.921fb54442d18p1") },
+        { "handler/float", dropt_handle_float, &floatSink, T("3.14159265") },
+        { "handler/string", dropt_handle_string, &stringSink, T("value") },
+        { "handler/const", dropt_handle_const, &constSink, NULL }
+    };
+
+    size_t i;
+    for (i = 0; i < ARRAY_LENGTH(handlers); i++)
+    {
+        handler_bench bench;
+        memset(&bench, 0, sizeof bench);
+        bench.context = context;
+        bench.option.long_name = T("option");
+        bench.option.handler = handlers[i].handler;
+        bench.option.dest = handlers[i].dest;
+        bench.option.extra_data = 42;
+        bench.argument = handlers[i].argument;
+        run_benchmark(handlers[i].name, bench_handler, &bench, 1);
+    }
+}
+
+
+int
+main(int argc, char** argv)
+{
+    static const size_t tableSizes[] = { 10, 100, 1000, 10000 };
+
+    parse_bench bench;
+    char name[64];
+    size_t i;
+    size_t j;
+    int exitCode = EXIT_FAILURE;
+    dropt_allocator allocator;
+
+    allocator.reallocate = counting_reallocate;
+    allocator.deallocate = counting_deallocate;
+    allocator.user_data = NULL;
+    dropt_set_allocator(&allocator);
+
+    if (argc > 1) { benchFilter = argv[1]; }
+
+    printf("%-28s %12s %19s %23s\n", "Benchmark", "Iterations", "Time", "Allocations");
+
+    for (i = 0; i < ARRAY_LENGTH(tableSizes); i++)
+    {
+        sprintf(name, "parse_long/%lu", (unsigned long) tableSizes[i]);
+        if (!init_parse_bench(&bench, tableSizes[i], "--o", NULL,
+                              dropt_handle_bool, &boolSink))
+        {
+            goto exit;
+        }
+        run_benchmark(name, bench_parse, &bench, bench.numArgs);
+
+        dropt_set_strncmp(bench.context, dropt_strnicmp);
+        for (j = 0; j < bench.numArgs; j++) { bench.args[j][2] = T('O'); }
+        sprintf(name, "parse_long_nocase/%lu", (unsigned long) tableSizes[i]);
+        run_benchmark(name, bench_parse, &bench, bench.numArgs);
+
+        dropt_set_case_insensitive(bench.context, 1);
+        sprintf(name, "parse_long_folded/%lu", (unsigned long) tableSizes[i]);
+        run_benchmark(name, bench_parse, &bench, bench.numArgs);
+        free_parse_bench(&bench);
+    }
+
+    /* Every argument is one edit away from an option name. */
+    if (!init_parse_bench(&bench, 10000, "--p", NULL, dropt_handle_bool, &boolSink))
+    {
+        goto exit;
+    }
+    dropt_defer_error_details(bench.context, 1);
+    dropt_enable_suggestions(bench.context, 4);
+    run_benchmark("suggest/10000", bench_suggest, &bench, bench.numArgs);
+    free_parse_bench(&bench);
+
+    if (!init_parse_bench(&bench, 100, "--o", NULL, dropt_handle_bool, &boolSink))
+    {
+        goto exit;
+    }
+    {
+        static subcommand_bench subcommandBench;
+        if (!init_subcommand_bench(&subcommandBench, bench.options, 400))
+        {
+            goto exit;
+        }
+        run_benchmark("subcommand/400", bench_subcommand, &subcommandBench, 1);
+        free_subcommand_bench(&subcommandBench);
+    }
+    free_parse_bench(&bench);
+
+    {
+        static composite_bench compositeBench;
+        bool initialized = init_composite_bench(&compositeBench, 10000);
+        if (initialized)
+        {
+            dropt_free_context(compositeBench.whole.context);
+            compositeBench.whole.context = NULL;
+            run_benchmark("concatenated/10000", bench_concatenated,
+                          &compositeBench, compositeBench.whole.numArgs);
+            run_benchmark("composite/4x2500", bench_composite,
+                          &compositeBench, compositeBench.whole.numArgs);
+        }
+        free_composite_bench(&compositeBench);
+        if (!initialized) { goto exit; }
+    }
+
+    if (!init_parse_bench(&bench, 100, "--o", "=123", dropt_handle_int, &intSink))
+    {
+        goto exit;
+    }
+    run_benchmark("parse_long_with_arg/100", bench_parse, &bench, bench.numArgs);
+    free_parse_bench(&bench);
+
+    if (!init_short_bench(&bench)) { goto exit; }
+    run_benchmark("parse_short_groups", bench_parse, &bench, bench.numArgs);
+
+    run_handler_benchmarks(bench.context);
+    dropt_free_context(bench.context);
+
+    {
+        static split_bench splitBench;
+        splitBench.commandLine = splitCommandLine;
+
+        splitBench.quoting = dropt_quoting_posix;
+        run_benchmark("split_command_line/posix", bench_split, &splitBench, 12);
+
+        splitBench.quoting = dropt_quoting_msvc;
+        run_benchmark("split_command_line/msvc", bench_split, &splitBench, 12);
+    }
+
+#ifndef DROPT_NO_STRING_BUFFERS
+    if (!init_parse_bench(&bench, 100, "--o", NULL, dropt_handle_bool, &boolSink))
+    {
+        goto exit;
+    }
+    run_benchmark("get_help/100", bench_get_help, &bench, 100);
+    free_parse_bench(&bench);
+#endif
+
+    exitCode = EXIT_SUCCESS;
+
+exit:
+    if (exitCode != EXIT_SUCCESS) { fprintf(stderr, "Insufficient memory.\n"); }
+    return exitCode;
+}
@@ -26,18 +26,67 @@
   * 3. This notice may not be removed or altered from any source distribution.
   */
 
+/* `mmap` and friends aren't declared in strict ISO C modes. */
+#if    (defined __unix__ || defined __APPLE__) \
+    && !defined _POSIX_C_SOURCE && !defined _XOPEN_SOURCE
+    #define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <wctype.h>
+#include <limits.h>
+#include <stddef.h>
 #include <assert.h>
 
 #include "dropt.h"
 #include "dropt_string.h"
+#include "dropt_index.h"
+
+/* Response files are memory-mapped where possible and read with stdio
+ * otherwise.
+ */
+#if    !defined DROPT_NO_MMAP && !defined DROPT_USE_WCHAR \
+    && (defined __unix__ || defined __APPLE__)
+    #define DROPT_USE_MMAP 1
+
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/* Splitting strings into arguments scans for special characters with SIMD
+ * instructions where possible.
+ */
+#if !defined DROPT_NO_SIMD && !defined DROPT_USE_WCHAR
+    #if defined __AVX2__
+        #define DROPT_SPLIT_AVX2 1
+        #include <immintrin.h>
+    #endif
+
+    #if    defined __SSE2__ || defined _M_X64 \
+        || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+        #define DROPT_SPLIT_SSE2 1
+        #include <emmintrin.h>
+    #elif defined __ARM_NEON || defined _M_ARM64
+        #define DROPT_SPLIT_NEON 1
+        #include <arm_neon.h>
+    #endif
+#endif
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
 
 #if __STDC_VERSION__ >= 199901L
     #include <stdint.h>
     #include <stdbool.h>
+
+    typedef uint32_t dropt_uint32;
+    typedef uint64_t edit_bits;
 #else
     /* Compatibility junk for things that don't yet support ISO C99. */
     #ifndef SIZE_MAX
@@ -45,12 +94,25 @@
     #endif
 
     typedef enum { false, true } bool;
+
+    /* Assume that `unsigned int` is 32 bits wide. */
+    typedef unsigned int dropt_uint32;
+
+    #ifdef _MSC_VER
+        typedef unsigned __int64 edit_bits;
+    #else
+        typedef unsigned long edit_bits;
+    #endif
 #endif
 
 #ifndef MIN
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 #endif
 
+#ifndef MAX
+#define MAX(x, y) (((x) > (y)) ? (x) : (y))
+#endif
+
 #ifndef ARRAY_LENGTH
 #define ARRAY_LENGTH(array) (sizeof (array) / sizeof (array)[0])
 #endif
@@ -67,6 +129,46 @@ enum
 };
 
 
+/* The number of leading characters of each long name that a
+ * `long_name_index` stores inline.  `long_name_prefix_length *
+ * sizeof (dropt_char)` must be a multiple of `sizeof (dropt_uint32)`.
+ */
+enum { long_name_prefix_length = DROPT_INDEX_PREFIX_LENGTH };
+
+
+/* The number of characters of a long option name that case-insensitive
+ * contexts can fold without allocating memory.
+ */
+enum { fold_buffer_length = 64 };
+
+
+/* The most suggestions that can be made for a mistyped long option name
+ * (see `dropt_enable_suggestions`).
+ */
+enum { max_suggestions = 8 };
+
+/* The most edits that a suggestion may be from a mistyped long option
+ * name.
+ */
+enum { max_suggestion_distance = 3 };
+
+
+/* Marks an option that doesn't belong to a dropt context (see
+ * `option_position`).
+ */
+#define NO_OPTION_POSITION ((size_t) -1)
+
+/* Marks an unoccupied slot in a `long_name_hash`, in a narrow
+ * `short_name_table`, or in a `subcommand_registry`.
+ */
+#define EMPTY_HASH_SLOT ((dropt_uint32) DROPT_INDEX_EMPTY_SLOT)
+
+/* The number of seeds to try for each bucket before giving up on building a
+ * `long_name_hash`.
+ */
+#define MAX_HASH_SEED_ATTEMPTS 0x100000UL
+
+
 /** A string that might not be `NUL`-terminated. */
 typedef struct
 {
@@ -86,6 +188,9 @@ typedef struct
 {
     const dropt_option* option;
 
+    /* The option's position in the context (see `context_option`). */
+    size_t position;
+
     /* The `qsort` and `bsearch` comparison callbacks don't pass along any
      * client-supplied contextual data, so we have to embed it alongside the
      * regular data.
@@ -94,17 +199,423 @@ typedef struct
 } option_proxy;
 
 
+/** The long option names, sorted for binary searching.
+  *
+  * The index is stored as parallel arrays instead of as an array of
+  * `option_proxy` structures: each name's length and first few characters
+  * are kept inline so that most comparisons during a search can be resolved
+  * without computing lengths or dereferencing the client's option table.
+  * Options without long names are omitted.
+  */
+typedef struct
+{
+    size_t count;
+
+    /* A single allocation holding all three arrays.  `NULL` if the index
+     * hasn't been built.
+     */
+    dropt_uint32* lengths;  /* count lengths of the long names. */
+    dropt_uint32* indices;  /* count indices into the option table. */
+    dropt_char* prefixes;   /* count prefixes of `long_name_prefix_length`
+                             * characters, padded with `NUL`s.
+                             */
+
+    /* Whether the arrays point into a client-supplied index blob (see
+     * `dropt_new_context_from_index`) and therefore must not be freed.
+     */
+    bool borrowed;
+} long_name_index;
+
+
+/** A minimal perfect hash over the long option names, built using the
+  * "hash and displace" approach: keys are first distributed into
+  * small buckets, and then each bucket is assigned a seed that displaces all
+  * of its keys into unoccupied slots.  A lookup therefore costs one hash
+  * computation and one string comparison.
+  *
+  * The hash models only exact comparisons, so it is not used if a custom
+  * `dropt_strncmp_func` is installed.  Case-insensitive contexts hash the
+  * case-folded names instead.
+  */
+typedef struct
+{
+    size_t numBuckets;
+
+    /* The number of distinct long names. */
+    size_t numSlots;
+
+    /* A single allocation holding all three arrays.  `NULL` if the hash
+     * hasn't been built.
+     */
+    dropt_uint32* seeds;   /* numBuckets elements. */
+    dropt_uint32* slots;   /* numSlots option indices. */
+    dropt_uint32* lengths; /* numSlots lengths of the long names in `slots`. */
+
+    /* Whether the arrays point into a client-supplied index blob (see
+     * `dropt_new_context_from_index`) and therefore must not be freed.
+     */
+    bool borrowed;
+} long_name_hash;
+
+
+/** Per-name bookkeeping used while building a `long_name_hash`. */
+typedef struct
+{
+    dropt_uint32 h1;
+    dropt_uint32 h2;
+    dropt_uint32 option;
+    dropt_uint32 len;
+    size_t bucket;
+    bool duplicate;
+} hash_key;
+
+
+#ifdef DROPT_USE_WCHAR
+/** An entry in a `short_name_table`. */
+typedef struct
+{
+    /* '\0' if the slot is unoccupied. */
+    dropt_uint32 shortName;
+    dropt_uint32 option;
+} short_name_slot;
+#endif
+
+
+/** Maps short option names directly to their options so that resolving a
+  * short option takes constant time.  For narrow characters, this is a dense
+  * table indexed by the character's byte value.  For wide characters, which
+  * have too large a range for that, it's a sparse, open-addressed hash table
+  * whose size is a power of two.  Options are stored as indices into the
+  * option table.
+  *
+  * Like `long_name_hash`, this models only exact comparisons.  In
+  * case-insensitive contexts, narrow tables map both cases of each letter,
+  * and wide tables are keyed by the case-folded names.
+  */
+typedef struct
+{
+#ifdef DROPT_USE_WCHAR
+    /* The number of slots minus one. */
+    size_t mask;
+    short_name_slot* slots;
+#else
+    /* `UCHAR_MAX + 1` elements.  `NULL` if the table hasn't been built. */
+    dropt_uint32* slots;
+#endif
+
+    /* Whether the arrays point into a client-supplied index blob (see
+     * `dropt_new_context_from_index`) and therefore must not be freed.
+     */
+    bool borrowed;
+} short_name_table;
+
+
+/** A node of a `prefix_trie`.  Each node covers a range of entries in the
+  * `long_name_index`, all of which begin with the same `depth` characters.
+  */
+typedef struct
+{
+    /* The position of the node's first entry in the `long_name_index`. */
+    dropt_uint32 first;
+
+    /* The number of entries under the node. */
+    dropt_uint32 count;
+
+    /* The length of the prefix shared by the node's entries.  While the
+     * trie is being built, this is temporarily the length of the prefix
+     * that the node is known to share, which is one more than the parent's
+     * depth.
+     */
+    dropt_uint32 depth;
+
+    /* The first character after the parent's prefix (see `char_label`),
+     * or 0 for the root.
+     */
+    dropt_uint32 label;
+
+    /* The children occupy `numChildren` consecutive nodes starting at
+     * `children`.  An entry that is exactly `depth` characters long is not
+     * under any child.
+     */
+    dropt_uint32 children;
+    dropt_uint32 numChildren;
+} prefix_trie_node;
+
+
+/** A compressed trie over the names in a `long_name_index`, used to resolve
+  * abbreviated long option names (see `dropt_allow_abbreviations`) in time
+  * proportional to the length of the abbreviation.  Nodes with a single
+  * child are collapsed, so there are fewer than twice as many nodes as long
+  * names.
+  *
+  * Like `long_name_hash`, this models only exact comparisons.  Contexts
+  * with a custom `dropt_strncmp_func` binary search the index instead.
+  */
+typedef struct
+{
+    /* `NULL` if the trie hasn't been built.  The root is the first node. */
+    prefix_trie_node* nodes;
+    size_t numNodes;
+
+    /* Whether `nodes` belongs to a frozen context (see
+     * `dropt_new_parse_context`) and therefore must not be freed.
+     */
+    bool borrowed;
+} prefix_trie;
+
+
+/** The subcommands of a dropt context (see `dropt_set_subcommands`), along
+  * with an open-addressing hash of their names and the contexts created for
+  * them (see `dropt_get_subcommand_context`).
+  */
+typedef struct
+{
+    const dropt_subcommand* list;
+    size_t count;
+
+    /* A power of two number of slots, each holding an index into `list` or
+     * `EMPTY_HASH_SLOT`.  `NULL` if the hash hasn't been built.
+     */
+    dropt_uint32* slots;
+    size_t numSlots;
+
+    /* Whether `slots` belongs to a frozen context (see
+     * `dropt_new_parse_context`) and therefore must not be freed.
+     */
+    bool borrowed;
+
+    /* The contexts created for the subcommands, parallel to `list` and
+     * allocated with `allocator`.  `NULL` until the first one is created.
+     */
+    dropt_context** children;
+    dropt_allocator allocator;
+} subcommand_registry;
+
+
+/** Precomputed bit masks for Myers's bit-parallel edit distance algorithm
+  * (see `edit_distance`).  Bit i of the mask for a character is set if the
+  * pattern's i-th character is that character.
+  */
+typedef struct
+{
+    size_t len;
+
+    /* The masks for characters with codes up to `UCHAR_MAX`. */
+    edit_bits masks[UCHAR_MAX + 1];
+
+#ifdef DROPT_USE_WCHAR
+    /* Masks for wider characters are computed from the pattern itself. */
+    const dropt_char* s;
+#endif
+
+    /* Whether characters are folded with `fold_char` before comparing. */
+    bool fold;
+} edit_pattern;
+
+
+/** The header of a serialized lookup index (see `dropt_serialize_index` and
+  * dropt_index.h).  It is followed by, in order and in units of
+  * `dropt_uint32`:
+  *
+  *   * The `long_name_index` arrays (`lengths`, `indices`, then `prefixes`),
+  *     if `longCount` is nonzero.
+  *   * The `short_name_table` slots, if `numShortSlots` is nonzero.
+  *   * The `long_name_hash` arrays (`seeds`, `slots`, then `lengths`), if
+  *     `numHashBuckets` is nonzero.
+  *
+  * All values use the native byte order.  Since the arrays refer to options
+  * only by their indices, the blob is position-independent.
+  */
+typedef struct
+{
+    dropt_uint32 magic;
+    dropt_uint32 version;
+    dropt_uint32 charSize;
+    dropt_uint32 numOptions;
+    dropt_uint32 longCount;
+    dropt_uint32 numShortSlots;
+    dropt_uint32 numHashBuckets;
+    dropt_uint32 numHashSlots;
+} index_blob_header;
+
+
+/** The header of each block allocated from a `context_arena`.  The union
+  * members other than `info` only force suitable alignment for the block
+  * that follows.
+  */
+typedef union
+{
+    struct
+    {
+        size_t size;      /* The requested size of the block, in bytes. */
+        size_t prev;      /* The offset of the previous block's header. */
+        bool freed;
+    } info;
+    double alignDouble;
+    void* alignPointer;
+    long alignLong;
+} arena_block;
+
+/* Marks the absence of a block in a `context_arena`. */
+#define NO_ARENA_BLOCK ((size_t) -1)
+
+/* The alignment of the memory that a `context_arena` hands out. */
+typedef struct
+{
+    char c;
+    arena_block b;
+} arena_alignment_probe;
+
+#define ARENA_ALIGNMENT (offsetof(arena_alignment_probe, b))
+
+
+/** `response_buffer` holds the text of a response file.  The text is
+  * tokenized in place and is followed by at least one writable
+  * `dropt_char`.
+  */
+typedef struct
+{
+    dropt_char* text;
+    size_t length;
+
+    /* Whether `text` is memory-mapped (for `mappedSize` bytes) instead of
+     * allocated.
+     */
+    bool mapped;
+    size_t mappedSize;
+} response_buffer;
+
+
+/** `response_file_state` holds the settings for response file expansion
+  * (see `dropt_enable_response_files`) along with the argument list from
+  * the last expansion and the response files that it points into.
+  */
+typedef struct
+{
+    dropt_quoting syntax;
+    unsigned int maxDepth;
+
+    dropt_char** args;
+    size_t numArgs;
+    size_t argsCapacity;
+
+    response_buffer* buffers;
+    size_t numBuffers;
+    size_t buffersCapacity;
+} response_file_state;
+
+
+/** `context_arena` is a stack-like bump allocator that backs an arena-based
+  * dropt context (see `dropt_new_context_in_arena`).  It lives at the start
+  * of its own buffer.  Freed blocks are reclaimed once every block
+  * allocated after them also has been freed, and everything allocated after
+  * the mark is reclaimed by `dropt_reset_context`.  Requests that don't fit
+  * fall back to the global allocator.
+  */
+typedef struct
+{
+    unsigned char* base;
+    size_t size;
+
+    /* Offsets from `base`. */
+    size_t top;
+    size_t lastBlock;
+    size_t mark;
+    size_t markLastBlock;
+
+    /* Whether the arena's buffer was allocated by dropt. */
+    bool owned;
+} context_arena;
+
+
 struct dropt_context
 {
+    /* `NULL` for a composite context. */
     const dropt_option* options;
     size_t numOptions;
 
-    /* These may be NULL. */
-    option_proxy* sortedByLong;
+    /* For a composite context (see `dropt_new_composite_context`), the
+     * contexts whose options it combines, and a pointer to each of their
+     * options in turn.  Both are `NULL` otherwise.
+     */
+    dropt_context** parts;
+    size_t numParts;
+    const dropt_option** optionRefs;
+
+    /* Allocates the context's lookup tables and error details. */
+    dropt_allocator allocator;
+
+    /* The allocator that allocated the context itself. */
+    dropt_allocator selfAllocator;
+
+    /* Non-`NULL` if the context lives in an arena (see
+     * `dropt_new_context_in_arena`).
+     */
+    context_arena* arena;
+
+    long_name_index longIndex;
+
+    /* This may be NULL. */
     option_proxy* sortedByShort;
 
+    /* Whether `sortedByShort` belongs to a frozen context (see
+     * `dropt_new_parse_context`) and therefore must not be freed.
+     */
+    bool sortedByShortBorrowed;
+
+    bool useHashedLookup;
+    long_name_hash longHash;
+    short_name_table shortTable;
+
+    /* For case-insensitive contexts (see `dropt_set_case_insensitive`), the
+     * case-folded long name of each option, or `NULL` for options without
+     * one.  The folded names are stored after the pointers in the same
+     * allocation.  `NULL` if the names haven't been folded.
+     */
+    const dropt_char** foldedNames;
+
+    /* The length of the longest folded name. */
+    size_t longestFoldedName;
+
+    /* Whether `foldedNames` belongs to a frozen context (see
+     * `dropt_new_parse_context`) and therefore must not be freed.
+     */
+    bool foldedNamesBorrowed;
+
+    /* Whether unambiguous prefixes of long option names are accepted (see
+     * `dropt_allow_abbreviations`).
+     */
+    bool allowAbbreviations;
+    prefix_trie prefixTrie;
+
+    /* The number of long option names to suggest for mistyped ones (see
+     * `dropt_enable_suggestions`), and storage for the suggestions, as
+     * indices into the option table.
+     */
+    unsigned int maxSuggestions;
+    dropt_uint32 suggestions[max_suggestions];
+
+    subcommand_registry subcommands;
+
+    /* For a subcommand's context, the context that it was created from.
+     * Options not found in the subcommand's own list are looked up there.
+     */
+    const dropt_context* parent;
+
     bool allowConcatenatedArgs;
 
+    /* Whether the context's settings and lookup tables are read-only (see
+     * `dropt_freeze_context`).
+     */
+    bool frozen;
+
+    /* If non-`NULL`, matched options are recorded here instead of being
+     * passed to their handlers (see `dropt_set_result_tape`).
+     */
+    dropt_tape_entry* tape;
+    size_t tapeCapacity;
+    size_t tapeLength;
+
     dropt_error_handler_func errorHandler;
     void* errorHandlerData;
 
@@ -114,8 +625,40 @@ struct dropt_context
         dropt_char* optionName;
         dropt_char* optionArgument;
         dropt_char* message;
+
+        /* If non-`NULL`, the argument list that `location` refers to.
+         * `optionName` and `optionArgument` are copied from it on demand
+         * (see `dropt_defer_error_details`).
+         */
+        dropt_char** argv;
+        dropt_error_location location;
+        bool isShortName;
+
+        /* The options that the failing option name could have referred to
+         * (see `dropt_get_error_candidates`), as indices into the option
+         * table.  This points into the lookup tables or to `suggestions`.
+         */
+        const dropt_uint32* candidates;
+        size_t numCandidates;
     } errorDetails;
 
+    /* Whether parsing errors record only their location. */
+    bool deferErrorDetails;
+
+    response_file_state responseFiles;
+
+    /* The state of an incremental parse (see
+     * `dropt_begin_incremental_parse`).  `pendingArg` is the argument with
+     * `pendingOption`, which is waiting for its value.
+     */
+    struct
+    {
+        bool active;
+        bool done;
+        const dropt_option* pendingOption;
+        const dropt_char* pendingArg;
+    } incremental;
+
     /* This isn't named strncmp because platforms might provide a macro
      * version of strncmp, and we want to avoid a potential naming
      * conflict.
@@ -128,83 +671,544 @@ typedef struct
 {
     const dropt_option* option;
     const dropt_char* optionArgument;
+
+    /* If non-`NULL`, arguments are read from here instead of from `argv`
+     * (see `dropt_parse_source`).
+     */
+    const dropt_arg_source* source;
+
+    dropt_char** argv;
+    dropt_char** argCurrent;
     dropt_char** argNext;
     int argsLeft;
+
+    /* Whether more arguments might follow the last one (see
+     * `dropt_parse_chunk`).  If so, an option that could take its value
+     * from the next argument stops parsing and sets `awaitingArgument`
+     * instead of going without.
+     */
+    bool moreInput;
+    bool awaitingArgument;
 } parse_state;
 
 
-/** make_char_array
+/** peek_argument
   *
   * PARAMETERS:
-  *     IN s : A string.  Might not be NUL-terminated.
-  *            May be `NULL`.
-  *     len  : The length of `s`, excluding any `NUL` terminator.
+  *     IN ps : The current parse state.
   *
   * RETURNS:
-  *     The constructed char_array structure.
+  *     The next unprocessed argument, or `NULL` if there are none left.
   */
-static char_array
-make_char_array(const dropt_char* s, size_t len)
+static dropt_char*
+peek_argument(const parse_state* ps)
 {
-   char_array a;
+    if (ps->source != NULL)
+    {
+        return ps->source->peek(ps->source->source_data);
+    }
+    return (ps->argsLeft > 0) ? *ps->argNext : NULL;
+}
 
-   assert(IMPLIES(s == NULL, len == 0));
 
-   a.s = s;
-   a.len = len;
-   return a;
+/** consume_argument
+  *
+  *     Advances past the argument returned by `peek_argument`.
+  *
+  * PARAMETERS:
+  *     IN/OUT ps : The current parse state.
+  */
+static void
+consume_argument(parse_state* ps)
+{
+    if (ps->source != NULL)
+    {
+        ps->source->next(ps->source->source_data);
+        return;
+    }
+
+    ps->argNext++;
+    ps->argsLeft--;
 }
 
 
-/** cmp_key_option_proxy_long
+/** context_malloc
   *
-  *     Comparison callback for `bsearch`.  Compares a `char_array` structure
-  *     against an `option_proxy` structure based on long option names.
+  *     Allocates memory with a dropt context's allocator.
   *
   * PARAMETERS:
-  *     IN key  : A pointer to the `char_array` structure to search for.
-  *     IN item : A pointer to the `option_proxy` structure being searched
-  *                 against.
+  *     IN context     : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN numElements : The number of elements to allocate.
+  *     IN elementSize : The size of each element, in bytes.
   *
   * RETURNS:
-  *     0 if `key` and `item` are equivalent,
-  *     < 0 if `key` should precede `item`,
-  *     > 0 if `key` should follow `item`.
+  *     A pointer to the allocated memory.
+  *     Returns `NULL` if `numElements` is 0.
+  *     Returns `NULL` on error.
   */
-static int
-cmp_key_option_proxy_long(const void* key, const void* item)
+static void*
+context_malloc(const dropt_context* context,
+               size_t numElements, size_t elementSize)
 {
-    const char_array* longName = key;
-    const option_proxy* op = item;
+    assert(context != NULL);
+    return dropt_allocator_realloc(&context->allocator, NULL,
+                                   numElements, elementSize);
+}
 
-    size_t optionLen;
-    int ret;
 
-    assert(longName != NULL);
-    assert(op != NULL);
-    assert(op->option != NULL);
-    assert(op->context != NULL);
-    assert(op->context->ncmpstr != NULL);
+/** context_free
+  *
+  *     Frees memory allocated by `context_malloc`.
+  *
+  * PARAMETERS:
+  *     IN context : The dropt context.
+  *                  Must not be `NULL`.
+  *     IN/OUT p   : The memory block to free.
+  *                  May be `NULL`.
+  */
+static void
+context_free(const dropt_context* context, void* p)
+{
+    assert(context != NULL);
+    dropt_allocator_free(&context->allocator, p);
+}
 
-    if (longName->s == op->option->long_name)
-    {
-        return 0;
-    }
-    else if (longName->s == NULL)
-    {
-        return -1;
-    }
-    else if (op->option->long_name == NULL)
-    {
-        return +1;
-    }
 
-    /* Although the `longName` key might not be `NUL`-terminated, the
+/** context_strndup
+  *
+  *     Like `dropt_strndup`, but uses a dropt context's allocator.
+  *
+  * PARAMETERS:
+  *     IN context : The dropt context.
+  *                  Must not be `NULL`.
+  *     IN s       : The string to duplicate.
+  *     IN n       : The maximum number of `dropt_char`s to copy, excluding
+  *                    the `NUL`-terminator.
+  *
+  * RETURNS:
+  *     The duplicated string, which is always `NUL`-terminated.  Free it
+  *       with `context_free`.
+  *     Returns `NULL` on error.
+  */
+static dropt_char*
+context_strndup(const dropt_context* context, const dropt_char* s, size_t n)
+{
+    dropt_char* copy;
+    size_t len = 0;
+
+    assert(s != NULL);
+
+    while (len < n && s[len] != DROPT_TEXT_LITERAL('\0'))
+    {
+        len++;
+    }
+
+    if (len + 1 < len) { return NULL; }
+
+    copy = context_malloc(context, len + 1 /* NUL */, sizeof *copy);
+    if (copy != NULL)
+    {
+        memcpy(copy, s, len * sizeof *copy);
+        copy[len] = DROPT_TEXT_LITERAL('\0');
+    }
+
+    return copy;
+}
+
+
+/** arena_round_up
+  *
+  * PARAMETERS:
+  *     IN n : A size, in bytes.
+  *
+  * RETURNS:
+  *     `n` rounded up to a multiple of `sizeof (arena_block)`, or 0 on
+  *       overflow.
+  */
+static size_t
+arena_round_up(size_t n)
+{
+    size_t rounded = (n + sizeof (arena_block) - 1)
+                     / sizeof (arena_block) * sizeof (arena_block);
+    return (rounded < n) ? 0 : rounded;
+}
+
+
+/** arena_block_at
+  *
+  * RETURNS:
+  *     The header of the block at the specified offset in an arena.
+  */
+static arena_block*
+arena_block_at(const context_arena* arena, size_t offset)
+{
+    return (arena_block*) (arena->base + offset);
+}
+
+
+/** arena_owns
+  *
+  * RETURNS:
+  *     true if the specified memory was allocated from the arena, false if
+  *       it was allocated from the fallback allocator.
+  */
+static bool
+arena_owns(const context_arena* arena, const void* p)
+{
+    const unsigned char* q = p;
+    return q >= arena->base && q < arena->base + arena->size;
+}
+
+
+/** arena_pop_freed
+  *
+  *     Reclaims freed blocks from the top of an arena.
+  */
+static void
+arena_pop_freed(context_arena* arena)
+{
+    while (   arena->lastBlock != NO_ARENA_BLOCK
+           && arena_block_at(arena, arena->lastBlock)->info.freed)
+    {
+        arena->top = arena->lastBlock;
+        arena->lastBlock = arena_block_at(arena, arena->lastBlock)->info.prev;
+    }
+
+    if (arena->top < arena->mark)
+    {
+        arena->mark = arena->top;
+        arena->markLastBlock = arena->lastBlock;
+    }
+}
+
+
+/** arena_reallocate
+  *
+  *     The `dropt_allocator` reallocation function for a `context_arena`.
+  */
+static void*
+arena_reallocate(void* userData, void* p, size_t size)
+{
+    context_arena* arena = userData;
+    size_t rounded = arena_round_up(size);
+    size_t oldSize = 0;
+    void* q;
+
+    assert(arena != NULL);
+    assert(size != 0);
+
+    if (p != NULL)
+    {
+        arena_block* block;
+
+        if (!arena_owns(arena, p))
+        {
+            return dropt_allocator_realloc(NULL, p, size, 1);
+        }
+
+        block = (arena_block*) p - 1;
+        oldSize = block->info.size;
+
+        /* Resize the top block in place. */
+        if (   rounded != 0
+            && (unsigned char*) block == arena->base + arena->lastBlock
+            && rounded <= arena->size - arena->lastBlock - sizeof *block)
+        {
+            block->info.size = size;
+            arena->top = arena->lastBlock + sizeof *block + rounded;
+            return p;
+        }
+    }
+
+    if (   rounded != 0
+        && arena->top <= arena->size
+        && sizeof (arena_block) <= arena->size - arena->top
+        && rounded <= arena->size - arena->top - sizeof (arena_block))
+    {
+        arena_block* block = arena_block_at(arena, arena->top);
+        block->info.size = size;
+        block->info.prev = arena->lastBlock;
+        block->info.freed = false;
+        arena->lastBlock = arena->top;
+        arena->top += sizeof *block + rounded;
+        q = block + 1;
+    }
+    else
+    {
+        q = dropt_allocator_realloc(NULL, NULL, size, 1);
+    }
+
+    if (q != NULL && p != NULL)
+    {
+        memcpy(q, p, MIN(oldSize, size));
+        ((arena_block*) p - 1)->info.freed = true;
+        arena_pop_freed(arena);
+    }
+    return q;
+}
+
+
+/** arena_deallocate
+  *
+  *     The `dropt_allocator` deallocation function for a `context_arena`.
+  */
+static void
+arena_deallocate(void* userData, void* p)
+{
+    context_arena* arena = userData;
+
+    assert(arena != NULL);
+    assert(p != NULL);
+
+    if (!arena_owns(arena, p))
+    {
+        dropt_allocator_free(NULL, p);
+        return;
+    }
+
+    ((arena_block*) p - 1)->info.freed = true;
+    arena_pop_freed(arena);
+}
+
+
+/** make_char_array
+  *
+  * PARAMETERS:
+  *     IN s : A string.  Might not be NUL-terminated.
+  *            May be `NULL`.
+  *     len  : The length of `s`, excluding any `NUL` terminator.
+  *
+  * RETURNS:
+  *     The constructed char_array structure.
+  */
+static char_array
+make_char_array(const dropt_char* s, size_t len)
+{
+   char_array a;
+
+   assert(IMPLIES(s == NULL, len == 0));
+
+   a.s = s;
+   a.len = len;
+   return a;
+}
+
+
+/** fold_char
+  *
+  *     Folds an ASCII uppercase letter to lowercase without branching.
+  *     Other characters are returned unchanged.
+  *
+  * PARAMETERS:
+  *     IN c : The character to fold.
+  *
+  * RETURNS:
+  *     The folded character.
+  */
+static dropt_char
+fold_char(dropt_char c)
+{
+    /* The unsigned subtraction maps everything outside 'A' through 'Z' to
+     * 26 or greater, so the comparison yields 0 or 1.
+     */
+    return (dropt_char) (c + ('a' - 'A')
+                             * ((dropt_uint32) c - 'A' < 26));
+}
+
+
+/** fold_chars
+  *
+  *     Folds a string with `fold_char`.
+  *
+  * PARAMETERS:
+  *     OUT dest : The buffer for the folded characters.
+  *                Must have room for at least `n` characters.
+  *     IN s     : The characters to fold.
+  *     IN n     : The number of characters to fold.
+  */
+static void
+fold_chars(dropt_char* dest, const dropt_char* s, size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i++)
+    {
+        dest[i] = fold_char(s[i]);
+    }
+}
+
+
+/** fold_strncmp
+  *
+  *     The `dropt_strncmp_func` for case-insensitive contexts.  Compares
+  *     strings like `dropt_strncmp` does after folding them with
+  *     `fold_char`, so sorting names with it orders them the same way as
+  *     sorting their folded forms with `dropt_strncmp`.
+  *
+  * PARAMETERS:
+  *     IN s, t : The strings to compare.
+  *     IN n    : The maximum number of characters to compare.
+  *
+  * RETURNS:
+  *     0 if the strings are equivalent,
+  *     < 0 if `s` should precede `t`,
+  *     > 0 if `s` should follow `t`.
+  */
+static int
+fold_strncmp(const dropt_char* s, const dropt_char* t, size_t n)
+{
+    for (; n > 0; n--, s++, t++)
+    {
+        dropt_char a = fold_char(*s);
+        dropt_char b = fold_char(*t);
+        if (a != b)
+        {
+#ifdef DROPT_USE_WCHAR
+            return ((dropt_uint32) a < (dropt_uint32) b) ? -1 : +1;
+#else
+            return ((unsigned char) a < (unsigned char) b) ? -1 : +1;
+#endif
+        }
+        else if (a == DROPT_TEXT_LITERAL('\0'))
+        {
+            break;
+        }
+    }
+    return 0;
+}
+
+
+/** context_option
+  *
+  *     Options are identified by their position in a dropt context.  For a
+  *     composite context (see `dropt_new_composite_context`), positions run
+  *     through each part's options in turn.
+  *
+  * PARAMETERS:
+  *     IN context  : The dropt context.
+  *     IN position : The option's position.
+  *                   Must be less than the number of options.
+  *
+  * RETURNS:
+  *     The option at the specified position.
+  */
+static const dropt_option*
+context_option(const dropt_context* context, size_t position)
+{
+    assert(position < context->numOptions);
+    return (context->optionRefs != NULL)
+           ? context->optionRefs[position]
+           : &context->options[position];
+}
+
+
+/** option_position
+  *
+  * PARAMETERS:
+  *     IN context : The dropt context.
+  *     IN option  : The option.
+  *
+  * RETURNS:
+  *     The option's position in the context (see `context_option`), or
+  *       `NO_OPTION_POSITION` if the option doesn't belong to the context.
+  */
+static size_t
+option_position(const dropt_context* context, const dropt_option* option)
+{
+    size_t base = 0;
+    size_t i;
+
+    assert(context != NULL);
+
+    if (context->parts == NULL)
+    {
+        return (   option >= context->options
+                && option < context->options + context->numOptions)
+               ? (size_t) (option - context->options)
+               : NO_OPTION_POSITION;
+    }
+
+    for (i = 0; i < context->numParts; i++)
+    {
+        size_t position = option_position(context->parts[i], option);
+        if (position != NO_OPTION_POSITION) { return base + position; }
+        base += context->parts[i]->numOptions;
+    }
+    return NO_OPTION_POSITION;
+}
+
+
+/** long_name_key
+  *
+  * PARAMETERS:
+  *     IN context  : The dropt context.
+  *     IN position : The position of an option in the context.
+  *
+  * RETURNS:
+  *     The name that the context's lookup tables use for the option's long
+  *       name: its folded form if the context has folded names, or the long
+  *       name itself otherwise.  May be `NULL`.
+  */
+static const dropt_char*
+long_name_key(const dropt_context* context, size_t position)
+{
+    return (context->foldedNames != NULL)
+           ? context->foldedNames[position]
+           : context_option(context, position)->long_name;
+}
+
+
+/** cmp_key_option_proxy_long
+  *
+  *     Comparison callback for `bsearch`.  Compares a `char_array` structure
+  *     against an `option_proxy` structure based on long option names.
+  *
+  * PARAMETERS:
+  *     IN key  : A pointer to the `char_array` structure to search for.
+  *     IN item : A pointer to the `option_proxy` structure being searched
+  *                 against.
+  *
+  * RETURNS:
+  *     0 if `key` and `item` are equivalent,
+  *     < 0 if `key` should precede `item`,
+  *     > 0 if `key` should follow `item`.
+  */
+static int
+cmp_key_option_proxy_long(const void* key, const void* item)
+{
+    const char_array* longName = key;
+    const option_proxy* op = item;
+
+    const dropt_char* optionName;
+    size_t optionLen;
+    int ret;
+
+    assert(longName != NULL);
+    assert(op != NULL);
+    assert(op->option != NULL);
+    assert(op->context != NULL);
+    assert(op->context->ncmpstr != NULL);
+
+    optionName = long_name_key(op->context, op->position);
+    if (longName->s == optionName)
+    {
+        return 0;
+    }
+    else if (longName->s == NULL)
+    {
+        return -1;
+    }
+    else if (optionName == NULL)
+    {
+        return +1;
+    }
+
+    /* Although the `longName` key might not be `NUL`-terminated, the
      * `option_proxy` item we're searching against must be.
      */
-    optionLen = dropt_strlen(op->option->long_name);
+    optionLen = dropt_strlen(optionName);
     ret = op->context->ncmpstr(longName->s,
-                               op->option->long_name,
+                               optionName,
                                MIN(longName->len, optionLen));
     if (ret != 0)
     {
@@ -243,18 +1247,28 @@ cmp_option_proxies_long(const void* p1, const void* p2)
     const option_proxy* o1 = p1;
     const option_proxy* o2 = p2;
 
+    const dropt_char* longName;
     char_array ca1;
+    int ret;
 
     assert(o1 != NULL);
     assert(o2 != NULL);
     assert(o1->option != NULL);
     assert(o1->context == o2->context);
 
-    ca1 = make_char_array(o1->option->long_name,
-                          (o1->option->long_name == NULL)
-                          ? 0
-                          : dropt_strlen(o1->option->long_name));
-    return cmp_key_option_proxy_long(&ca1, o2);
+    longName = long_name_key(o1->context, o1->position);
+    ca1 = make_char_array(longName,
+                          (longName == NULL) ? 0 : dropt_strlen(longName));
+    ret = cmp_key_option_proxy_long(&ca1, o2);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    /* Break ties by position so that the first of any options with
+     * equivalent names sorts first.
+     */
+    return (o1->position < o2->position) ? -1 : (o1->position > o2->position);
 }
 
 
@@ -319,1219 +1333,6725 @@ cmp_option_proxies_short(const void* p1, const void* p2)
 }
 
 
-/** init_lookup_tables
+/** mix_hash
   *
-  *     Initializes the sorted lookup tables in a dropt context if not already
-  *     initialized.
+  *     Scrambles the bits of a hash value (the MurmurHash3 finalizer).
   *
   * PARAMETERS:
-  *     IN/OUT context : The dropt context.
-  *                      Must not be `NULL`.
+  *     IN h : The hash value to scramble.
+  *
+  * RETURNS:
+  *     The scrambled hash value.
   */
-static void
-init_lookup_tables(dropt_context* context)
+static dropt_uint32
+mix_hash(dropt_uint32 h)
 {
-    const dropt_option* options;
-    size_t n;
-
-    assert(context != NULL);
-
-    options = context->options;
-    n = context->numOptions;
-
-    if (context->sortedByLong == NULL)
-    {
-        context->sortedByLong
-            = dropt_safe_malloc(n, sizeof *(context->sortedByLong));
-        if (context->sortedByLong != NULL)
-        {
-            size_t i;
-            for (i = 0; i < n; i++)
-            {
-                context->sortedByLong[i].option = &options[i];
-                context->sortedByLong[i].context = context;
-            }
-
-            qsort(context->sortedByLong,
-                  n, sizeof *(context->sortedByLong),
-                  cmp_option_proxies_long);
-        }
-    }
-
-    if (context->sortedByShort == NULL)
-    {
-        context->sortedByShort
-            = dropt_safe_malloc(n, sizeof *(context->sortedByShort));
-        if (context->sortedByShort != NULL)
-        {
-            size_t i;
-            for (i = 0; i < n; i++)
-            {
-                context->sortedByShort[i].option = &options[i];
-                context->sortedByShort[i].context = context;
-            }
-
-            qsort(context->sortedByShort,
-                  n, sizeof *(context->sortedByShort),
-                  cmp_option_proxies_short);
-        }
-    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6BU;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35U;
+    h ^= h >> 16;
+    return h;
 }
 
 
-/** free_lookup_tables
+/** hash_name
   *
-  *     Frees the sorted lookup tables in a dropt context.
+  *     Computes a pair of independent hash values for an option name.
   *
   * PARAMETERS:
-  *     IN/OUT context : The dropt context.
-  *                      May be `NULL`.
+  *     IN name : The name to hash.  Might not be `NUL`-terminated.
+  *     OUT h1  : On output, the first hash value.
+  *     OUT h2  : On output, the second hash value.
   */
 static void
-free_lookup_tables(dropt_context* context)
+hash_name(char_array name, dropt_uint32* h1, dropt_uint32* h2)
 {
-    if (context != NULL)
-    {
-        free(context->sortedByLong);
-        context->sortedByLong = NULL;
+    /* FNV-1a and a variant of djb2, computed in a single pass. */
+    dropt_uint32 a = 2166136261U;
+    dropt_uint32 b = 5381U;
+    size_t i;
 
-        free(context->sortedByShort);
-        context->sortedByShort = NULL;
+    assert(h1 != NULL);
+    assert(h2 != NULL);
+
+    for (i = 0; i < name.len; i++)
+    {
+        dropt_uint32 c = (dropt_uint32) name.s[i];
+        a = (a ^ c) * 16777619U;
+        b = ((b << 5) + b) ^ c;
     }
+
+    *h1 = mix_hash(a);
+    *h2 = mix_hash(b);
 }
 
 
-/** is_valid_option
+/** hash_slot
   *
   * PARAMETERS:
-  *     IN option : Specification for an individual option.
+  *     IN h1, h2   : The hash values for a name, from `hash_name`.
+  *     IN seed     : The displacement seed for the name's bucket.
+  *     IN numSlots : The number of slots in the hash table.
+  *                   Must not be 0.
   *
   * RETURNS:
-  *     true if the specified option is valid, false if it's a sentinel value.
+  *     The slot occupied by the name.
   */
-static bool
-is_valid_option(const dropt_option* option)
+static size_t
+hash_slot(dropt_uint32 h1, dropt_uint32 h2, dropt_uint32 seed,
+          size_t numSlots)
 {
-    return    option != NULL
-           && !(   option->long_name == NULL
-                && option->short_name == DROPT_TEXT_LITERAL('\0')
-                && option->description == NULL
-                && option->arg_description == NULL
-                && option->handler == NULL
-                && option->dest == NULL
-                && option->attr == 0
-                && option->extra_data == 0);
+    assert(numSlots != 0);
+    return mix_hash((h1 ^ (seed * 0x9E3779B9U)) + h2) % numSlots;
 }
 
 
-/** find_option_long
+/** free_long_name_hash
   *
-  *     Finds the option specification for a long option name (i.e., an option
-  *     of the form "--option").
+  *     Frees a `long_name_hash`.
   *
   * PARAMETERS:
-  *     IN context     : The dropt context.
-  *     IN longName    : The long option name to search for (excluding leading
-  *                        dashes).
-  *                      `longName.s` must not be `NULL`.
+  *     IN context  : The dropt context that owns the hash.
+  *     IN/OUT hash : The hash to free.
+  *                   Must not be `NULL`.
+  */
+static void
+free_long_name_hash(const dropt_context* context, long_name_hash* hash)
+{
+    long_name_hash emptyHash = { 0 };
+
+    assert(hash != NULL);
+
+    if (!hash->borrowed) { context_free(context, hash->seeds); }
+    *hash = emptyHash;
+}
+
+
+/** init_long_name_hash
+  *
+  *     Builds a minimal perfect hash over the long option names in a dropt
+  *     context.  If the same long name is used by multiple options, the
+  *     first one wins.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
   *
   * RETURNS:
-  *     A pointer to the corresponding option specification or `NULL` if not
-  *       found.
+  *     true on success, false on failure.  On failure, the context is left
+  *       without a hash, and lookups should use the sorted tables instead.
   */
-static const dropt_option*
-find_option_long(const dropt_context* context,
-                 char_array longName)
+static bool
+init_long_name_hash(dropt_context* context)
 {
+    long_name_hash* hash;
+    hash_key* keys = NULL;
+
+    /* Indices into `keys`, grouped by bucket. */
+    size_t* keysByBucket = NULL;
+
+    /* The offset of each bucket's first key in `keysByBucket`, plus one
+     * trailing element.
+     */
+    size_t* bucketStarts = NULL;
+
+    /* Temporary storage for the slots of a bucket's keys. */
+    size_t* candidateSlots = NULL;
+
+    size_t numKeys = 0;
+    size_t numDistinctKeys;
+    size_t maxBucketSize = 0;
+    size_t i;
+    size_t bucketSize;
+    bool success = false;
+
     assert(context != NULL);
-    assert(longName.s != NULL);
 
-    if (context->sortedByLong != NULL)
+    hash = &context->longHash;
+    free_long_name_hash(context, hash);
+
+    for (i = 0; i < context->numOptions; i++)
     {
-        option_proxy* found = bsearch(&longName, context->sortedByLong,
-                                      context->numOptions,
-                                      sizeof *(context->sortedByLong),
-                                      cmp_key_option_proxy_long);
-        return (found == NULL) ? NULL : found->option;
+        if (context_option(context, i)->long_name != NULL) { numKeys++; }
     }
 
-    /* Fall back to a linear search. */
+    if (numKeys == 0 || numKeys >= EMPTY_HASH_SLOT) { goto exit; }
+
+    keys = context_malloc(context, numKeys, sizeof *keys);
+    keysByBucket = context_malloc(context, numKeys, sizeof *keysByBucket);
+    if (keys == NULL || keysByBucket == NULL) { goto exit; }
+
+    /* Aim for an average of two keys per bucket. */
+    hash->numBuckets = (numKeys + 1) / 2;
+    bucketStarts = context_malloc(context, hash->numBuckets + 1,
+                                     sizeof *bucketStarts);
+    if (bucketStarts == NULL) { goto exit; }
+    memset(bucketStarts, 0, (hash->numBuckets + 1) * sizeof *bucketStarts);
+
     {
-        option_proxy item = { 0 };
-        item.context = context;
-        for (item.option = context->options;
-             is_valid_option(item.option);
-             item.option++)
+        size_t k = 0;
+        for (i = 0; i < context->numOptions; i++)
         {
-            if (cmp_key_option_proxy_long(&longName, &item) == 0)
+            const dropt_char* longName
+                = long_name_key(context, i);
+            if (longName != NULL)
             {
-                return item.option;
+                size_t len = dropt_strlen(longName);
+                if (len >= EMPTY_HASH_SLOT) { goto exit; }
+
+                hash_name(make_char_array(longName, len),
+                          &keys[k].h1, &keys[k].h2);
+                keys[k].option = (dropt_uint32) i;
+                keys[k].len = (dropt_uint32) len;
+                keys[k].bucket = keys[k].h1 % hash->numBuckets;
+                keys[k].duplicate = false;
+                bucketStarts[keys[k].bucket + 1]++;
+                k++;
             }
         }
+        assert(k == numKeys);
     }
-    return NULL;
-}
-
 
-/** find_option_short
-  *
-  *     Finds the option specification for a short option name (i.e., an
-  *     option of the form "-o").
-  *
-  * PARAMETERS:
-  *     IN context   : The dropt context.
-  *     IN shortName : The short option name to search for.
-  *
-  * RETURNS:
-  *     A pointer to the corresponding option specification or `NULL` if not
-  *       found.
-  */
-static const dropt_option*
-find_option_short(const dropt_context* context, dropt_char shortName)
-{
-    assert(context != NULL);
-    assert(shortName != DROPT_TEXT_LITERAL('\0'));
-    assert(context->ncmpstr != NULL);
+    /* Group the keys by bucket with a (stable) counting sort. */
+    for (i = 0; i < hash->numBuckets; i++)
+    {
+        bucketSize = bucketStarts[i + 1];
+        if (bucketSize > maxBucketSize) { maxBucketSize = bucketSize; }
+        bucketStarts[i + 1] += bucketStarts[i];
+    }
 
-    if (context->sortedByShort != NULL)
     {
-        option_proxy* found = bsearch(&shortName, context->sortedByShort,
-                                      context->numOptions,
-                                      sizeof *(context->sortedByShort),
-                                      cmp_key_option_proxy_short);
-        return (found == NULL) ? NULL : found->option;
+        /* Reuse `candidateSlots` as the per-bucket insertion cursors. */
+        candidateSlots = context_malloc(context, MAX(hash->numBuckets,
+                                               maxBucketSize),
+                                           sizeof *candidateSlots);
+        if (candidateSlots == NULL) { goto exit; }
+
+        memcpy(candidateSlots, bucketStarts,
+               hash->numBuckets * sizeof *candidateSlots);
+        for (i = 0; i < numKeys; i++)
+        {
+            keysByBucket[candidateSlots[keys[i].bucket]++] = i;
+        }
     }
 
-    /* Fall back to a linear search. */
+    /* Weed out duplicate names.  Since the counting sort is stable, the
+     * first occurrence of a name precedes its duplicates.
+     */
+    numDistinctKeys = numKeys;
+    for (i = 0; i < hash->numBuckets; i++)
     {
-        const dropt_option* option;
-        for (option = context->options; is_valid_option(option); option++)
+        size_t j;
+        for (j = bucketStarts[i]; j < bucketStarts[i + 1]; j++)
         {
-            if (context->ncmpstr(&shortName, &option->short_name, 1) == 0)
+            const hash_key* key = &keys[keysByBucket[j]];
+            size_t k;
+            for (k = bucketStarts[i]; k < j; k++)
             {
-                return option;
+                const hash_key* other = &keys[keysByBucket[k]];
+                if (   !other->duplicate
+                    && other->h1 == key->h1
+                    && other->h2 == key->h2
+                    && other->len == key->len
+                    && memcmp(long_name_key(context, other->option),
+                              long_name_key(context, key->option),
+                              key->len * sizeof (dropt_char)) == 0)
+                {
+                    keys[keysByBucket[j]].duplicate = true;
+                    numDistinctKeys--;
+                    break;
+                }
             }
         }
     }
-    return NULL;
-}
 
+    hash->numSlots = numDistinctKeys;
+    hash->seeds = context_malloc(context, hash->numBuckets + 2 * hash->numSlots,
+                                    sizeof *(hash->seeds));
+    if (hash->seeds == NULL) { goto exit; }
 
-/** set_error_details
-  *
-  *     Generates error details in the dropt context.
-  *
-  * PARAMETERS:
-  *     IN/OUT context    : The dropt context.
-  *                         Must not be `NULL`.
-  *     IN err            : The error code.
-  *     IN optionName     : The name of the option we failed on.
-  *                         `optionName.s` must not be `NULL`.
-  *     IN optionArgument : The value of the option we failed on.
-  *                         Pass `NULL` if unwanted.
-  */
-static void
-set_error_details(dropt_context* context, dropt_error err,
-                  char_array optionName,
-                  const dropt_char* optionArgument)
-{
-    assert(context != NULL);
-    assert(optionName.s != NULL);
+    hash->slots = hash->seeds + hash->numBuckets;
+    hash->lengths = hash->slots + hash->numSlots;
 
-    context->errorDetails.err = err;
+    memset(hash->seeds, 0, hash->numBuckets * sizeof *(hash->seeds));
+    for (i = 0; i < hash->numSlots; i++)
+    {
+        hash->slots[i] = EMPTY_HASH_SLOT;
+    }
 
-    free(context->errorDetails.optionName);
-    free(context->errorDetails.optionArgument);
+    /* Place the largest buckets first, while there still are plenty of
+     * unoccupied slots.
+     */
+    for (bucketSize = maxBucketSize; bucketSize > 0; bucketSize--)
+    {
+        size_t b;
+        for (b = 0; b < hash->numBuckets; b++)
+        {
+            dropt_uint32 seed;
 
-    context->errorDetails.optionName = dropt_strndup(optionName.s,
-                                                     optionName.len);
-    context->errorDetails.optionArgument = (optionArgument == NULL)
-                                           ? NULL
-                                           : dropt_strdup(optionArgument);
+            if (bucketStarts[b + 1] - bucketStarts[b] != bucketSize)
+            {
+                continue;
+            }
 
-    /* The message will be generated lazily on retrieval. */
-    free(context->errorDetails.message);
-    context->errorDetails.message = NULL;
-}
+            for (seed = 0; seed < MAX_HASH_SEED_ATTEMPTS; seed++)
+            {
+                size_t numPlaced = 0;
+                size_t j;
+                for (j = bucketStarts[b]; j < bucketStarts[b + 1]; j++)
+                {
+                    const hash_key* key = &keys[keysByBucket[j]];
+                    size_t slot;
+                    size_t k;
 
+                    if (key->duplicate) { continue; }
 
-/** set_short_option_error_details
-  *
-  *     Generates error details in the dropt context.
-  *
-  * PARAMETERS:
-  *     IN/OUT context    : The dropt context.
-  *     IN err            : The error code.
-  *     IN shortName      : the "short" name of the option we failed on.
-  *     IN optionArgument : The value of the option we failed on.
-  *                         Pass `NULL` if unwanted.
-  */
-static void
-set_short_option_error_details(dropt_context* context, dropt_error err,
-                               dropt_char shortName,
-                               const dropt_char* optionArgument)
-{
-    /* "-?" is just a placeholder. */
-    dropt_char shortNameBuf[] = DROPT_TEXT_LITERAL("-?");
+                    slot = hash_slot(key->h1, key->h2, seed, hash->numSlots);
+                    if (hash->slots[slot] != EMPTY_HASH_SLOT) { break; }
 
-    assert(context != NULL);
-    assert(shortName != DROPT_TEXT_LITERAL('\0'));
+                    for (k = 0; k < numPlaced; k++)
+                    {
+                        if (candidateSlots[k] == slot) { break; }
+                    }
+                    if (k < numPlaced) { break; }
 
-    shortNameBuf[1] = shortName;
+                    candidateSlots[numPlaced++] = slot;
+                }
 
-    set_error_details(context, err,
-                      make_char_array(shortNameBuf,
-                                      ARRAY_LENGTH(shortNameBuf) - 1),
-                      optionArgument);
+                if (j == bucketStarts[b + 1])
+                {
+                    /* Every key in the bucket found an unoccupied slot. */
+                    size_t k = 0;
+                    for (j = bucketStarts[b]; j < bucketStarts[b + 1]; j++)
+                    {
+                        const hash_key* key = &keys[keysByBucket[j]];
+                        if (key->duplicate) { continue; }
+
+                        hash->slots[candidateSlots[k]] = key->option;
+                        hash->lengths[candidateSlots[k]] = key->len;
+                        k++;
+                    }
+                    hash->seeds[b] = seed;
+                    break;
+                }
+            }
+
+            if (seed == MAX_HASH_SEED_ATTEMPTS) { goto exit; }
+        }
+    }
+
+    success = true;
+
+exit:
+    if (!success) { free_long_name_hash(context, hash); }
+    context_free(context, candidateSlots);
+    context_free(context, bucketStarts);
+    context_free(context, keysByBucket);
+    context_free(context, keys);
+    return success;
 }
 
 
-/** dropt_get_error
+/** short_name_hash
   *
   * PARAMETERS:
-  *     IN context : The dropt context.
-  *                  Must not be NULL.
+  *     IN shortName : The short option name to hash.
+  *     IN mask      : The number of slots in the table minus one.
   *
   * RETURNS:
-  *     The current error code waiting in the dropt context.
+  *     The first slot to probe for the short name.
   */
-dropt_error
-dropt_get_error(const dropt_context* context)
-{
-    if (context == NULL)
-    {
-        DROPT_MISUSE("No dropt context specified.");
-        return dropt_error_bad_configuration;
-    }
-    return context->errorDetails.err;
-}
+#ifdef DROPT_USE_WCHAR
+#define short_name_hash(shortName, mask) \
+    ((size_t) (((dropt_uint32) (shortName) * 0x9E3779B9U) >> 16) & (mask))
+#endif
 
 
-/** dropt_get_error_details
+/** free_short_name_table
   *
-  *     Retrieves details about the current error.
+  *     Frees a `short_name_table`.
   *
   * PARAMETERS:
-  *     IN context         : The dropt context.
-  *     OUT optionName     : On output, the name of the option we failed
-  *                            on.  Do not free this string.
-  *                          Pass `NULL` if unwanted.
-  *     OUT optionArgument : On output, the value (possibly `NULL`) of the
-  *                            option we failed on.  Do not free this
-  *                            string.
-  *                          Pass `NULL` if unwanted.
+  *     IN context   : The dropt context that owns the table.
+  *     IN/OUT table : The table to free.
+  *                    Must not be `NULL`.
   */
-void
-dropt_get_error_details(const dropt_context* context,
-                        dropt_char** optionName, dropt_char** optionArgument)
+static void
+free_short_name_table(const dropt_context* context, short_name_table* table)
 {
-    if (optionName != NULL)
-    {
-        *optionName = context->errorDetails.optionName;
-    }
+    short_name_table emptyTable = { 0 };
 
-    if (optionArgument != NULL)
-    {
-        *optionArgument = context->errorDetails.optionArgument;
-    }
+    assert(table != NULL);
+
+    if (!table->borrowed) { context_free(context, table->slots); }
+    *table = emptyTable;
 }
 
 
-/** dropt_get_error_message
+/** init_short_name_table
+  *
+  *     Builds the direct lookup table for the short option names in a dropt
+  *     context.  If the same short name is used by multiple options, the
+  *     first one wins.
   *
   * PARAMETERS:
-  *     IN context : The dropt context.
-  *                  Must not be `NULL`.
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
   *
   * RETURNS:
-  *     The current error message waiting in the dropt context or the empty
-  *       string if there are no errors.  Note that calling any dropt
-  *       function other than `dropt_get_error`, `dropt_get_error_details`, and
-  *       `dropt_get_error_message` may invalidate a previously-returned
-  *       string.
+  *     true on success, false on failure.  On failure, the context is left
+  *       without a table, and lookups should use the sorted tables instead.
   */
-const dropt_char*
-dropt_get_error_message(dropt_context* context)
+static bool
+init_short_name_table(dropt_context* context)
 {
-    if (context == NULL)
+    short_name_table* table;
+    bool foldCase;
+    size_t i;
+
+    assert(context != NULL);
+
+    table = &context->shortTable;
+    foldCase = (context->ncmpstr == fold_strncmp);
+    free_short_name_table(context, table);
+
+    if (context->numOptions >= EMPTY_HASH_SLOT) { return false; }
+
+#ifdef DROPT_USE_WCHAR
     {
-        DROPT_MISUSE("No dropt context specified.");
-        return DROPT_TEXT_LITERAL("");
+        size_t numSlots = 8;
+        size_t numShortNames = 0;
+
+        for (i = 0; i < context->numOptions; i++)
+        {
+            if (context_option(context, i)->short_name != DROPT_TEXT_LITERAL('\0'))
+            {
+                numShortNames++;
+            }
+        }
+
+        /* Keep the load factor at or below 1/2 so that probe sequences stay
+         * short.
+         */
+        while (numSlots < 2 * numShortNames)
+        {
+            if (numSlots > SIZE_MAX / 2) { return false; }
+            numSlots *= 2;
+        }
+
+        table->slots = context_malloc(context, numSlots, sizeof *(table->slots));
+        if (table->slots == NULL) { return false; }
+        memset(table->slots, 0, numSlots * sizeof *(table->slots));
+        table->mask = numSlots - 1;
+
+        for (i = 0; i < context->numOptions; i++)
+        {
+            dropt_char shortName = context_option(context, i)->short_name;
+            size_t slot;
+
+            if (shortName == DROPT_TEXT_LITERAL('\0')) { continue; }
+
+            if (foldCase) { shortName = fold_char(shortName); }
+
+            slot = short_name_hash(shortName, table->mask);
+            while (   table->slots[slot].shortName != 0
+                   && table->slots[slot].shortName
+                      != (dropt_uint32) shortName)
+            {
+                slot = (slot + 1) & table->mask;
+            }
+
+            if (table->slots[slot].shortName == 0)
+            {
+                table->slots[slot].shortName = (dropt_uint32) shortName;
+                table->slots[slot].option = (dropt_uint32) i;
+            }
+        }
     }
+#else
+    table->slots = context_malloc(context, UCHAR_MAX + 1, sizeof *(table->slots));
+    if (table->slots == NULL) { return false; }
 
-    if (context->errorDetails.err == dropt_error_none)
+    for (i = 0; i <= UCHAR_MAX; i++)
     {
-        return DROPT_TEXT_LITERAL("");
+        table->slots[i] = EMPTY_HASH_SLOT;
     }
 
-    if (context->errorDetails.message == NULL)
+    for (i = 0; i < context->numOptions; i++)
     {
-        if (context->errorHandler != NULL)
+        const dropt_option* option = context_option(context, i);
+        unsigned char c = (unsigned char) option->short_name;
+
+        if (foldCase) { c = (unsigned char) fold_char((dropt_char) c); }
+
+        if (c != '\0' && table->slots[c] == EMPTY_HASH_SLOT)
         {
-            context->errorDetails.message
-                = context->errorHandler(context->errorDetails.err,
-                                        context->errorDetails.optionName,
-                                        context->errorDetails.optionArgument,
-                                        context->errorHandlerData);
+            table->slots[c] = (dropt_uint32) i;
         }
-        else
+    }
+
+    /* Uppercase letters share the slots of their folded forms. */
+    if (foldCase)
+    {
+        for (i = 'A'; i <= 'Z'; i++)
         {
-#ifndef DROPT_NO_STRING_BUFFERS
-            context->errorDetails.message
-                = dropt_default_error_handler(context->errorDetails.err,
-                                              context->errorDetails.optionName,
-                                              context->errorDetails.optionArgument);
-#endif
+            table->slots[i] = table->slots[i + ('a' - 'A')];
         }
     }
+#endif
 
-    return (context->errorDetails.message == NULL)
-           ? DROPT_TEXT_LITERAL("Unknown error")
-           : context->errorDetails.message;
+    return true;
 }
 
 
-/** dropt_clear_error
+/** free_long_name_index
   *
-  *     Clears the error waiting in the dropt context.
+  *     Frees a `long_name_index`.
   *
   * PARAMETERS:
-  *     IN/OUT context : The dropt context to free.
-  *                      May be `NULL`.
+  *     IN context   : The dropt context that owns the index.
+  *     IN/OUT index : The index to free.
+  *                    Must not be `NULL`.
   */
-void
-dropt_clear_error(dropt_context* context)
+static void
+free_long_name_index(const dropt_context* context, long_name_index* index)
 {
-    if (context != NULL)
+    long_name_index emptyIndex = { 0 };
+
+    assert(index != NULL);
+
+    if (!index->borrowed) { context_free(context, index->lengths); }
+    *index = emptyIndex;
+}
+
+
+/** init_long_name_index
+  *
+  *     Builds the sorted index of the long option names in a dropt context.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *
+  * RETURNS:
+  *     true on success, false on failure.  On failure, the context is left
+  *       without an index, and lookups should use a linear search instead.
+  */
+static bool
+init_long_name_index(dropt_context* context)
+{
+    long_name_index* index;
+    option_proxy* sorted = NULL;
+    size_t count = 0;
+    size_t i;
+    bool success = false;
+
+    assert(context != NULL);
+
+    index = &context->longIndex;
+    free_long_name_index(context, index);
+
+    for (i = 0; i < context->numOptions; i++)
     {
-        context->errorDetails.err = dropt_error_none;
+        if (context_option(context, i)->long_name != NULL) { count++; }
+    }
 
-        free(context->errorDetails.optionName);
-        context->errorDetails.optionName = NULL;
+    if (count == 0 || count >= (dropt_uint32) -1) { goto exit; }
 
-        free(context->errorDetails.optionArgument);
-        context->errorDetails.optionArgument = NULL;
+    sorted = context_malloc(context, count, sizeof *sorted);
+    if (sorted == NULL) { goto exit; }
 
-        free(context->errorDetails.message);
-        context->errorDetails.message = NULL;
+    {
+        size_t k = 0;
+        for (i = 0; i < context->numOptions; i++)
+        {
+            if (context_option(context, i)->long_name != NULL)
+            {
+                sorted[k].option = context_option(context, i);
+                sorted[k].position = i;
+                sorted[k].context = context;
+                k++;
+            }
+        }
+        assert(k == count);
+    }
+
+    qsort(sorted, count, sizeof *sorted, cmp_option_proxies_long);
+
+    /* If multiple options have equivalent long names, the first one wins. */
+    {
+        size_t k = 1;
+        for (i = 1; i < count; i++)
+        {
+            const dropt_char* longName = long_name_key(context,
+                                                       sorted[i].position);
+            char_array key = make_char_array(longName,
+                                             dropt_strlen(longName));
+            if (cmp_key_option_proxy_long(&key, &sorted[k - 1]) != 0)
+            {
+                sorted[k++] = sorted[i];
+            }
+        }
+        count = k;
+    }
+
+    {
+        size_t prefixElements = long_name_prefix_length * sizeof (dropt_char)
+                                / sizeof (dropt_uint32);
+        size_t numElements = 2 + prefixElements;
+        if (numElements > SIZE_MAX / count) { goto exit; }
+
+        index->lengths = context_malloc(context, numElements * count,
+                                           sizeof *(index->lengths));
+        if (index->lengths == NULL) { goto exit; }
+    }
+
+    index->count = count;
+    index->indices = index->lengths + count;
+    index->prefixes = (dropt_char*) (index->indices + count);
+
+    for (i = 0; i < count; i++)
+    {
+        const dropt_char* longName = long_name_key(context, sorted[i].position);
+        dropt_char* prefix = &index->prefixes[i * long_name_prefix_length];
+        size_t len = dropt_strlen(longName);
+        size_t j;
+
+        if (len >= (dropt_uint32) -1) { goto exit; }
+
+        index->lengths[i] = (dropt_uint32) len;
+        index->indices[i] = (dropt_uint32) sorted[i].position;
+        for (j = 0; j < long_name_prefix_length; j++)
+        {
+            prefix[j] = (j < len) ? longName[j] : DROPT_TEXT_LITERAL('\0');
+        }
     }
+
+    success = true;
+
+exit:
+    if (!success) { free_long_name_index(context, index); }
+    context_free(context, sorted);
+    return success;
 }
 
 
-#ifndef DROPT_NO_STRING_BUFFERS
-/** dropt_default_error_handler
+/** cmp_key_long_name_index
   *
-  *     Default error handler.
+  *     Compares a long option name against an entry in the context's
+  *     `long_name_index`.  Only the inline prefix of the entry is examined
+  *     unless the names agree on it.  If the context has folded names, the
+  *     name to search for must already be folded.
   *
   * PARAMETERS:
-  *     IN error          : The error code.
-  *     IN optionName     : The name of the option we failed on.
-  *     IN optionArgument : The value of the option we failed on.
-  *                         Pass `NULL` if unwanted.
+  *     IN context  : The dropt context.
+  *     IN longName : The long option name to search for.
+  *     IN i        : The position of the entry in the index.
   *
   * RETURNS:
-  *     An allocated string for the given error.  The caller is responsible for
-  *       calling `free()` on it when no longer needed.
-  *     May return `NULL`.
+  *     0 if `longName` and the entry are equivalent,
+  *     < 0 if `longName` should precede the entry,
+  *     > 0 if `longName` should follow the entry.
   */
-dropt_char*
-dropt_default_error_handler(dropt_error error,
-                            const dropt_char* optionName,
-                            const dropt_char* optionArgument)
+static int
+cmp_key_long_name_index(const dropt_context* context, char_array longName,
+                        size_t i)
 {
-    dropt_char* s = NULL;
+    const long_name_index* index = &context->longIndex;
+    size_t len = index->lengths[i];
+    size_t n = MIN(longName.len, len);
+    int ret;
 
-    const dropt_char* separator = DROPT_TEXT_LITERAL(": ");
+    /* Folded names need only exact comparisons. */
+    dropt_strncmp_func cmp = (context->foldedNames != NULL)
+                             ? dropt_strncmp
+                             : context->ncmpstr;
 
-    if (optionArgument == NULL)
+    ret = cmp(longName.s,
+              &index->prefixes[i * long_name_prefix_length],
+              MIN(n, long_name_prefix_length));
+    if (ret == 0 && n > long_name_prefix_length)
     {
-        separator = optionArgument = DROPT_TEXT_LITERAL("");
+        ret = cmp(longName.s,
+                  long_name_key(context, index->indices[i]),
+                  n);
     }
 
-    switch (error)
+    if (ret != 0)
     {
-        case dropt_error_none:
-            /* This shouldn't happen (unless client code invokes this directly
-             * with `dropt_error_none`), but it's here for completeness.
-             */
-            break;
-
-        case dropt_error_bad_configuration:
-            s = dropt_strdup(DROPT_TEXT_LITERAL("Invalid option configuration"));
-            break;
-
-        case dropt_error_invalid_option:
-            s = dropt_asprintf(DROPT_TEXT_LITERAL("Invalid option: %s"),
-                               optionName);
-            break;
-        case dropt_error_insufficient_arguments:
-            s = dropt_asprintf(DROPT_TEXT_LITERAL("Value required after option %s"),
-                               optionName);
-            break;
-        case dropt_error_mismatch:
-            s = dropt_asprintf(DROPT_TEXT_LITERAL("Invalid value for option %s%s%s"),
-                               optionName, separator, optionArgument);
-            break;
-        case dropt_error_overflow:
-            s = dropt_asprintf(DROPT_TEXT_LITERAL("Value too large for option %s%s%s"),
-                               optionName, separator, optionArgument);
-            break;
-        case dropt_error_underflow:
-            s = dropt_asprintf(DROPT_TEXT_LITERAL("Value too small for option %s%s%s"),
-                               optionName, separator, optionArgument);
-            break;
-        case dropt_error_insufficient_memory:
-            s = dropt_strdup(DROPT_TEXT_LITERAL("Insufficient memory"));
-            break;
-        case dropt_error_unknown:
-        default:
-            s = dropt_asprintf(DROPT_TEXT_LITERAL("Unknown error handling option %s"),
-                               optionName);
-            break;
+        return ret;
+    }
+    else if (longName.len < len)
+    {
+        return -1;
+    }
+    else if (longName.len > len)
+    {
+        return +1;
     }
 
-    return s;
+    return 0;
 }
 
 
-/** dropt_get_help
+/** cmp_prefix_long_name_index
+  *
+  *     Compares a long option name prefix against the beginning of an entry
+  *     in the context's `long_name_index`.  If the context has folded
+  *     names, the prefix must already be folded.
   *
   * PARAMETERS:
-  *     IN context    : The dropt context.
-  *                     Must not be `NULL`.
-  *     IN helpParams : The help parameters.
-  *                     Pass `NULL` to use the default help parameters.
+  *     IN context : The dropt context.
+  *     IN prefix  : The prefix to search for.
+  *     IN i       : The position of the entry in the index.
   *
   * RETURNS:
-  *     An allocated help string for the available options.  The caller is
-  *       responsible for calling `free()` on it when no longer needed.
-  *     Returns `NULL` on error.
+  *     0 if the entry begins with `prefix`,
+  *     < 0 if `prefix` should precede the entry,
+  *     > 0 if `prefix` should follow the entry.
   */
-dropt_char*
-dropt_get_help(const dropt_context* context,
-               const dropt_help_params* helpParams)
+static int
+cmp_prefix_long_name_index(const dropt_context* context, char_array prefix,
+                           size_t i)
 {
-    dropt_char* helpText = NULL;
-    dropt_stringstream* ss = dropt_ssopen();
+    const long_name_index* index = &context->longIndex;
+    size_t len = index->lengths[i];
+    int ret;
 
-    if (context == NULL)
+    dropt_strncmp_func cmp = (context->foldedNames != NULL)
+                             ? dropt_strncmp
+                             : context->ncmpstr;
+
+    ret = cmp(prefix.s,
+              long_name_key(context, index->indices[i]),
+              MIN(prefix.len, len));
+    if (ret != 0)
     {
-        DROPT_MISUSE("No dropt context specified.");
+        return ret;
     }
-    else if (ss != NULL)
+
+    /* An entry that is a proper prefix of `prefix` precedes it. */
+    return (len < prefix.len) ? +1 : 0;
+}
+
+
+/** merge_heap_precedes
+  *
+  *     Compares the next entries of two parts of a composite dropt context
+  *     during `merge_long_name_indices`.
+  *
+  * PARAMETERS:
+  *     IN context : The composite dropt context.
+  *     IN cursors : The position of the next entry in each part's index.
+  *     IN a, b    : The parts to compare.
+  *
+  * RETURNS:
+  *     true if part `a`'s next entry should precede part `b`'s.  Entries
+  *       with equivalent names are ordered by part.
+  */
+static bool
+merge_heap_precedes(const dropt_context* context, const size_t* cursors,
+                    size_t a, size_t b)
+{
+    const dropt_context* partA = context->parts[a];
+    const long_name_index* indexA = &partA->longIndex;
+    int ret = cmp_key_long_name_index(
+        context->parts[b],
+        make_char_array(long_name_key(partA, indexA->indices[cursors[a]]),
+                        indexA->lengths[cursors[a]]),
+        cursors[b]);
+    return (ret != 0) ? (ret < 0) : (a < b);
+}
+
+
+/** sift_merge_heap
+  *
+  *     Moves an element of the binary heap used by `merge_long_name_indices`
+  *     down until the heap is ordered.
+  *
+  * PARAMETERS:
+  *     IN context  : The composite dropt context.
+  *     IN cursors  : The position of the next entry in each part's index.
+  *     IN/OUT heap : The heap of parts, ordered by their next entries.
+  *     IN heapSize : The number of elements in `heap`.
+  *     IN i        : The position of the element to move.
+  */
+static void
+sift_merge_heap(const dropt_context* context, const size_t* cursors,
+                size_t* heap, size_t heapSize, size_t i)
+{
+    for (;;)
     {
-        const dropt_option* option;
-        dropt_help_params hp;
+        size_t least = i;
+        size_t child = 2 * i + 1;
+        size_t part;
 
-        if (helpParams == NULL)
+        if (   child < heapSize
+            && merge_heap_precedes(context, cursors, heap[child], heap[least]))
         {
-            dropt_init_help_params(&hp);
+            least = child;
         }
-        else
+        child++;
+        if (   child < heapSize
+            && merge_heap_precedes(context, cursors, heap[child], heap[least]))
         {
-            hp = *helpParams;
+            least = child;
         }
 
-        for (option = context->options; is_valid_option(option); option++)
-        {
-            bool hasLongName =    option->long_name != NULL
-                               && option->long_name[0] != DROPT_TEXT_LITERAL('\0');
-            bool hasShortName = option->short_name != DROPT_TEXT_LITERAL('\0');
+        if (least == i) { break; }
 
-            /* The number of characters printed on the current line so far. */
-            int n;
+        part = heap[i];
+        heap[i] = heap[least];
+        heap[least] = part;
+        i = least;
+    }
+}
 
-            if (   option->description == NULL
-                || (option->attr & dropt_attr_hidden))
-            {
-                /* Undocumented option.  Ignore it and move on. */
-                continue;
-            }
-            else if (hasLongName && hasShortName)
-            {
-                n = dropt_ssprintf(ss, DROPT_TEXT_LITERAL("%*s-%c, --%s"),
-                                   hp.indent, DROPT_TEXT_LITERAL(""),
-                                   option->short_name, option->long_name);
-            }
-            else if (hasLongName)
-            {
-                n = dropt_ssprintf(ss, DROPT_TEXT_LITERAL("%*s--%s"),
-                                   hp.indent, DROPT_TEXT_LITERAL(""),
-                                   option->long_name);
-            }
-            else if (hasShortName)
-            {
-                n = dropt_ssprintf(ss, DROPT_TEXT_LITERAL("%*s-%c"),
-                                   hp.indent, DROPT_TEXT_LITERAL(""),
-                                   option->short_name);
-            }
-            else
-            {
-                /* Comment text.  Don't bother with indentation. */
-                assert(option->description != NULL);
-                dropt_ssprintf(ss, DROPT_TEXT_LITERAL("%s\n"), option->description);
-                goto next;
-            }
 
-            if (n < 0) { n = 0; }
+/** merge_long_name_indices
+  *
+  *     Builds the sorted index of the long option names in a composite
+  *     dropt context (see `dropt_new_composite_context`) with a k-way merge
+  *     of its parts' indices, so the names don't need to be sorted again.
+  *     The parts' indices must already be built and must order names the
+  *     same way that the composite context does.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The composite dropt context.
+  *                      Must not be `NULL`.
+  *
+  * RETURNS:
+  *     true on success, false on failure.  On failure, the context is left
+  *       without an index, and `init_long_name_index` should build it
+  *       instead.
+  */
+static bool
+merge_long_name_indices(dropt_context* context)
+{
+    long_name_index* index;
+    size_t* bases = NULL;
+    size_t* cursors;
+    size_t* heap;
+    size_t heapSize = 0;
+    size_t total = 0;
+    size_t count = 0;
+    size_t base = 0;
+    size_t i;
+    bool success = false;
 
-            if (option->arg_description != NULL)
-            {
-                int m = dropt_ssprintf(ss,
-                                       (option->attr & dropt_attr_optional_val)
-                                       ? DROPT_TEXT_LITERAL("[=%s]")
-                                       : DROPT_TEXT_LITERAL("=%s"),
-                                       option->arg_description);
-                if (m > 0) { n += m; }
-            }
+    assert(context != NULL);
+    assert(context->parts != NULL);
 
-            /* Check for equality to make sure that there's at least one
-             * space between the option name and its description.
+    index = &context->longIndex;
+    free_long_name_index(context, index);
+
+    for (i = 0; i < context->numParts; i++)
+    {
+        const dropt_context* part = context->parts[i];
+
+        if (   part->ncmpstr != context->ncmpstr
+            || (part->foldedNames != NULL) != (context->foldedNames != NULL))
+        {
+            goto exit;
+        }
+
+        if (part->longIndex.lengths != NULL)
+        {
+            total += part->longIndex.count;
+        }
+        else
+        {
+            /* The part has no index to merge, which is fine only if it has
+             * no long names.
              */
-            if ((unsigned int) n >= hp.description_start_column)
+            size_t j;
+            for (j = 0; j < part->numOptions; j++)
             {
-                dropt_ssprintf(ss, DROPT_TEXT_LITERAL("\n"));
-                n = 0;
+                if (context_option(part, j)->long_name != NULL) { goto exit; }
             }
+        }
+    }
 
-            {
-                const dropt_char* line = option->description;
-                while (line != NULL)
-                {
-                    int lineLen;
-                    const dropt_char* nextLine;
-                    const dropt_char* newline = dropt_strchr(line, DROPT_TEXT_LITERAL('\n'));
+    if (total == 0 || total >= (dropt_uint32) -1) { goto exit; }
 
-                    if (newline == NULL)
-                    {
-                        lineLen = dropt_strlen(line);
-                        nextLine = NULL;
-                    }
-                    else
-                    {
-                        lineLen = newline - line;
-                        nextLine = newline + 1;
-                    }
+    bases = context_malloc(context, 3 * context->numParts, sizeof *bases);
+    if (bases == NULL) { goto exit; }
+    cursors = bases + context->numParts;
+    heap = cursors + context->numParts;
 
-                    dropt_ssprintf(ss, DROPT_TEXT_LITERAL("%*s%.*s\n"),
-                                   hp.description_start_column - n, DROPT_TEXT_LITERAL(""),
-                                   lineLen, line);
-                    n = 0;
+    {
+        size_t prefixElements = long_name_prefix_length * sizeof (dropt_char)
+                                / sizeof (dropt_uint32);
+        size_t numElements = 2 + prefixElements;
+        if (numElements > SIZE_MAX / total) { goto exit; }
+
+        index->lengths = context_malloc(context, numElements * total,
+                                        sizeof *(index->lengths));
+        if (index->lengths == NULL) { goto exit; }
+    }
 
-                    line = nextLine;
-                }
-            }
+    index->indices = index->lengths + total;
+    index->prefixes = (dropt_char*) (index->indices + total);
 
-        next:
-            if (hp.blank_lines_between_options)
-            {
-                dropt_ssprintf(ss, DROPT_TEXT_LITERAL("\n"));
-            }
+    for (i = 0; i < context->numParts; i++)
+    {
+        const dropt_context* part = context->parts[i];
+        bases[i] = base;
+        cursors[i] = 0;
+        base += part->numOptions;
+        if (part->longIndex.lengths != NULL && part->longIndex.count != 0)
+        {
+            heap[heapSize++] = i;
         }
-        helpText = dropt_ssfinalize(ss);
     }
 
-    return helpText;
+    for (i = heapSize / 2; i > 0; i--)
+    {
+        sift_merge_heap(context, cursors, heap, heapSize, i - 1);
+    }
+
+    while (heapSize > 0)
+    {
+        size_t p = heap[0];
+        const dropt_context* part = context->parts[p];
+        const long_name_index* subIndex = &part->longIndex;
+        size_t j = cursors[p]++;
+
+        /* If multiple options have equivalent long names, the first one
+         * wins.
+         */
+        if (   count == 0
+            || cmp_key_long_name_index(
+                   context,
+                   make_char_array(long_name_key(part, subIndex->indices[j]),
+                                   subIndex->lengths[j]),
+                   count - 1) != 0)
+        {
+            index->lengths[count] = subIndex->lengths[j];
+            index->indices[count] = (dropt_uint32) (bases[p]
+                                                    + subIndex->indices[j]);
+            memcpy(&index->prefixes[count * long_name_prefix_length],
+                   &subIndex->prefixes[j * long_name_prefix_length],
+                   long_name_prefix_length * sizeof (dropt_char));
+            count++;
+        }
+
+        if (cursors[p] == subIndex->count) { heap[0] = heap[--heapSize]; }
+        sift_merge_heap(context, cursors, heap, heapSize, 0);
+    }
+
+    /* Close the gaps left by duplicate names. */
+    if (count < total)
+    {
+        memmove(index->lengths + count, index->indices,
+                count * sizeof *(index->indices));
+        index->indices = index->lengths + count;
+        memmove(index->indices + count, index->prefixes,
+                count * long_name_prefix_length * sizeof (dropt_char));
+        index->prefixes = (dropt_char*) (index->indices + count);
+    }
+
+    index->count = count;
+    success = true;
+
+exit:
+    if (!success) { free_long_name_index(context, index); }
+    context_free(context, bases);
+    return success;
 }
 
 
-/** dropt_print_help
-  *
-  *     Prints help for the available options.
+/** char_label
   *
   * PARAMETERS:
-  *     IN/OUT f      : The file stream to print to.
-  *     IN context    : The dropt context.
-  *                     Must not be `NULL`.
-  *     IN helpParams : The help parameters.
-  *                     Pass `NULL` to use the default help parameters.
+  *     IN c : A character.
+  *
+  * RETURNS:
+  *     The character's code, as stored in `prefix_trie_node` labels.
   */
-void
-dropt_print_help(FILE* f, const dropt_context* context,
-                 const dropt_help_params* helpParams)
+static dropt_uint32
+char_label(dropt_char c)
 {
-    dropt_char* helpText = dropt_get_help(context, helpParams);
-    if (helpText != NULL)
-    {
-        dropt_fputs(helpText, f);
-        free(helpText);
-    }
+#ifdef DROPT_USE_WCHAR
+    return (dropt_uint32) c;
+#else
+    return (unsigned char) c;
+#endif
 }
-#endif /* DROPT_NO_STRING_BUFFERS */
 
 
-/** set_option_value
+/** free_prefix_trie
   *
-  *     Sets the value for a specified option by invoking the option's
-  *     handler callback.
+  *     Frees a `prefix_trie`.
   *
   * PARAMETERS:
-  *     IN/OUT context    : The dropt context.
-  *     IN option         : The option.
-  *     IN optionArgument : The option's value.  May be `NULL`.
-  *
-  * RETURNS:
-  *     An error code.
+  *     IN context  : The dropt context that owns the trie.
+  *     IN/OUT trie : The trie to free.
+  *                   Must not be `NULL`.
   */
-static dropt_error
-set_option_value(dropt_context* context,
-                 const dropt_option* option, const dropt_char* optionArgument)
+static void
+free_prefix_trie(const dropt_context* context, prefix_trie* trie)
 {
-    assert(option != NULL);
+    prefix_trie emptyTrie = { 0 };
 
-    if (option->handler == NULL)
-    {
-        DROPT_MISUSE("No option handler specified.");
-        return dropt_error_bad_configuration;
-    }
+    assert(trie != NULL);
 
-    return option->handler(context, option, optionArgument,
-                           option->dest);
+    if (!trie->borrowed) { context_free(context, trie->nodes); }
+    *trie = emptyTrie;
 }
 
 
-/** parse_option_arg
+/** init_prefix_trie
   *
-  *     Helper function to `parse_long_option` and `parse_short_option` to
-  *     deal with consuming possibly optional arguments.
+  *     Builds the compressed trie over the context's `long_name_index`,
+  *     which must already be built.
   *
   * PARAMETERS:
   *     IN/OUT context : The dropt context.
-  *     IN/OUT ps      : The current parse state.
+  *                      Must not be `NULL`.
   *
   * RETURNS:
-  *     An error code.
+  *     true on success, false on failure.  On failure, the context is left
+  *       without a trie, and abbreviations should be resolved by binary
+  *       searching the index instead.
   */
-static dropt_error
-parse_option_arg(dropt_context* context, parse_state* ps)
+static bool
+init_prefix_trie(dropt_context* context)
 {
-    dropt_error err;
+    const long_name_index* index;
+    prefix_trie* trie;
+    size_t capacity;
+    size_t k;
 
-    bool consumeNextArg = false;
+    assert(context != NULL);
 
-    if (OPTION_TAKES_ARG(ps->option) && ps->optionArgument == NULL)
+    index = &context->longIndex;
+    trie = &context->prefixTrie;
+    free_prefix_trie(context, trie);
+
+    if (index->lengths == NULL || index->count > SIZE_MAX / 2) { return false; }
+
+    capacity = 2 * index->count;
+    trie->nodes = context_malloc(context, capacity, sizeof *(trie->nodes));
+    if (trie->nodes == NULL) { return false; }
+
+    trie->nodes[0].first = 0;
+    trie->nodes[0].count = (dropt_uint32) index->count;
+    trie->nodes[0].depth = 0;
+    trie->nodes[0].label = 0;
+    trie->numNodes = 1;
+
+    /* Expand the nodes in breadth-first order so that each node's children
+     * are added consecutively.
+     */
+    for (k = 0; k < trie->numNodes; k++)
     {
-        /* The option expects an argument, but none was specified with '='.
-         * Try using the next item from the command-line.
+        prefix_trie_node* node = &trie->nodes[k];
+        size_t end = node->first + node->count;
+        size_t depth = node->depth;
+        size_t i;
+
+        const dropt_char* firstName
+            = long_name_key(context, index->indices[node->first]);
+        size_t firstLen = index->lengths[node->first];
+
+        /* Since the entries are sorted, the prefix shared by all of them is
+         * the one shared by the first and the last.
          */
-        if (ps->argsLeft > 0 && *(ps->argNext) != NULL)
+        if (node->count == 1)
         {
-            consumeNextArg = true;
-            ps->optionArgument = *(ps->argNext);
+            depth = firstLen;
         }
-        else if (!(ps->option->attr & dropt_attr_optional_val))
+        else
         {
-            err = dropt_error_insufficient_arguments;
-            goto exit;
+            const dropt_char* lastName
+                = long_name_key(context, index->indices[end - 1]);
+            size_t n = MIN(firstLen, index->lengths[end - 1]);
+            while (depth < n && firstName[depth] == lastName[depth]) { depth++; }
         }
-    }
 
-    /* Even for options that don't ask for arguments, always parse and
-     * consume an argument that was specified with '='.
-     */
-    err = set_option_value(context, ps->option, ps->optionArgument);
+        node->depth = (dropt_uint32) depth;
+        node->children = (dropt_uint32) trie->numNodes;
+        node->numChildren = 0;
 
-    if (   err != dropt_error_none
-        && (ps->option->attr & dropt_attr_optional_val)
-        && consumeNextArg
-        && ps->optionArgument != NULL)
-    {
-        /* The option's handler didn't like the argument we fed it.  If the
-         * argument was optional, try again without it.
-         */
-        consumeNextArg = false;
-        ps->optionArgument = NULL;
-        err = set_option_value(context, ps->option, NULL);
-    }
+        i = node->first;
+        if (i < end && firstLen == depth) { i++; }
 
-exit:
-    if (err == dropt_error_none && consumeNextArg)
-    {
-        ps->argNext++;
-        ps->argsLeft--;
+        while (i < end)
+        {
+            dropt_char c = long_name_key(context, index->indices[i])[depth];
+            size_t j = i + 1;
+            prefix_trie_node* child;
+
+            while (   j < end
+                   && long_name_key(context, index->indices[j])[depth] == c)
+            {
+                j++;
+            }
+
+            assert(trie->numNodes < capacity);
+            child = &trie->nodes[trie->numNodes++];
+            child->first = (dropt_uint32) i;
+            child->count = (dropt_uint32) (j - i);
+            child->depth = (dropt_uint32) (depth + 1);
+            child->label = char_label(c);
+            node->numChildren++;
+
+            i = j;
+        }
     }
-    return err;
+
+    return true;
 }
 
 
-/** parse_long_option
+/** find_long_name_prefix
   *
-  *     Helper function to `dropt_parse` to deal with consuming a long option.
+  *     Finds the entries in the context's `long_name_index` that begin with
+  *     a long option name prefix.  The matching entries are consecutive.
+  *     If the context has folded names, the prefix must already be folded.
   *
   * PARAMETERS:
-  *     IN/OUT context : The dropt context.
-  *     IN/OUT ps      : The current parse state.
-  *     IN arg         : The command-line argument with the long option.
-  *                      (Examples: "--longName", "--longName=ARGUMENT")
+  *     IN context : The dropt context.
+  *                  Its `long_name_index` must be built.
+  *     IN prefix  : The prefix to search for.
+  *     OUT first  : On output, the position of the first matching entry.
   *
   * RETURNS:
-  *     true if parsing should continue, false if it should halt.
+  *     The number of matching entries.
   */
-static bool
-parse_long_option(dropt_context* context, parse_state* ps,
-                  const dropt_char* arg)
+static size_t
+find_long_name_prefix(const dropt_context* context, char_array prefix,
+                      size_t* first)
 {
-    bool continueParsing = false;
+    const long_name_index* index = &context->longIndex;
+    size_t lo = 0;
+    size_t hi = index->count;
+    size_t end;
 
-    dropt_error err = dropt_error_none;
+    assert(index->lengths != NULL);
+    assert(first != NULL);
 
-    const dropt_char* longName = arg + 2;
-    const dropt_char* longNameEnd;
-    if (longName[0] == DROPT_TEXT_LITERAL('\0'))
+    if (context->prefixTrie.nodes != NULL)
     {
-        /* -- */
+        const prefix_trie_node* nodes = context->prefixTrie.nodes;
+        const prefix_trie_node* node = &nodes[0];
+        size_t matched = 0;
 
-        /* This is used to mark the end of the option processing
-         * to prevent some arguments with leading '-' characters
-         * from being treated as options.
-         *
-         * Don't pass this back to the caller.
+        /* Each character of the prefix is examined once, plus a scan of the
+         * children at each branch, which is bounded by the size of the
+         * alphabet.
          */
-        goto exit;
+        for (;;)
+        {
+            const dropt_char* name
+                = long_name_key(context, index->indices[node->first]);
+            const prefix_trie_node* child;
+            const prefix_trie_node* lastChild;
+            dropt_uint32 c;
+
+            for (; matched < MIN(prefix.len, node->depth); matched++)
+            {
+                if (prefix.s[matched] != name[matched]) { return 0; }
+            }
+
+            if (prefix.len <= node->depth)
+            {
+                *first = node->first;
+                return node->count;
+            }
+
+            c = char_label(prefix.s[matched]);
+            child = &nodes[node->children];
+            lastChild = child + node->numChildren;
+            while (child < lastChild && child->label != c) { child++; }
+            if (child == lastChild) { return 0; }
+
+            node = child;
+            matched++;
+        }
     }
 
-    /* --longName */
-    longNameEnd = dropt_strchr(longName, DROPT_TEXT_LITERAL('='));
-    if (longNameEnd == longName)
+    /* Binary search for the first entry that doesn't precede the prefix. */
+    while (lo < hi)
     {
-        /* Deal with the pathological case of a user supplying
-         * "--=".
-         */
-        err = dropt_error_invalid_option;
-        set_error_details(context, err,
-                          make_char_array(arg, dropt_strlen(arg)),
-                          NULL);
-        goto exit;
+        size_t mid = lo + (hi - lo) / 2;
+        if (cmp_prefix_long_name_index(context, prefix, mid) > 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
     }
-    else if (longNameEnd == NULL)
+
+    /* And then for the first entry after the matching ones. */
+    *first = lo;
+    end = index->count;
+    while (lo < end)
     {
-        longNameEnd = longName + dropt_strlen(longName);
-        assert(ps->optionArgument == NULL);
+        size_t mid = lo + (end - lo) / 2;
+        if (cmp_prefix_long_name_index(context, prefix, mid) == 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            end = mid;
+        }
     }
-    else
+
+    return lo - *first;
+}
+
+
+/** free_folded_names
+  *
+  *     Frees the folded long names in a dropt context.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  */
+static void
+free_folded_names(dropt_context* context)
+{
+    assert(context != NULL);
+
+    if (!context->foldedNamesBorrowed) { context_free(context, context->foldedNames); }
+    context->foldedNames = NULL;
+    context->longestFoldedName = 0;
+    context->foldedNamesBorrowed = false;
+}
+
+
+/** init_folded_names
+  *
+  *     Folds the long option names in a case-insensitive dropt context so
+  *     that the lookup tables can be built from, and searched with, exact
+  *     comparisons.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *
+  * RETURNS:
+  *     true on success, false on failure.  On failure, the context is left
+  *       without folded names, and the lookup tables should compare the
+  *       original names with the context's `dropt_strncmp_func` instead.
+  */
+static bool
+init_folded_names(dropt_context* context)
+{
+    size_t numChars = 0;
+    size_t longest = 0;
+    size_t size;
+    dropt_char* text;
+    size_t i;
+
+    assert(context != NULL);
+    assert(context->ncmpstr == fold_strncmp);
+
+    free_folded_names(context);
+
+    for (i = 0; i < context->numOptions; i++)
     {
-        /* --longName=ARGUMENT */
-        ps->optionArgument = longNameEnd + 1;
+        const dropt_char* longName = context_option(context, i)->long_name;
+        if (longName != NULL)
+        {
+            size_t len = dropt_strlen(longName);
+            if (len > longest) { longest = len; }
+            if (numChars > SIZE_MAX - len - 1) { return false; }
+            numChars += len + 1;
+        }
     }
 
-    /* Pass the length of the option name so that we don't need
-     * to mutate the original string by inserting a
-     * `NUL`-terminator.
-     */
-    ps->option = find_option_long(context,
-                                  make_char_array(longName,
-                                                  longNameEnd - longName));
-    if (ps->option == NULL)
+    if (numChars == 0) { return false; }
+
+    if (   context->numOptions > SIZE_MAX / sizeof *(context->foldedNames)
+        || numChars > (SIZE_MAX - context->numOptions
+                                  * sizeof *(context->foldedNames))
+                      / sizeof (dropt_char))
     {
-        err = dropt_error_invalid_option;
-        set_error_details(context, err,
-                          make_char_array(arg, longNameEnd - arg),
-                          NULL);
+        return false;
     }
-    else
+
+    size = context->numOptions * sizeof *(context->foldedNames)
+           + numChars * sizeof (dropt_char);
+    context->foldedNames = context_malloc(context, size, 1);
+    if (context->foldedNames == NULL) { return false; }
+
+    text = (dropt_char*) (context->foldedNames + context->numOptions);
+    for (i = 0; i < context->numOptions; i++)
     {
-        err = parse_option_arg(context, ps);
-        if (err != dropt_error_none)
+        const dropt_char* longName = context_option(context, i)->long_name;
+        if (longName == NULL)
         {
-            set_error_details(context, err,
-                              make_char_array(arg, longNameEnd - arg),
-                              ps->optionArgument);
+            context->foldedNames[i] = NULL;
+        }
+        else
+        {
+            size_t len = dropt_strlen(longName);
+            fold_chars(text, longName, len + 1);
+            context->foldedNames[i] = text;
+            text += len + 1;
         }
     }
 
-    if (   err != dropt_error_none
-        || (ps->option->attr & dropt_attr_halt))
+    context->longestFoldedName = longest;
+    return true;
+}
+
+
+/** find_subcommand_slot
+  *
+  * PARAMETERS:
+  *     IN registry : The subcommand registry.  Its hash must have been
+  *                     built.
+  *     IN name     : The subcommand name to search for.
+  *
+  * RETURNS:
+  *     The slot holding the subcommand with the specified name, or the
+  *       empty slot where it would be inserted if there is none.
+  */
+static size_t
+find_subcommand_slot(const subcommand_registry* registry, char_array name)
+{
+    dropt_uint32 h1;
+    dropt_uint32 h2;
+    size_t mask;
+    size_t slot;
+
+    assert(registry != NULL);
+    assert(registry->slots != NULL);
+
+    hash_name(name, &h1, &h2);
+    mask = registry->numSlots - 1;
+
+    /* The hash is at most half full, so probing always reaches an empty
+     * slot.
+     */
+    for (slot = h1 & mask; ; slot = (slot + 1) & mask)
     {
-        goto exit;
+        dropt_uint32 i = registry->slots[slot];
+        const dropt_char* other;
+
+        if (i == EMPTY_HASH_SLOT) { break; }
+
+        other = registry->list[i].name;
+        if (   dropt_strncmp(other, name.s, name.len) == 0
+            && other[name.len] == DROPT_TEXT_LITERAL('\0'))
+        {
+            break;
+        }
     }
 
-    continueParsing = true;
+    return slot;
+}
 
-exit:
-    return continueParsing;
+
+/** free_subcommand_hash
+  *
+  *     Frees the name hash of a `subcommand_registry`.
+  *
+  * PARAMETERS:
+  *     IN context      : The dropt context that owns the registry.
+  *     IN/OUT registry : The subcommand registry.
+  *                       Must not be `NULL`.
+  */
+static void
+free_subcommand_hash(const dropt_context* context,
+                     subcommand_registry* registry)
+{
+    assert(registry != NULL);
+
+    if (!registry->borrowed) { context_free(context, registry->slots); }
+    registry->slots = NULL;
+    registry->numSlots = 0;
+    registry->borrowed = false;
 }
 
 
-/** parse_short_option
+/** init_subcommand_hash
   *
-  *     Helper function to `dropt_parse` to deal with consuming one or more
-  *     short options.
+  *     Hashes the names of a dropt context's subcommands.  If the same name
+  *     is used by multiple subcommands, the first one wins.
   *
   * PARAMETERS:
   *     IN/OUT context : The dropt context.
-  *     IN/OUT ps      : The current parse state.
-  *     IN arg         : The command-line argument with one or more short
-  *                        options.
-  *                      (Examples: "-a", "-abc", "-oARGUMENT", "-o=ARGUMENT")
+  *                      Must not be `NULL`.
   *
   * RETURNS:
-  *     true if parsing should continue, false if it should halt.
+  *     true on success, false on failure.  On failure, the context is left
+  *       without a hash, and lookups should search the list instead.
   */
 static bool
-parse_short_option(dropt_context* context, parse_state* ps,
-                   const dropt_char* arg)
+init_subcommand_hash(dropt_context* context)
 {
-    bool continueParsing = false;
-
-    dropt_error err = dropt_error_none;
+    subcommand_registry* registry;
+    size_t numSlots = 1;
+    size_t i;
 
-    size_t len;
-    size_t j;
+    assert(context != NULL);
 
-    const dropt_char* shortOptionGroup = arg + 1;
-    const dropt_char* shortOptionGroupEnd
-        = dropt_strchr(shortOptionGroup, DROPT_TEXT_LITERAL('='));
+    registry = &context->subcommands;
+    assert(registry->slots == NULL);
 
-    if (shortOptionGroupEnd == shortOptionGroup)
+    if (   registry->count == 0
+        || registry->count >= EMPTY_HASH_SLOT
+        || registry->count > ((size_t) -1) / 4)
     {
-        /* Deal with the pathological case of a user supplying
-         * "-=".
-         */
-        err = dropt_error_invalid_option;
-        set_error_details(context, err,
-                          make_char_array(arg, dropt_strlen(arg)),
-                          NULL);
-        goto exit;
+        return false;
     }
-    else if (shortOptionGroupEnd != NULL)
+
+    while (numSlots < 2 * registry->count) { numSlots *= 2; }
+
+    registry->slots = context_malloc(context, numSlots,
+                                     sizeof *(registry->slots));
+    if (registry->slots == NULL) { return false; }
+
+    registry->numSlots = numSlots;
+    registry->borrowed = false;
+
+    for (i = 0; i < numSlots; i++)
     {
-        /* -x=ARGUMENT */
-        len = shortOptionGroupEnd - shortOptionGroup;
-        ps->optionArgument = shortOptionGroupEnd + 1;
+        registry->slots[i] = EMPTY_HASH_SLOT;
     }
-    else
+
+    for (i = 0; i < registry->count; i++)
     {
-        len = dropt_strlen(shortOptionGroup);
-        assert(ps->optionArgument == NULL);
+        const dropt_char* name = registry->list[i].name;
+        size_t slot = find_subcommand_slot(registry,
+                                           make_char_array(name,
+                                                           dropt_strlen(name)));
+        if (registry->slots[slot] == EMPTY_HASH_SLOT)
+        {
+            registry->slots[slot] = (dropt_uint32) i;
+        }
     }
 
-    for (j = 0; j < len; j++)
+    return true;
+}
+
+
+/** init_lookup_tables
+  *
+  *     Initializes the lookup tables in a dropt context if not already
+  *     initialized.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  */
+static void
+init_lookup_tables(dropt_context* context)
+{
+    size_t n;
+    bool built = false;
+
+    assert(context != NULL);
+
+    n = context->numOptions;
+
+    if (context->longIndex.lengths == NULL)
     {
-        ps->option = find_option_short(context, shortOptionGroup[j]);
-        if (ps->option == NULL)
+        built = true;
+
+        /* Case-insensitive contexts fold the names once up front so that
+         * lookups need only exact comparisons.
+         */
+        if (context->ncmpstr == fold_strncmp && context->foldedNames == NULL)
         {
-            err = dropt_error_invalid_option;
-            set_short_option_error_details(context, err,
-                                           shortOptionGroup[j], NULL);
-            goto exit;
+            init_folded_names(context);
         }
-        else if (j + 1 == len)
+
+        /* Composite contexts merge their parts' indices when they can. */
+        if (context->parts == NULL || !merge_long_name_indices(context))
         {
-            /* The last short option in a condensed list gets
-             * to use an argument.
-             */
-            err = parse_option_arg(context, ps);
-            if (err != dropt_error_none)
-            {
-                set_short_option_error_details(context, err,
-                                               shortOptionGroup[j],
-                                               ps->optionArgument);
-                goto exit;
-            }
+            init_long_name_index(context);
         }
-        else if (   context->allowConcatenatedArgs
-                 && OPTION_TAKES_ARG(ps->option)
-                 && j == 0)
-        {
-            err = set_option_value(context, ps->option,
-                                   &shortOptionGroup[j + 1]);
-
-            if (   err != dropt_error_none
-                && (ps->option->attr & dropt_attr_optional_val))
-            {
-                err = set_option_value(context, ps->option, NULL);
-            }
 
-            if (err != dropt_error_none)
-            {
-                set_short_option_error_details(context, err,
-                                               shortOptionGroup[j],
-                                               &shortOptionGroup[j + 1]);
-                goto exit;
-            }
-
-            /* Skip to the next argument. */
-            break;
+        /* The hash can't model custom comparison functions.  If building it
+         * fails, we'll fall back to the sorted index.
+         */
+        if (   context->useHashedLookup
+            && (   context->ncmpstr == dropt_strncmp
+                || context->foldedNames != NULL))
+        {
+            init_long_name_hash(context);
         }
-        else if (   OPTION_TAKES_ARG(ps->option)
-                 && !(ps->option->attr & dropt_attr_optional_val))
+
+        /* Likewise for the trie. */
+        if (   context->allowAbbreviations
+            && (   context->ncmpstr == dropt_strncmp
+                || context->foldedNames != NULL))
         {
-            /* Short options with required arguments can't be used
-             * in condensed lists except in the last position.
-             *
-             * e.g. -abcd ARGUMENT
-             *          ^
-             */
-            err = dropt_error_insufficient_arguments;
-            set_short_option_error_details(context, err,
-                                           shortOptionGroup[j], NULL);
-            goto exit;
+            init_prefix_trie(context);
         }
-        else
+    }
+
+    /* As with the long name hash, the direct table can't model custom
+     * comparison functions.  If we can build it, we don't need the sorted
+     * table.
+     */
+    if (   context->shortTable.slots == NULL
+        && context->sortedByShort == NULL
+        && (   context->ncmpstr == dropt_strncmp
+            || context->ncmpstr == fold_strncmp))
+    {
+        built = true;
+        init_short_name_table(context);
+    }
+
+    if (context->shortTable.slots == NULL && context->sortedByShort == NULL)
+    {
+        built = true;
+        context->sortedByShort
+            = context_malloc(context, n, sizeof *(context->sortedByShort));
+        if (context->sortedByShort != NULL)
         {
-            err = set_option_value(context, ps->option, NULL);
-            if (err != dropt_error_none)
+            size_t i;
+            for (i = 0; i < n; i++)
             {
-                set_short_option_error_details(context, err,
-                                               shortOptionGroup[j],
-                                               NULL);
-                goto exit;
+                context->sortedByShort[i].option = context_option(context, i);
+                context->sortedByShort[i].position = i;
+                context->sortedByShort[i].context = context;
             }
+
+            qsort(context->sortedByShort,
+                  n, sizeof *(context->sortedByShort),
+                  cmp_option_proxies_short);
         }
+    }
 
-        if (ps->option->attr & dropt_attr_halt) { goto exit; }
+    if (   context->subcommands.list != NULL
+        && context->subcommands.slots == NULL)
+    {
+        built = true;
+        init_subcommand_hash(context);
     }
 
-    assert(err == dropt_error_none);
-    continueParsing = true;
+    /* The lookup tables persist across `dropt_reset_context`. */
+    if (built && context->arena != NULL)
+    {
+        context->arena->mark = context->arena->top;
+        context->arena->markLastBlock = context->arena->lastBlock;
+    }
+}
 
-exit:
-    return continueParsing;
+
+/** free_lookup_tables
+  *
+  *     Frees the lookup tables in a dropt context.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      May be `NULL`.
+  */
+static void
+free_lookup_tables(dropt_context* context)
+{
+    if (context != NULL)
+    {
+        free_long_name_index(context, &context->longIndex);
+
+        if (!context->sortedByShortBorrowed) { context_free(context, context->sortedByShort); }
+        context->sortedByShort = NULL;
+        context->sortedByShortBorrowed = false;
+
+        free_long_name_hash(context, &context->longHash);
+        free_short_name_table(context, &context->shortTable);
+        free_prefix_trie(context, &context->prefixTrie);
+        free_folded_names(context);
+        free_subcommand_hash(context, &context->subcommands);
+
+        /* Any error candidates pointed into the tables. */
+        context->errorDetails.candidates = NULL;
+        context->errorDetails.numCandidates = 0;
+    }
+}
+
+
+/** is_valid_option
+  *
+  * PARAMETERS:
+  *     IN option : Specification for an individual option.
+  *
+  * RETURNS:
+  *     true if the specified option is valid, false if it's a sentinel value.
+  */
+static bool
+is_valid_option(const dropt_option* option)
+{
+    return    option != NULL
+           && !(   option->long_name == NULL
+                && option->short_name == DROPT_TEXT_LITERAL('\0')
+                && option->description == NULL
+                && option->arg_description == NULL
+                && option->handler == NULL
+                && option->dest == NULL
+                && option->attr == 0
+                && option->extra_data == 0);
+}
+
+
+/** find_option_long
+  *
+  *     Finds the option specification for a long option name (i.e., an option
+  *     of the form "--option").
+  *
+  * PARAMETERS:
+  *     IN context     : The dropt context.
+  *     IN longName    : The long option name to search for (excluding leading
+  *                        dashes).
+  *                      `longName.s` must not be `NULL`.
+  *     IN abbreviations : Whether to resolve `longName` as an abbreviation
+  *                          if it doesn't match a name exactly and the
+  *                          context allows abbreviations.
+  *     OUT candidates : If abbreviations are allowed and `longName` is an
+  *                        ambiguous prefix, on output, the indices of the
+  *                        options that it could refer to.  Otherwise `NULL`
+  *                        on output.
+  *                      Must not be `NULL`.
+  *     OUT numCandidates : On output, the number of `candidates`.
+  *                         Must not be `NULL`.
+  *
+  * RETURNS:
+  *     A pointer to the corresponding option specification or `NULL` if not
+  *       found.
+  */
+static const dropt_option*
+find_option_long(const dropt_context* context,
+                 char_array longName, bool abbreviations,
+                 const dropt_uint32** candidates, size_t* numCandidates)
+{
+    const dropt_option* found = NULL;
+    dropt_char buffer[fold_buffer_length];
+    dropt_char* folded = NULL;
+    bool indexed;
+
+    assert(context != NULL);
+    assert(longName.s != NULL);
+    assert(candidates != NULL);
+    assert(numCandidates != NULL);
+
+    *candidates = NULL;
+    *numCandidates = 0;
+
+    indexed = (   context->longHash.seeds != NULL
+               || context->longIndex.lengths != NULL);
+
+    /* The lookup tables of case-insensitive contexts are keyed by the
+     * folded names, so fold the name to search for once up front.  (The
+     * linear search compares case-insensitively anyway.)
+     */
+    if (context->foldedNames != NULL && indexed)
+    {
+        if (longName.len > context->longestFoldedName) { goto exit; }
+
+        folded = (longName.len <= ARRAY_LENGTH(buffer))
+                 ? buffer
+                 : context_malloc(context, longName.len, sizeof *folded);
+        if (folded == NULL)
+        {
+            indexed = false;
+        }
+        else
+        {
+            fold_chars(folded, longName.s, longName.len);
+            longName.s = folded;
+        }
+    }
+
+    if (indexed && context->longHash.seeds != NULL)
+    {
+        const long_name_hash* hash = &context->longHash;
+        dropt_uint32 h1, h2;
+        size_t slot;
+
+        hash_name(longName, &h1, &h2);
+        slot = hash_slot(h1, h2, hash->seeds[h1 % hash->numBuckets],
+                         hash->numSlots);
+        if (hash->lengths[slot] == longName.len)
+        {
+            if (memcmp(longName.s, long_name_key(context, hash->slots[slot]),
+                       longName.len * sizeof *(longName.s)) == 0)
+            {
+                found = context_option(context, hash->slots[slot]);
+            }
+        }
+    }
+    else if (indexed)
+    {
+        size_t lo = 0;
+        size_t hi = context->longIndex.count;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            int ret = cmp_key_long_name_index(context, longName, mid);
+            if (ret == 0)
+            {
+                found = context_option(context, context->longIndex.indices[mid]);
+                break;
+            }
+            else if (ret < 0)
+            {
+                hi = mid;
+            }
+            else
+            {
+                lo = mid + 1;
+            }
+        }
+    }
+    else
+    {
+        /* Fall back to a linear search. */
+        option_proxy item = { 0 };
+        item.context = context;
+        for (item.position = 0;
+             item.position < context->numOptions;
+             item.position++)
+        {
+            item.option = context_option(context, item.position);
+            if (cmp_key_option_proxy_long(&longName, &item) == 0)
+            {
+                found = item.option;
+                break;
+            }
+        }
+    }
+
+    /* Abbreviations are resolved only with the sorted index, never by
+     * scanning the option table.
+     */
+    if (   found == NULL
+        && abbreviations
+        && context->allowAbbreviations
+        && indexed
+        && context->longIndex.lengths != NULL)
+    {
+        size_t first;
+        size_t count = find_long_name_prefix(context, longName, &first);
+        if (count == 1)
+        {
+            found = context_option(context, context->longIndex.indices[first]);
+        }
+        else if (count > 1)
+        {
+            *candidates = &context->longIndex.indices[first];
+            *numCandidates = count;
+        }
+    }
+
+exit:
+    if (folded != buffer) { context_free(context, folded); }
+    return found;
+}
+
+
+/** find_option_short
+  *
+  *     Finds the option specification for a short option name (i.e., an
+  *     option of the form "-o").
+  *
+  * PARAMETERS:
+  *     IN context   : The dropt context.
+  *     IN shortName : The short option name to search for.
+  *
+  * RETURNS:
+  *     A pointer to the corresponding option specification or `NULL` if not
+  *       found.
+  */
+static const dropt_option*
+find_option_short(const dropt_context* context, dropt_char shortName)
+{
+    assert(context != NULL);
+    assert(shortName != DROPT_TEXT_LITERAL('\0'));
+    assert(context->ncmpstr != NULL);
+
+    if (context->shortTable.slots != NULL)
+    {
+        const short_name_table* table = &context->shortTable;
+#ifdef DROPT_USE_WCHAR
+        size_t slot;
+
+        if (context->ncmpstr == fold_strncmp) { shortName = fold_char(shortName); }
+
+        slot = short_name_hash(shortName, table->mask);
+        while (table->slots[slot].shortName != (dropt_uint32) shortName)
+        {
+            if (table->slots[slot].shortName == 0) { return NULL; }
+            slot = (slot + 1) & table->mask;
+        }
+        return context_option(context, table->slots[slot].option);
+#else
+        dropt_uint32 i = table->slots[(unsigned char) shortName];
+        return (i == EMPTY_HASH_SLOT) ? NULL : context_option(context, i);
+#endif
+    }
+
+    if (context->sortedByShort != NULL)
+    {
+        option_proxy* found = bsearch(&shortName, context->sortedByShort,
+                                      context->numOptions,
+                                      sizeof *(context->sortedByShort),
+                                      cmp_key_option_proxy_short);
+        return (found == NULL) ? NULL : found->option;
+    }
+
+    /* Fall back to a linear search. */
+    {
+        size_t i;
+        for (i = 0; i < context->numOptions; i++)
+        {
+            const dropt_option* option = context_option(context, i);
+            if (context->ncmpstr(&shortName, &option->short_name, 1) == 0)
+            {
+                return option;
+            }
+        }
+    }
+    return NULL;
+}
+
+
+/** find_inherited_option_long
+  *
+  *     Finds the option specification for a long option name in the
+  *     ancestors of a subcommand's context (see
+  *     `dropt_get_subcommand_context`), nearest first.
+  *
+  * PARAMETERS:
+  *     IN context  : The dropt context.
+  *     IN longName : The long option name to search for (excluding leading
+  *                     dashes).
+  *                   `longName.s` must not be `NULL`.
+  *     IN abbreviations : Whether to resolve `longName` as an abbreviation
+  *                          in ancestors that allow abbreviations.
+  *
+  * RETURNS:
+  *     A pointer to the corresponding option specification or `NULL` if not
+  *       found.
+  */
+static const dropt_option*
+find_inherited_option_long(const dropt_context* context, char_array longName,
+                           bool abbreviations)
+{
+    const dropt_context* ancestor;
+
+    assert(context != NULL);
+
+    for (ancestor = context->parent; ancestor != NULL; ancestor = ancestor->parent)
+    {
+        const dropt_uint32* candidates;
+        size_t numCandidates;
+        const dropt_option* option = find_option_long(ancestor, longName,
+                                                      abbreviations,
+                                                      &candidates,
+                                                      &numCandidates);
+        if (option != NULL) { return option; }
+    }
+    return NULL;
+}
+
+
+/** find_inherited_option_short
+  *
+  *     Finds the option specification for a short option name in the
+  *     ancestors of a subcommand's context, nearest first.
+  *
+  * PARAMETERS:
+  *     IN context   : The dropt context.
+  *     IN shortName : The short option name to search for.
+  *
+  * RETURNS:
+  *     A pointer to the corresponding option specification or `NULL` if not
+  *       found.
+  */
+static const dropt_option*
+find_inherited_option_short(const dropt_context* context, dropt_char shortName)
+{
+    const dropt_context* ancestor;
+
+    assert(context != NULL);
+
+    for (ancestor = context->parent; ancestor != NULL; ancestor = ancestor->parent)
+    {
+        const dropt_option* option = find_option_short(ancestor, shortName);
+        if (option != NULL) { return option; }
+    }
+    return NULL;
+}
+
+
+/** init_edit_pattern
+  *
+  * PARAMETERS:
+  *     OUT pattern : The pattern to initialize.
+  *                   Must not be `NULL`.
+  *     IN s        : The pattern string.  Might not be `NUL`-terminated.
+  *                   Must be no longer than the number of bits in
+  *                     `edit_bits`.
+  *     IN fold     : Whether to compare characters case-insensitively.
+  */
+static void
+init_edit_pattern(edit_pattern* pattern, char_array s, bool fold)
+{
+    size_t i;
+
+    assert(pattern != NULL);
+    assert(s.len <= sizeof (edit_bits) * CHAR_BIT);
+
+    memset(pattern->masks, 0, sizeof pattern->masks);
+    for (i = 0; i < s.len; i++)
+    {
+        dropt_uint32 code = char_label(fold ? fold_char(s.s[i]) : s.s[i]);
+        if (code <= UCHAR_MAX)
+        {
+            pattern->masks[code] |= (edit_bits) 1 << i;
+        }
+    }
+
+    pattern->len = s.len;
+#ifdef DROPT_USE_WCHAR
+    pattern->s = s.s;
+#endif
+    pattern->fold = fold;
+}
+
+
+/** edit_pattern_mask
+  *
+  * PARAMETERS:
+  *     IN pattern : The pattern.
+  *     IN c       : A character, already folded if the pattern folds
+  *                    characters.
+  *
+  * RETURNS:
+  *     The bit mask of the pattern's positions that hold `c`.
+  */
+static edit_bits
+edit_pattern_mask(const edit_pattern* pattern, dropt_char c)
+{
+    dropt_uint32 code = char_label(c);
+    edit_bits mask = 0;
+
+    if (code <= UCHAR_MAX) { return pattern->masks[code]; }
+
+#ifdef DROPT_USE_WCHAR
+    {
+        /* `fold_char` leaves characters beyond ASCII alone. */
+        size_t i;
+        for (i = 0; i < pattern->len; i++)
+        {
+            if (pattern->s[i] == c) { mask |= (edit_bits) 1 << i; }
+        }
+    }
+#endif
+
+    return mask;
+}
+
+
+/** edit_distance
+  *
+  *     Computes the Levenshtein distance between a pattern and a string with
+  *     Myers's bit-parallel algorithm, as formulated by Hyyro.  Each
+  *     character of the string costs a constant number of word operations
+  *     regardless of the length of the pattern.
+  *
+  * PARAMETERS:
+  *     IN pattern     : The pattern.
+  *                      Must not be empty.
+  *     IN s           : The string.
+  *     IN len         : The length of `s`.
+  *     IN maxDistance : Distances greater than this are not of interest.
+  *
+  * RETURNS:
+  *     The distance, or some value greater than `maxDistance` if the
+  *       distance exceeds it.
+  */
+static size_t
+edit_distance(const edit_pattern* pattern, const dropt_char* s, size_t len,
+              size_t maxDistance)
+{
+    edit_bits last;
+    edit_bits pv = ~(edit_bits) 0;
+    edit_bits mv = 0;
+    size_t score;
+    size_t i;
+
+    assert(pattern->len != 0);
+
+    /* The distance is at least the difference in lengths. */
+    if (   len + maxDistance < pattern->len
+        || pattern->len + maxDistance < len)
+    {
+        return maxDistance + 1;
+    }
+
+    last = (edit_bits) 1 << (pattern->len - 1);
+    score = pattern->len;
+
+    /* `pv` and `mv` hold the positive and negative vertical deltas of the
+     * current column of the dynamic programming matrix.
+     */
+    for (i = 0; i < len; i++)
+    {
+        dropt_char c = pattern->fold ? fold_char(s[i]) : s[i];
+        edit_bits eq = edit_pattern_mask(pattern, c);
+        edit_bits xv = eq | mv;
+        edit_bits xh = (((eq & pv) + pv) ^ pv) | eq;
+        edit_bits ph = mv | ~(xh | pv);
+        edit_bits mh = pv & xh;
+
+        if (ph & last)
+        {
+            score++;
+        }
+        else if (mh & last)
+        {
+            score--;
+        }
+
+        /* The first row of the matrix always increases by one. */
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        /* Each remaining character can lower the distance by at most one. */
+        if (score > maxDistance + (len - i - 1)) { return maxDistance + 1; }
+    }
+
+    return score;
+}
+
+
+/** suggest_long_names
+  *
+  *     Finds the long option names closest to a mistyped one and stores them
+  *     in the context's `suggestions`, closest first.  Hidden options are
+  *     never suggested.
+  *
+  *     The names are filtered by length before their edit distances are
+  *     computed, and computing a distance stops as soon as it's too large,
+  *     so most names cost only a few operations.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN longName    : The mistyped long option name (excluding leading
+  *                        dashes).
+  *
+  * RETURNS:
+  *     The number of suggestions.
+  */
+static size_t
+suggest_long_names(dropt_context* context, char_array longName)
+{
+    const long_name_index* index;
+    edit_pattern pattern;
+    size_t distances[max_suggestions];
+    size_t numSuggestions = 0;
+    size_t maxDistance;
+    size_t n;
+    size_t i;
+
+    assert(context != NULL);
+    assert(context->maxSuggestions <= max_suggestions);
+
+    if (   context->maxSuggestions == 0
+        || longName.len == 0
+        || longName.len > sizeof (edit_bits) * CHAR_BIT)
+    {
+        return 0;
+    }
+
+    /* Allow about one edit for every three characters. */
+    maxDistance = MIN(max_suggestion_distance, (longName.len + 2) / 3);
+    init_edit_pattern(&pattern, longName, context->ncmpstr == fold_strncmp);
+
+    index = &context->longIndex;
+    n = (index->lengths != NULL) ? index->count : context->numOptions;
+    for (i = 0; i < n; i++)
+    {
+        const dropt_option* option;
+        const dropt_char* name;
+        size_t position;
+        size_t len;
+        size_t distance;
+        size_t j;
+
+        if (index->lengths != NULL)
+        {
+            position = index->indices[i];
+            option = context_option(context, position);
+            len = index->lengths[i];
+
+            /* Short names can be read from the index without touching the
+             * option table.
+             */
+            name = (len <= long_name_prefix_length)
+                   ? &index->prefixes[i * long_name_prefix_length]
+                   : long_name_key(context, position);
+        }
+        else
+        {
+            position = i;
+            option = context_option(context, position);
+            if (option->long_name == NULL) { continue; }
+            name = long_name_key(context, position);
+            len = dropt_strlen(name);
+        }
+
+        distance = edit_distance(&pattern, name, len, maxDistance);
+        if (distance > maxDistance || (option->attr & dropt_attr_hidden))
+        {
+            continue;
+        }
+
+        /* Keep the suggestions sorted by distance.  Names at equal
+         * distances stay in the order that they were found.
+         */
+        j = numSuggestions;
+        while (j > 0 && distances[j - 1] > distance) { j--; }
+        if (j >= context->maxSuggestions) { continue; }
+
+        if (numSuggestions < context->maxSuggestions) { numSuggestions++; }
+        memmove(&distances[j + 1], &distances[j],
+                (numSuggestions - 1 - j) * sizeof *distances);
+        memmove(&context->suggestions[j + 1], &context->suggestions[j],
+                (numSuggestions - 1 - j) * sizeof *(context->suggestions));
+        distances[j] = distance;
+        context->suggestions[j] = (dropt_uint32) position;
+
+        /* Once we have enough suggestions, only closer names matter. */
+        if (numSuggestions == context->maxSuggestions)
+        {
+            maxDistance = distances[numSuggestions - 1];
+        }
+    }
+
+    return numSuggestions;
+}
+
+
+/** clear_error_details
+  *
+  *     Clears the error details in the dropt context.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  */
+static void
+clear_error_details(dropt_context* context)
+{
+    assert(context != NULL);
+
+    context->errorDetails.err = dropt_error_none;
+
+    context_free(context, context->errorDetails.optionName);
+    context->errorDetails.optionName = NULL;
+
+    context_free(context, context->errorDetails.optionArgument);
+    context->errorDetails.optionArgument = NULL;
+
+    dropt_free(context->errorDetails.message);
+    context->errorDetails.message = NULL;
+
+    context->errorDetails.argv = NULL;
+    context->errorDetails.candidates = NULL;
+    context->errorDetails.numCandidates = 0;
+}
+
+
+/** set_error_details
+  *
+  *     Generates error details in the dropt context.
+  *
+  * PARAMETERS:
+  *     IN/OUT context    : The dropt context.
+  *                         Must not be `NULL`.
+  *     IN err            : The error code.
+  *     IN optionName     : The name of the option we failed on.
+  *                         `optionName.s` must not be `NULL`.
+  *     IN optionArgument : The value of the option we failed on.
+  *                         Pass `NULL` if unwanted.
+  */
+static void
+set_error_details(dropt_context* context, dropt_error err,
+                  char_array optionName,
+                  const dropt_char* optionArgument)
+{
+    assert(context != NULL);
+    assert(optionName.s != NULL);
+
+    context->errorDetails.err = err;
+    context->errorDetails.argv = NULL;
+    context->errorDetails.candidates = NULL;
+    context->errorDetails.numCandidates = 0;
+
+    context_free(context, context->errorDetails.optionName);
+    context_free(context, context->errorDetails.optionArgument);
+
+    context->errorDetails.optionName = context_strndup(context,
+                                                       optionName.s,
+                                                       optionName.len);
+    context->errorDetails.optionArgument
+        = (optionArgument == NULL)
+          ? NULL
+          : context_strndup(context, optionArgument, SIZE_MAX);
+
+    /* The message will be generated lazily on retrieval. */
+    dropt_free(context->errorDetails.message);
+    context->errorDetails.message = NULL;
+}
+
+
+/** set_short_option_error_details
+  *
+  *     Generates error details in the dropt context.
+  *
+  * PARAMETERS:
+  *     IN/OUT context    : The dropt context.
+  *     IN err            : The error code.
+  *     IN shortName      : the "short" name of the option we failed on.
+  *     IN optionArgument : The value of the option we failed on.
+  *                         Pass `NULL` if unwanted.
+  */
+static void
+set_short_option_error_details(dropt_context* context, dropt_error err,
+                               dropt_char shortName,
+                               const dropt_char* optionArgument)
+{
+    /* "-?" is just a placeholder. */
+    dropt_char shortNameBuf[] = DROPT_TEXT_LITERAL("-?");
+
+    assert(context != NULL);
+    assert(shortName != DROPT_TEXT_LITERAL('\0'));
+
+    shortNameBuf[1] = shortName;
+
+    set_error_details(context, err,
+                      make_char_array(shortNameBuf,
+                                      ARRAY_LENGTH(shortNameBuf) - 1),
+                      optionArgument);
+}
+
+
+/** set_parse_error
+  *
+  *     Records an error encountered while parsing an argument.  If error
+  *     details are deferred, only their location in the argument list is
+  *     recorded; otherwise, they are copied immediately.
+  *
+  * PARAMETERS:
+  *     IN/OUT context    : The dropt context.
+  *     IN ps             : The current parse state.
+  *     IN err            : The error code.
+  *     IN optionName     : The name of the option we failed on.
+  *                         Must point into the current argument.
+  *     IN isShortName    : Whether `optionName` is a single short option
+  *                           name.
+  *     IN optionArgument : The value of the option we failed on.
+  *                         Pass `NULL` if unwanted.
+  */
+static void
+set_parse_error(dropt_context* context, const parse_state* ps,
+                dropt_error err, char_array optionName, bool isShortName,
+                const dropt_char* optionArgument)
+{
+    const dropt_char* arg;
+    dropt_error_location* location;
+
+    assert(context != NULL);
+    assert(ps != NULL);
+    assert(optionName.s != NULL);
+
+    /* Error details can't be deferred without an argument list to refer
+     * to.
+     */
+    if (!context->deferErrorDetails || ps->argv == NULL)
+    {
+        if (isShortName)
+        {
+            set_short_option_error_details(context, err, optionName.s[0],
+                                           optionArgument);
+        }
+        else
+        {
+            set_error_details(context, err, optionName, optionArgument);
+        }
+        return;
+    }
+
+    clear_error_details(context);
+    context->errorDetails.err = err;
+    context->errorDetails.argv = ps->argv;
+    context->errorDetails.isShortName = isShortName;
+
+    arg = *ps->argCurrent;
+    location = &context->errorDetails.location;
+    location->option_index = ps->argCurrent - ps->argv;
+    location->option_offset = optionName.s - arg;
+    location->option_length = optionName.len;
+    location->has_argument = (optionArgument != NULL);
+    location->argument_index = 0;
+    location->argument_offset = 0;
+
+    if (optionArgument == NULL)
+    {
+        /* Nothing to do. */
+    }
+    else if (ps->argsLeft > 0 && optionArgument == *ps->argNext)
+    {
+        /* The argument was taken from the next item in the list. */
+        location->argument_index = ps->argNext - ps->argv;
+    }
+    else
+    {
+        location->argument_index = location->option_index;
+        location->argument_offset = optionArgument - arg;
+    }
+}
+
+
+/** materialize_error_details
+  *
+  *     Copies deferred error details out of the argument list that they
+  *     were recorded from.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  */
+static void
+materialize_error_details(dropt_context* context)
+{
+    dropt_char** argv = context->errorDetails.argv;
+    dropt_error_location location = context->errorDetails.location;
+    const dropt_uint32* candidates = context->errorDetails.candidates;
+    size_t numCandidates = context->errorDetails.numCandidates;
+    const dropt_char* arg;
+    const dropt_char* optionArgument;
+
+    if (argv == NULL || context->errorDetails.optionName != NULL) { return; }
+
+    arg = argv[location.option_index];
+    optionArgument = location.has_argument
+                     ? argv[location.argument_index] + location.argument_offset
+                     : NULL;
+
+    if (context->errorDetails.isShortName)
+    {
+        set_short_option_error_details(context, context->errorDetails.err,
+                                       arg[location.option_offset],
+                                       optionArgument);
+    }
+    else
+    {
+        set_error_details(context, context->errorDetails.err,
+                          make_char_array(arg + location.option_offset,
+                                          location.option_length),
+                          optionArgument);
+    }
+
+    /* Keep the location and the candidates available. */
+    context->errorDetails.argv = argv;
+    context->errorDetails.candidates = candidates;
+    context->errorDetails.numCandidates = numCandidates;
+}
+
+
+/** dropt_get_error
+  *
+  * PARAMETERS:
+  *     IN context : The dropt context.
+  *                  Must not be NULL.
+  *
+  * RETURNS:
+  *     The current error code waiting in the dropt context.
+  */
+dropt_error
+dropt_get_error(const dropt_context* context)
+{
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return dropt_error_bad_configuration;
+    }
+    return context->errorDetails.err;
+}
+
+
+/** dropt_get_error_details
+  *
+  *     Retrieves details about the current error.  If error details are
+  *     deferred (see `dropt_defer_error_details`), they are copied from the
+  *     parsed argument list, which must still be valid.
+  *
+  * PARAMETERS:
+  *     IN context         : The dropt context.
+  *     OUT optionName     : On output, the name of the option we failed
+  *                            on.  Do not free this string.
+  *                          Pass `NULL` if unwanted.
+  *     OUT optionArgument : On output, the value (possibly `NULL`) of the
+  *                            option we failed on.  Do not free this
+  *                            string.
+  *                          Pass `NULL` if unwanted.
+  */
+void
+dropt_get_error_details(const dropt_context* context,
+                        dropt_char** optionName, dropt_char** optionArgument)
+{
+    /* Deferred error details are a cache that's filled on demand.  Contexts
+     * are always allocated as non-`const` objects, so this is safe.
+     */
+    materialize_error_details((dropt_context*) context);
+
+    if (optionName != NULL)
+    {
+        *optionName = context->errorDetails.optionName;
+    }
+
+    if (optionArgument != NULL)
+    {
+        *optionArgument = context->errorDetails.optionArgument;
+    }
+}
+
+
+/** dropt_get_error_location
+  *
+  *     Retrieves the location of the current error in the parsed argument
+  *     list.  This is available only if error details are deferred (see
+  *     `dropt_defer_error_details`) and the error was caused by one of the
+  *     parsed arguments.
+  *
+  * PARAMETERS:
+  *     IN context    : The dropt context.
+  *                     Must not be `NULL`.
+  *     OUT location  : On output, the location of the error.
+  *                     Must not be `NULL`.
+  *
+  * RETURNS:
+  *     1 if the location is available, 0 otherwise.
+  */
+dropt_bool
+dropt_get_error_location(const dropt_context* context,
+                         dropt_error_location* location)
+{
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return 0;
+    }
+
+    if (location == NULL)
+    {
+        DROPT_MISUSE("No error location specified.");
+        return 0;
+    }
+
+    if (context->errorDetails.argv == NULL) { return 0; }
+
+    *location = context->errorDetails.location;
+    return 1;
+}
+
+
+/** dropt_get_error_candidates
+  *
+  *     Retrieves the options that the option name of the current error could
+  *     have referred to.  For `dropt_error_ambiguous_option` errors, these
+  *     are the options whose long names begin with the abbreviation, sorted
+  *     by name.  For `dropt_error_invalid_option` errors, these are the
+  *     suggested options, if suggestions are enabled (see
+  *     `dropt_enable_suggestions`).
+  *
+  *     The candidates remain available until the error is cleared or the
+  *     context's lookup settings are changed.
+  *
+  * PARAMETERS:
+  *     IN context        : The dropt context.
+  *                         Must not be `NULL`.
+  *     OUT candidates    : On output, pointers to up to `maxCandidates` of
+  *                           the candidate options.
+  *                         May be `NULL` if `maxCandidates` is 0.
+  *     IN maxCandidates  : The number of elements in `candidates`.
+  *
+  * RETURNS:
+  *     The total number of candidates, which might exceed `maxCandidates`.
+  */
+size_t
+dropt_get_error_candidates(const dropt_context* context,
+                           const dropt_option** candidates,
+                           size_t maxCandidates)
+{
+    size_t i;
+
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return 0;
+    }
+
+    if (candidates == NULL && maxCandidates != 0)
+    {
+        DROPT_MISUSE("No candidate buffer specified.");
+        return 0;
+    }
+
+    for (i = 0; i < MIN(maxCandidates, context->errorDetails.numCandidates); i++)
+    {
+        candidates[i] = context_option(context, context->errorDetails.candidates[i]);
+    }
+
+    return context->errorDetails.numCandidates;
+}
+
+
+/** dropt_get_error_message
+  *
+  * PARAMETERS:
+  *     IN context : The dropt context.
+  *                  Must not be `NULL`.
+  *
+  * RETURNS:
+  *     The current error message waiting in the dropt context or the empty
+  *       string if there are no errors.  Note that calling any dropt
+  *       function other than `dropt_get_error`, `dropt_get_error_details`, and
+  *       `dropt_get_error_message` may invalidate a previously-returned
+  *       string.
+  */
+const dropt_char*
+dropt_get_error_message(dropt_context* context)
+{
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return DROPT_TEXT_LITERAL("");
+    }
+
+    if (context->errorDetails.err == dropt_error_none)
+    {
+        return DROPT_TEXT_LITERAL("");
+    }
+
+    if (context->errorDetails.message == NULL)
+    {
+        materialize_error_details(context);
+
+        if (context->errorHandler != NULL)
+        {
+            context->errorDetails.message
+                = context->errorHandler(context->errorDetails.err,
+                                        context->errorDetails.optionName,
+                                        context->errorDetails.optionArgument,
+                                        context->errorHandlerData);
+        }
+        else
+        {
+#ifndef DROPT_NO_STRING_BUFFERS
+            context->errorDetails.message
+                = dropt_default_error_handler(context->errorDetails.err,
+                                              context->errorDetails.optionName,
+                                              context->errorDetails.optionArgument);
+#endif
+        }
+    }
+
+    return (context->errorDetails.message == NULL)
+           ? DROPT_TEXT_LITERAL("Unknown error")
+           : context->errorDetails.message;
+}
+
+
+/** dropt_clear_error
+  *
+  *     Clears the error waiting in the dropt context.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      May be `NULL`.
+  *                      Must not be frozen (see `dropt_freeze_context`).
+  */
+void
+dropt_clear_error(dropt_context* context)
+{
+    if (context == NULL) { return; }
+
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
+    }
+
+    clear_error_details(context);
+}
+
+
+#ifndef DROPT_NO_STRING_BUFFERS
+/** dropt_default_error_handler
+  *
+  *     Default error handler.
+  *
+  * PARAMETERS:
+  *     IN error          : The error code.
+  *     IN optionName     : The name of the option we failed on.
+  *     IN optionArgument : The value of the option we failed on.
+  *                         Pass `NULL` if unwanted.
+  *
+  * RETURNS:
+  *     An allocated string for the given error.  The caller is responsible for
+  *       calling `dropt_free()` on it when no longer needed.
+  *     May return `NULL`.
+  */
+dropt_char*
+dropt_default_error_handler(dropt_error error,
+                            const dropt_char* optionName,
+                            const dropt_char* optionArgument)
+{
+    dropt_char* s = NULL;
+
+    const dropt_char* separator = DROPT_TEXT_LITERAL(": ");
+
+    if (optionArgument == NULL)
+    {
+        separator = optionArgument = DROPT_TEXT_LITERAL("");
+    }
+
+    switch (error)
+    {
+        case dropt_error_none:
+            /* This shouldn't happen (unless client code invokes this directly
+             * with `dropt_error_none`), but it's here for completeness.
+             */
+            break;
+
+        case dropt_error_bad_configuration:
+            s = dropt_strdup(DROPT_TEXT_LITERAL("Invalid option configuration"));
+            break;
+
+        case dropt_error_invalid_option:
+            s = dropt_asprintf(DROPT_TEXT_LITERAL("Invalid option: %s"),
+                               optionName);
+            break;
+        case dropt_error_ambiguous_option:
+            s = dropt_asprintf(DROPT_TEXT_LITERAL("Ambiguous option: %s"),
+                               optionName);
+            break;
+        case dropt_error_insufficient_arguments:
+            s = dropt_asprintf(DROPT_TEXT_LITERAL("Value required after option %s"),
+                               optionName);
+            break;
+        case dropt_error_mismatch:
+            s = dropt_asprintf(DROPT_TEXT_LITERAL("Invalid value for option %s%s%s"),
+                               optionName, separator, optionArgument);
+            break;
+        case dropt_error_overflow:
+            s = dropt_asprintf(DROPT_TEXT_LITERAL("Value too large for option %s%s%s"),
+                               optionName, separator, optionArgument);
+            break;
+        case dropt_error_underflow:
+            s = dropt_asprintf(DROPT_TEXT_LITERAL("Value too small for option %s%s%s"),
+                               optionName, separator, optionArgument);
+            break;
+        case dropt_error_insufficient_memory:
+            s = dropt_strdup(DROPT_TEXT_LITERAL("Insufficient memory"));
+            break;
+        case dropt_error_response_file_depth:
+            s = dropt_asprintf(DROPT_TEXT_LITERAL("Response files nested too deeply: %s"),
+                               optionName);
+            break;
+        case dropt_error_unknown:
+        default:
+            s = dropt_asprintf(DROPT_TEXT_LITERAL("Unknown error handling option %s"),
+                               optionName);
+            break;
+    }
+
+    return s;
+}
+
+
+/** dropt_get_help
+  *
+  * PARAMETERS:
+  *     IN context    : The dropt context.
+  *                     Must not be `NULL`.
+  *     IN helpParams : The help parameters.
+  *                     Pass `NULL` to use the default help parameters.
+  *
+  * RETURNS:
+  *     An allocated help string for the available options.  The caller is
+  *       responsible for calling `dropt_free()` on it when no longer needed.
+  *     Returns `NULL` on error.
+  */
+dropt_char*
+dropt_get_help(const dropt_context* context,
+               const dropt_help_params* helpParams)
+{
+    dropt_char* helpText = NULL;
+    dropt_stringstream* ss = dropt_ssopen();
+
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+    }
+    else if (ss != NULL)
+    {
+        dropt_help_params hp;
+        size_t i;
+
+        if (helpParams == NULL)
+        {
+            dropt_init_help_params(&hp);
+        }
+        else
+        {
+            hp = *helpParams;
+        }
+
+        for (i = 0; i < context->numOptions; i++)
+        {
+            const dropt_option* option = context_option(context, i);
+            bool hasLongName =    option->long_name != NULL
+                               && option->long_name[0] != DROPT_TEXT_LITERAL('\0');
+            bool hasShortName = option->short_name != DROPT_TEXT_LITERAL('\0');
+
+            /* The number of characters printed on the current line so far. */
+            int n;
+
+            if (   option->description == NULL
+                || (option->attr & dropt_attr_hidden))
+            {
+                /* Undocumented option.  Ignore it and move on. */
+                continue;
+            }
+            else if (hasLongName && hasShortName)
+            {
+                n = dropt_ssprintf(ss, DROPT_TEXT_LITERAL("%*s-%c, --%s"),
+                                   hp.indent, DROPT_TEXT_LITERAL(""),
+                                   option->short_name, option->long_name);
+            }
+            else if (hasLongName)
+            {
+                n = dropt_ssprintf(ss, DROPT_TEXT_LITERAL("%*s--%s"),
+                                   hp.indent, DROPT_TEXT_LITERAL(""),
+                                   option->long_name);
+            }
+            else if (hasShortName)
+            {
+                n = dropt_ssprintf(ss, DROPT_TEXT_LITERAL("%*s-%c"),
+                                   hp.indent, DROPT_TEXT_LITERAL(""),
+                                   option->short_name);
+            }
+            else
+            {
+                /* Comment text.  Don't bother with indentation. */
+                assert(option->description != NULL);
+                dropt_ssprintf(ss, DROPT_TEXT_LITERAL("%s\n"), option->description);
+                goto next;
+            }
+
+            if (n < 0) { n = 0; }
+
+            if (option->arg_description != NULL)
+            {
+                int m = dropt_ssprintf(ss,
+                                       (option->attr & dropt_attr_optional_val)
+                                       ? DROPT_TEXT_LITERAL("[=%s]")
+                                       : DROPT_TEXT_LITERAL("=%s"),
+                                       option->arg_description);
+                if (m > 0) { n += m; }
+            }
+
+            /* Check for equality to make sure that there's at least one
+             * space between the option name and its description.
+             */
+            if ((unsigned int) n >= hp.description_start_column)
+            {
+                dropt_ssprintf(ss, DROPT_TEXT_LITERAL("\n"));
+                n = 0;
+            }
+
+            {
+                const dropt_char* line = option->description;
+                while (line != NULL)
+                {
+                    int lineLen;
+                    const dropt_char* nextLine;
+                    const dropt_char* newline = dropt_strchr(line, DROPT_TEXT_LITERAL('\n'));
+
+                    if (newline == NULL)
+                    {
+                        lineLen = dropt_strlen(line);
+                        nextLine = NULL;
+                    }
+                    else
+                    {
+                        lineLen = newline - line;
+                        nextLine = newline + 1;
+                    }
+
+                    dropt_ssprintf(ss, DROPT_TEXT_LITERAL("%*s%.*s\n"),
+                                   hp.description_start_column - n, DROPT_TEXT_LITERAL(""),
+                                   lineLen, line);
+                    n = 0;
+
+                    line = nextLine;
+                }
+            }
+
+        next:
+            if (hp.blank_lines_between_options)
+            {
+                dropt_ssprintf(ss, DROPT_TEXT_LITERAL("\n"));
+            }
+        }
+        helpText = dropt_ssfinalize(ss);
+    }
+
+    return helpText;
+}
+
+
+/** dropt_print_help
+  *
+  *     Prints help for the available options.
+  *
+  * PARAMETERS:
+  *     IN/OUT f      : The file stream to print to.
+  *     IN context    : The dropt context.
+  *                     Must not be `NULL`.
+  *     IN helpParams : The help parameters.
+  *                     Pass `NULL` to use the default help parameters.
+  */
+void
+dropt_print_help(FILE* f, const dropt_context* context,
+                 const dropt_help_params* helpParams)
+{
+    dropt_char* helpText = dropt_get_help(context, helpParams);
+    if (helpText != NULL)
+    {
+        dropt_fputs(helpText, f);
+        dropt_free(helpText);
+    }
+}
+#endif /* DROPT_NO_STRING_BUFFERS */
+
+
+/** tape_option_index
+  *
+  *     Numbers an option for a result tape (see `dropt_tape_entry`).
+  *     Options inherited from a parent context are numbered after the
+  *     context's own.
+  *
+  * PARAMETERS:
+  *     IN context : The dropt context.
+  *     IN option  : The option.  Must belong to the context or to one of
+  *                    its ancestors.
+  *
+  * RETURNS:
+  *     The option's index.
+  */
+static size_t
+tape_option_index(const dropt_context* context, const dropt_option* option)
+{
+    size_t base = 0;
+    size_t position;
+
+    assert(context != NULL);
+    assert(option != NULL);
+
+    while ((position = option_position(context, option)) == NO_OPTION_POSITION)
+    {
+        base += context->numOptions;
+        context = context->parent;
+        assert(context != NULL);
+    }
+
+    return base + position;
+}
+
+
+/** set_option_value
+  *
+  *     Sets the value for a specified option by invoking the option's
+  *     handler callback.
+  *
+  * PARAMETERS:
+  *     IN/OUT context    : The dropt context.
+  *     IN option         : The option.
+  *     IN optionArgument : The option's value.  May be `NULL`.
+  *
+  * RETURNS:
+  *     An error code.
+  */
+static dropt_error
+set_option_value(dropt_context* context,
+                 const dropt_option* option, const dropt_char* optionArgument)
+{
+    assert(option != NULL);
+
+    if (context->tape != NULL)
+    {
+        dropt_tape_entry* entry;
+
+        if (context->tapeLength == context->tapeCapacity)
+        {
+            return dropt_error_insufficient_memory;
+        }
+
+        entry = &context->tape[context->tapeLength++];
+        entry->option_index = tape_option_index(context, option);
+        entry->argument = optionArgument;
+        entry->argument_length = (optionArgument == NULL)
+                                 ? 0
+                                 : dropt_strlen(optionArgument);
+        return dropt_error_none;
+    }
+
+    if (option->handler == NULL)
+    {
+        DROPT_MISUSE("No option handler specified.");
+        return dropt_error_bad_configuration;
+    }
+
+    return option->handler(context, option, optionArgument,
+                           option->dest);
+}
+
+
+/** parse_option_arg
+  *
+  *     Helper function to `parse_long_option` and `parse_short_option` to
+  *     deal with consuming possibly optional arguments.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *     IN/OUT ps      : The current parse state.
+  *
+  * RETURNS:
+  *     An error code.
+  */
+static dropt_error
+parse_option_arg(dropt_context* context, parse_state* ps)
+{
+    dropt_error err;
+
+    bool consumeNextArg = false;
+
+    if (OPTION_TAKES_ARG(ps->option) && ps->optionArgument == NULL)
+    {
+        /* The option expects an argument, but none was specified with '='.
+         * Try using the next item from the command-line.
+         */
+        /* Without a handler to reject it, an optional argument can't be
+         * told apart from the next positional argument, so when recording
+         * to a tape, optional arguments must be specified with '='.
+         */
+        dropt_char* nextArg = peek_argument(ps);
+        bool mayTakeNextArg = !(   context->tape != NULL
+                                && (ps->option->attr & dropt_attr_optional_val));
+        if (nextArg == NULL && mayTakeNextArg && ps->moreInput)
+        {
+            /* Wait for the next chunk. */
+            ps->awaitingArgument = true;
+            return dropt_error_none;
+        }
+        else if (nextArg != NULL && mayTakeNextArg)
+        {
+            consumeNextArg = true;
+            ps->optionArgument = nextArg;
+        }
+        else if (!(ps->option->attr & dropt_attr_optional_val))
+        {
+            err = dropt_error_insufficient_arguments;
+            goto exit;
+        }
+    }
+
+    /* Even for options that don't ask for arguments, always parse and
+     * consume an argument that was specified with '='.
+     */
+    err = set_option_value(context, ps->option, ps->optionArgument);
+
+    if (   err != dropt_error_none
+        && (ps->option->attr & dropt_attr_optional_val)
+        && consumeNextArg
+        && ps->optionArgument != NULL)
+    {
+        /* The option's handler didn't like the argument we fed it.  If the
+         * argument was optional, try again without it.
+         */
+        consumeNextArg = false;
+        ps->optionArgument = NULL;
+        err = set_option_value(context, ps->option, NULL);
+    }
+
+exit:
+    if (err == dropt_error_none && consumeNextArg)
+    {
+        consume_argument(ps);
+    }
+    return err;
+}
+
+
+/** parse_long_option
+  *
+  *     Helper function to `dropt_parse` to deal with consuming a long option.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *     IN/OUT ps      : The current parse state.
+  *     IN arg         : The command-line argument with the long option.
+  *                      (Examples: "--longName", "--longName=ARGUMENT")
+  *
+  * RETURNS:
+  *     true if parsing should continue, false if it should halt.
+  */
+static bool
+parse_long_option(dropt_context* context, parse_state* ps,
+                  const dropt_char* arg)
+{
+    bool continueParsing = false;
+
+    dropt_error err = dropt_error_none;
+
+    const dropt_char* longName = arg + 2;
+    const dropt_char* longNameEnd;
+    char_array name;
+    const dropt_uint32* candidates;
+    size_t numCandidates;
+    if (longName[0] == DROPT_TEXT_LITERAL('\0'))
+    {
+        /* -- */
+
+        /* This is used to mark the end of the option processing
+         * to prevent some arguments with leading '-' characters
+         * from being treated as options.
+         *
+         * Don't pass this back to the caller.
+         */
+        goto exit;
+    }
+
+    /* --longName */
+    longNameEnd = dropt_strchr(longName, DROPT_TEXT_LITERAL('='));
+    if (longNameEnd == longName)
+    {
+        /* Deal with the pathological case of a user supplying
+         * "--=".
+         */
+        err = dropt_error_invalid_option;
+        set_parse_error(context, ps, err,
+                        make_char_array(arg, dropt_strlen(arg)), false,
+                        NULL);
+        goto exit;
+    }
+    else if (longNameEnd == NULL)
+    {
+        longNameEnd = longName + dropt_strlen(longName);
+        assert(ps->optionArgument == NULL);
+    }
+    else
+    {
+        /* --longName=ARGUMENT */
+        ps->optionArgument = longNameEnd + 1;
+    }
+
+    /* Pass the length of the option name so that we don't need
+     * to mutate the original string by inserting a
+     * `NUL`-terminator.
+     */
+    name = make_char_array(longName, longNameEnd - longName);
+    if (context->parent == NULL)
+    {
+        ps->option = find_option_long(context, name, true,
+                                      &candidates, &numCandidates);
+    }
+    else
+    {
+        /* An exact match in an ancestor takes precedence over an
+         * abbreviation in the subcommand.
+         */
+        ps->option = find_option_long(context, name, false,
+                                      &candidates, &numCandidates);
+        if (ps->option == NULL)
+        {
+            ps->option = find_inherited_option_long(context, name, false);
+        }
+        if (ps->option == NULL)
+        {
+            ps->option = find_option_long(context, name, true,
+                                          &candidates, &numCandidates);
+        }
+        if (ps->option == NULL)
+        {
+            ps->option = find_inherited_option_long(context, name, true);
+        }
+    }
+
+    if (ps->option == NULL)
+    {
+        if (numCandidates > 1)
+        {
+            err = dropt_error_ambiguous_option;
+        }
+        else
+        {
+            err = dropt_error_invalid_option;
+            numCandidates = suggest_long_names(context, name);
+            candidates = context->suggestions;
+        }
+        set_parse_error(context, ps, err,
+                        make_char_array(arg, longNameEnd - arg), false,
+                        NULL);
+        context->errorDetails.candidates = candidates;
+        context->errorDetails.numCandidates = numCandidates;
+    }
+    else
+    {
+        err = parse_option_arg(context, ps);
+        if (err != dropt_error_none)
+        {
+            set_parse_error(context, ps, err,
+                            make_char_array(arg, longNameEnd - arg), false,
+                            ps->optionArgument);
+        }
+    }
+
+    if (   err != dropt_error_none
+        || (ps->option->attr & dropt_attr_halt))
+    {
+        goto exit;
+    }
+
+    continueParsing = true;
+
+exit:
+    return continueParsing;
+}
+
+
+/** parse_short_option
+  *
+  *     Helper function to `dropt_parse` to deal with consuming one or more
+  *     short options.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *     IN/OUT ps      : The current parse state.
+  *     IN arg         : The command-line argument with one or more short
+  *                        options.
+  *                      (Examples: "-a", "-abc", "-oARGUMENT", "-o=ARGUMENT")
+  *
+  * RETURNS:
+  *     true if parsing should continue, false if it should halt.
+  */
+static bool
+parse_short_option(dropt_context* context, parse_state* ps,
+                   const dropt_char* arg)
+{
+    bool continueParsing = false;
+
+    dropt_error err = dropt_error_none;
+
+    size_t len;
+    size_t j;
+
+    const dropt_char* shortOptionGroup = arg + 1;
+    const dropt_char* shortOptionGroupEnd
+        = dropt_strchr(shortOptionGroup, DROPT_TEXT_LITERAL('='));
+
+    if (shortOptionGroupEnd == shortOptionGroup)
+    {
+        /* Deal with the pathological case of a user supplying
+         * "-=".
+         */
+        err = dropt_error_invalid_option;
+        set_parse_error(context, ps, err,
+                        make_char_array(arg, dropt_strlen(arg)), false,
+                        NULL);
+        goto exit;
+    }
+    else if (shortOptionGroupEnd != NULL)
+    {
+        /* -x=ARGUMENT */
+        len = shortOptionGroupEnd - shortOptionGroup;
+        ps->optionArgument = shortOptionGroupEnd + 1;
+    }
+    else
+    {
+        len = dropt_strlen(shortOptionGroup);
+        assert(ps->optionArgument == NULL);
+    }
+
+    for (j = 0; j < len; j++)
+    {
+        ps->option = find_option_short(context, shortOptionGroup[j]);
+        if (ps->option == NULL && context->parent != NULL)
+        {
+            ps->option = find_inherited_option_short(context,
+                                                     shortOptionGroup[j]);
+        }
+
+        if (ps->option == NULL)
+        {
+            err = dropt_error_invalid_option;
+            set_parse_error(context, ps, err,
+                            make_char_array(&shortOptionGroup[j], 1),
+                            true, NULL);
+            goto exit;
+        }
+        else if (j + 1 == len)
+        {
+            /* The last short option in a condensed list gets
+             * to use an argument.
+             */
+            err = parse_option_arg(context, ps);
+            if (err != dropt_error_none)
+            {
+                set_parse_error(context, ps, err,
+                                make_char_array(&shortOptionGroup[j], 1),
+                                true, ps->optionArgument);
+                goto exit;
+            }
+        }
+        else if (   context->allowConcatenatedArgs
+                 && OPTION_TAKES_ARG(ps->option)
+                 && j == 0)
+        {
+            err = set_option_value(context, ps->option,
+                                   &shortOptionGroup[j + 1]);
+
+            if (   err != dropt_error_none
+                && (ps->option->attr & dropt_attr_optional_val))
+            {
+                err = set_option_value(context, ps->option, NULL);
+            }
+
+            if (err != dropt_error_none)
+            {
+                set_parse_error(context, ps, err,
+                                make_char_array(&shortOptionGroup[j], 1),
+                                true, &shortOptionGroup[j + 1]);
+                goto exit;
+            }
+
+            /* Skip to the next argument. */
+            break;
+        }
+        else if (   OPTION_TAKES_ARG(ps->option)
+                 && !(ps->option->attr & dropt_attr_optional_val))
+        {
+            /* Short options with required arguments can't be used
+             * in condensed lists except in the last position.
+             *
+             * e.g. -abcd ARGUMENT
+             *          ^
+             */
+            err = dropt_error_insufficient_arguments;
+            set_parse_error(context, ps, err,
+                            make_char_array(&shortOptionGroup[j], 1),
+                            true, NULL);
+            goto exit;
+        }
+        else
+        {
+            err = set_option_value(context, ps->option, NULL);
+            if (err != dropt_error_none)
+            {
+                set_parse_error(context, ps, err,
+                                make_char_array(&shortOptionGroup[j], 1),
+                                true, NULL);
+                goto exit;
+            }
+        }
+
+        if (ps->option->attr & dropt_attr_halt) { goto exit; }
+    }
+
+    assert(err == dropt_error_none);
+    continueParsing = true;
+
+exit:
+    return continueParsing;
+}
+
+
+/** parse_loop
+  *
+  *     Parses options until reaching a non-option argument, an error, an
+  *     option that halts parsing, or the end of the arguments.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN/OUT ps      : The initial parse state.  On output, the state after
+  *                        the last processed argument.
+  *
+  * RETURNS:
+  *     `true` if option processing stopped before the end of the arguments,
+  *       `false` otherwise.
+  */
+static bool
+parse_loop(dropt_context* context, parse_state* ps)
+{
+    dropt_char* arg;
+
+    while ((arg = peek_argument(ps)) != NULL)
+    {
+        if (   arg[0] != DROPT_TEXT_LITERAL('-')
+            || arg[1] == DROPT_TEXT_LITERAL('\0'))
+        {
+            /* A non-option argument or "-".
+             *
+             * This intentionally leaves "-" unprocessed for the caller to
+             * deal with.  This allows construction of programs that treat
+             * "-" to mean `stdin`.
+             */
+            return true;
+        }
+
+        ps->argCurrent = ps->argNext;
+        consume_argument(ps);
+
+        if (arg[1] == DROPT_TEXT_LITERAL('-'))
+        {
+            if (!parse_long_option(context, ps, arg)) { return true; }
+        }
+        else
+        {
+            /* Short name. (-x) */
+            if (!parse_short_option(context, ps, arg)) { return true; }
+        }
+
+        if (ps->awaitingArgument) { return false; }
+
+        ps->option = NULL;
+        ps->optionArgument = NULL;
+    }
+
+    return false;
+}
+
+
+/** parse_arguments
+  *
+  *     Parses command-line options with a dropt context whose lookup tables
+  *     have already been initialized.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN argc        : The maximum number of arguments to parse from argv.
+  *                      Pass -1 to parse all arguments up to a `NULL` sentinel
+  *                        value.
+  *     IN argv        : The list of command-line arguments, not including the
+  *                        initial program name.
+  *                      Must not be `NULL`.
+  *
+  * RETURNS:
+  *     A pointer to the first unprocessed element in `argv`.
+  */
+static dropt_char**
+parse_arguments(dropt_context* context, int argc, dropt_char** argv)
+{
+    parse_state ps;
+
+    assert(context != NULL);
+    assert(argv != NULL);
+
+    ps.option = NULL;
+    ps.optionArgument = NULL;
+    ps.source = NULL;
+    ps.argv = argv;
+    ps.argCurrent = argv;
+    ps.argNext = argv;
+    ps.moreInput = false;
+    ps.awaitingArgument = false;
+
+    /* There's no need to count the arguments; the `NULL` sentinel stops
+     * parsing anyway.
+     */
+    ps.argsLeft = (argc == -1) ? INT_MAX : argc;
+
+    parse_loop(context, &ps);
+    return ps.argNext;
+}
+
+
+/** check_parse_configuration
+  *
+  *     Verifies that a dropt context is usable for parsing.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *
+  * RETURNS:
+  *     `true` if the context may be used for parsing, `false` otherwise.
+  *     If the context is non-`NULL` and isn't frozen, sets its error details
+  *       on failure.
+  */
+static bool
+check_parse_configuration(dropt_context* context)
+{
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return false;
+    }
+
+    /* Parsing writes to the context, and frozen contexts may be shared
+     * across threads.
+     */
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return false;
+    }
+
+#ifdef DROPT_NO_STRING_BUFFERS
+    if (context->errorHandler == NULL)
+    {
+        DROPT_MISUSE("No error handler specified.");
+        set_error_details(context, dropt_error_bad_configuration,
+                          make_char_array(DROPT_TEXT_LITERAL(""), 0),
+                          NULL);
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+
+/** is_split_space
+  *
+  * PARAMETERS:
+  *     IN c : A character from a string being split into arguments.
+  *
+  * RETURNS:
+  *     `true` if `c` separates arguments, `false` otherwise.
+  */
+static bool
+is_split_space(dropt_char c)
+{
+    return    c == DROPT_TEXT_LITERAL(' ')
+           || (c >= DROPT_TEXT_LITERAL('\t') && c <= DROPT_TEXT_LITERAL('\r'));
+}
+
+
+/** is_split_special
+  *
+  * PARAMETERS:
+  *     IN c : A character from a string being split into arguments.
+  *
+  * RETURNS:
+  *     `true` if `c` is whitespace, a quote, or a backslash, `false`
+  *       otherwise.
+  */
+static bool
+is_split_special(dropt_char c)
+{
+    return    is_split_space(c)
+           || c == DROPT_TEXT_LITERAL('\'')
+           || c == DROPT_TEXT_LITERAL('"')
+           || c == DROPT_TEXT_LITERAL('\\');
+}
+
+
+#if defined DROPT_SPLIT_SSE2 || defined DROPT_SPLIT_AVX2 || defined DROPT_SPLIT_NEON
+/** count_trailing_zeros
+  *
+  * PARAMETERS:
+  *     IN x : A non-zero value.
+  *
+  * RETURNS:
+  *     The number of trailing 0 bits in `x`.
+  */
+static unsigned int
+count_trailing_zeros(dropt_uint32 x)
+{
+    assert(x != 0);
+#if defined __GNUC__ || defined __clang__
+    return (unsigned int) __builtin_ctz(x);
+#elif defined _MSC_VER
+    {
+        unsigned long index;
+        _BitScanForward(&index, x);
+        return (unsigned int) index;
+    }
+#else
+    {
+        unsigned int n = 0;
+        while ((x & 1) == 0) { x >>= 1; n++; }
+        return n;
+    }
+#endif
+}
+#endif
+
+
+/** plain_run_length
+  *
+  *     Finds the length of the run of characters that aren't special to
+  *     any quoting rules (see `is_split_special`).  Narrow builds scan
+  *     blocks of characters at a time with SIMD instructions where
+  *     available.
+  *
+  * PARAMETERS:
+  *     IN s   : The start of the run.
+  *     IN end : The end of the string.
+  *
+  * RETURNS:
+  *     The length of the run, in `dropt_char`s.
+  */
+static size_t
+plain_run_length(const dropt_char* s, const dropt_char* end)
+{
+    const dropt_char* p = s;
+
+#if defined DROPT_SPLIT_AVX2
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i singleQuote = _mm256_set1_epi8('\'');
+    const __m256i doubleQuote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i controlRange = _mm256_set1_epi8('\r' - '\t');
+
+    while (end - p >= 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*) p);
+
+        /* '\t' through '\r' are whitespace. */
+        __m256i t = _mm256_sub_epi8(v, tab);
+        __m256i special
+            = _mm256_or_si256(
+                  _mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+                                  _mm256_cmpeq_epi8(v, singleQuote)),
+                  _mm256_or_si256(
+                      _mm256_or_si256(_mm256_cmpeq_epi8(v, doubleQuote),
+                                      _mm256_cmpeq_epi8(v, backslash)),
+                      _mm256_cmpeq_epi8(_mm256_min_epu8(t, controlRange),
+                                        t)));
+        dropt_uint32 mask = (dropt_uint32) _mm256_movemask_epi8(special);
+        if (mask != 0) { return (p - s) + count_trailing_zeros(mask); }
+        p += 32;
+    }
+#endif
+
+#if defined DROPT_SPLIT_SSE2
+    {
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i singleQuote = _mm_set1_epi8('\'');
+        const __m128i doubleQuote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i controlRange = _mm_set1_epi8('\r' - '\t');
+
+        while (end - p >= 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*) p);
+
+            /* '\t' through '\r' are whitespace. */
+            __m128i t = _mm_sub_epi8(v, tab);
+            __m128i special
+                = _mm_or_si128(
+                      _mm_or_si128(_mm_cmpeq_epi8(v, space),
+                                   _mm_cmpeq_epi8(v, singleQuote)),
+                      _mm_or_si128(
+                          _mm_or_si128(_mm_cmpeq_epi8(v, doubleQuote),
+                                       _mm_cmpeq_epi8(v, backslash)),
+                          _mm_cmpeq_epi8(_mm_min_epu8(t, controlRange), t)));
+            dropt_uint32 mask = (dropt_uint32) _mm_movemask_epi8(special);
+            if (mask != 0) { return (p - s) + count_trailing_zeros(mask); }
+            p += 16;
+        }
+    }
+#elif defined DROPT_SPLIT_NEON
+    {
+        const uint8x16_t space = vdupq_n_u8(' ');
+        const uint8x16_t singleQuote = vdupq_n_u8('\'');
+        const uint8x16_t doubleQuote = vdupq_n_u8('"');
+        const uint8x16_t backslash = vdupq_n_u8('\\');
+        const uint8x16_t tab = vdupq_n_u8('\t');
+        const uint8x16_t controlRange = vdupq_n_u8('\r' - '\t');
+
+        while (end - p >= 16)
+        {
+            uint8x16_t v = vld1q_u8((const unsigned char*) p);
+            uint8x16_t special
+                = vorrq_u8(vorrq_u8(vceqq_u8(v, space),
+                                    vceqq_u8(v, singleQuote)),
+                           vorrq_u8(vorrq_u8(vceqq_u8(v, doubleQuote),
+                                             vceqq_u8(v, backslash)),
+                                    vcleq_u8(vsubq_u8(v, tab), controlRange)));
+
+            /* Narrow each byte of the comparison to a nibble. */
+            uint64_t mask
+                = vget_lane_u64(vreinterpret_u64_u8(
+                                    vshrn_n_u16(vreinterpretq_u16_u8(special), 4)),
+                                0);
+            if (mask != 0)
+            {
+                dropt_uint32 low = (dropt_uint32) mask;
+                unsigned int bits
+                    = (low != 0)
+                      ? count_trailing_zeros(low)
+                      : 32 + count_trailing_zeros((dropt_uint32) (mask >> 32));
+                return (p - s) + bits / 4;
+            }
+            p += 16;
+        }
+    }
+#endif
+
+    while (p < end && !is_split_special(*p)) { p++; }
+    return p - s;
+}
+
+
+/** next_token
+  *
+  *     Extracts the next argument from a string and unquotes it.
+  *
+  *     `output` may point into the string itself as long as it doesn't
+  *     get ahead of `cursor`: unquoting never lengthens an argument, and
+  *     each argument's `NUL`-terminator takes the place of the character
+  *     that ends it, so the output never overwrites unread characters.
+  *
+  * PARAMETERS:
+  *     IN quoting    : The quoting rules.
+  *     IN/OUT cursor : The position in the string.  On output, the position
+  *                       after the extracted argument.
+  *     IN end        : The end of the string.
+  *     IN/OUT output : Where to write the argument.  On output, the position
+  *                       after the argument's `NUL`-terminator.
+  *
+  * RETURNS:
+  *     The extracted argument, or `NULL` if the end of the string was
+  *       reached.
+  */
+static dropt_char*
+next_token(dropt_quoting quoting, const dropt_char** cursor,
+           const dropt_char* end, dropt_char** output)
+{
+    const dropt_char* r = *cursor;
+    dropt_char* token = *output;
+    dropt_char* w = token;
+
+    /* The quote that we're within, if any. */
+    dropt_char quote = DROPT_TEXT_LITERAL('\0');
+
+    assert(quoting != dropt_quoting_none);
+
+    while (r < end && is_split_space(*r)) { r++; }
+    if (r == end)
+    {
+        *cursor = r;
+        return NULL;
+    }
+
+    while (r < end)
+    {
+        dropt_char c;
+        size_t n = plain_run_length(r, end);
+        if (n != 0)
+        {
+            if (w != r) { memmove(w, r, n * sizeof *w); }
+            w += n;
+            r += n;
+            if (r == end) { break; }
+        }
+
+        c = *r;
+        if (quote == DROPT_TEXT_LITERAL('\0') && is_split_space(c))
+        {
+            break;
+        }
+
+        r++;
+        if (quoting == dropt_quoting_msvc)
+        {
+            if (c == DROPT_TEXT_LITERAL('\\'))
+            {
+                /* 2n backslashes followed by a quote produce n backslashes
+                 * and a quotation mark; 2n + 1 backslashes followed by a
+                 * quote produce n backslashes and a literal quote.
+                 * Backslashes are otherwise literal.
+                 */
+                n = 1;
+                while (r < end && *r == DROPT_TEXT_LITERAL('\\')) { n++; r++; }
+
+                if (r < end && *r == DROPT_TEXT_LITERAL('"'))
+                {
+                    bool escaped = (n % 2 != 0);
+                    for (n /= 2; n > 0; n--) { *w++ = DROPT_TEXT_LITERAL('\\'); }
+                    if (escaped) { *w++ = *r++; }
+                }
+                else
+                {
+                    for (; n > 0; n--) { *w++ = DROPT_TEXT_LITERAL('\\'); }
+                }
+            }
+            else if (c == DROPT_TEXT_LITERAL('"'))
+            {
+                if (   quote != DROPT_TEXT_LITERAL('\0')
+                    && r < end && *r == DROPT_TEXT_LITERAL('"'))
+                {
+                    /* "" within quotes is a literal quote. */
+                    *w++ = *r++;
+                }
+                else
+                {
+                    quote = (quote == DROPT_TEXT_LITERAL('\0'))
+                            ? c
+                            : DROPT_TEXT_LITERAL('\0');
+                }
+            }
+            else
+            {
+                *w++ = c;
+            }
+        }
+        else if (c == DROPT_TEXT_LITERAL('\\'))
+        {
+            if (r == end)
+            {
+                /* A trailing backslash escapes nothing. */
+                if (quoting == dropt_quoting_posix) { *w++ = c; }
+            }
+            else if (quoting == dropt_quoting_gnu)
+            {
+                *w++ = *r++;
+            }
+            else if (quote == DROPT_TEXT_LITERAL('\''))
+            {
+                *w++ = c;
+            }
+            else if (*r == DROPT_TEXT_LITERAL('\n'))
+            {
+                /* A line continuation. */
+                r++;
+            }
+            else if (   quote == DROPT_TEXT_LITERAL('\0')
+                     || *r == DROPT_TEXT_LITERAL('$')
+                     || *r == DROPT_TEXT_LITERAL('`')
+                     || *r == DROPT_TEXT_LITERAL('"')
+                     || *r == DROPT_TEXT_LITERAL('\\'))
+            {
+                *w++ = *r++;
+            }
+            else
+            {
+                *w++ = c;
+            }
+        }
+        else if (c == DROPT_TEXT_LITERAL('\'') || c == DROPT_TEXT_LITERAL('"'))
+        {
+            if (quote == DROPT_TEXT_LITERAL('\0')) { quote = c; }
+            else if (quote == c) { quote = DROPT_TEXT_LITERAL('\0'); }
+            else { *w++ = c; }
+        }
+        else
+        {
+            *w++ = c;
+        }
+    }
+
+    *w++ = DROPT_TEXT_LITERAL('\0');
+    *cursor = (r < end) ? r + 1 : r;
+    *output = w;
+    return token;
+}
+
+
+/** read_response_file
+  *
+  *     Reads a response file into memory allocated with the context's
+  *     allocator.
+  *
+  * PARAMETERS:
+  *     IN context  : The dropt context.
+  *     IN path     : The path to the response file.
+  *     OUT buffer  : On output, the text of the response file.
+  *
+  * RETURNS:
+  *     `dropt_error_none` on success.
+  *     `dropt_error_insufficient_memory` on allocation failure.
+  *     `dropt_error_unknown` if the file couldn't be read.
+  */
+static dropt_error
+read_response_file(dropt_context* context, const dropt_char* path,
+                   response_buffer* buffer)
+{
+    dropt_error err = dropt_error_unknown;
+    FILE* fp = NULL;
+    char* bytes = NULL;
+    size_t length = 0;
+    size_t capacity = 0;
+#ifdef DROPT_USE_WCHAR
+    char* narrowPath = NULL;
+    size_t n;
+#endif
+
+    assert(buffer != NULL);
+
+#ifdef DROPT_USE_WCHAR
+    n = wcstombs(NULL, path, 0);
+    if (n == (size_t) -1) { goto exit; }
+
+    narrowPath = context_malloc(context, n + 1, 1);
+    if (narrowPath == NULL)
+    {
+        err = dropt_error_insufficient_memory;
+        goto exit;
+    }
+    wcstombs(narrowPath, path, n + 1);
+    fp = fopen(narrowPath, "rb");
+#else
+    fp = fopen(path, "rb");
+#endif
+    if (fp == NULL) { goto exit; }
+
+    for (;;)
+    {
+        size_t numRead;
+
+        /* Leave room for a `NUL`-terminator. */
+        if (capacity - length <= 1)
+        {
+            size_t newCapacity = (capacity == 0) ? 4096 : capacity * 2;
+            char* p;
+
+            if (newCapacity <= capacity)
+            {
+                err = dropt_error_insufficient_memory;
+                goto exit;
+            }
+
+            p = dropt_allocator_realloc(&context->allocator, bytes,
+                                        newCapacity, 1);
+            if (p == NULL)
+            {
+                err = dropt_error_insufficient_memory;
+                goto exit;
+            }
+            bytes = p;
+            capacity = newCapacity;
+        }
+
+        numRead = fread(bytes + length, 1, capacity - length - 1, fp);
+        length += numRead;
+        if (numRead == 0) { break; }
+    }
+
+    if (ferror(fp)) { goto exit; }
+    bytes[length] = '\0';
+
+#ifdef DROPT_USE_WCHAR
+    /* There's nothing to map in place, so convert the bytes. */
+    n = mbstowcs(NULL, bytes, 0);
+    if (n == (size_t) -1) { goto exit; }
+
+    buffer->text = context_malloc(context, n + 1, sizeof *buffer->text);
+    if (buffer->text == NULL)
+    {
+        err = dropt_error_insufficient_memory;
+        goto exit;
+    }
+    mbstowcs(buffer->text, bytes, n + 1);
+    buffer->length = n;
+#else
+    buffer->text = bytes;
+    buffer->length = length;
+    bytes = NULL;
+#endif
+
+    buffer->mapped = false;
+    buffer->mappedSize = 0;
+    err = dropt_error_none;
+
+exit:
+    if (fp != NULL) { fclose(fp); }
+    context_free(context, bytes);
+#ifdef DROPT_USE_WCHAR
+    context_free(context, narrowPath);
+#endif
+    return err;
+}
+
+
+/** load_response_file
+  *
+  *     Loads a response file into writable memory, mapping it if possible.
+  *
+  * PARAMETERS:
+  *     IN context  : The dropt context.
+  *     IN path     : The path to the response file.
+  *     OUT buffer  : On output, the text of the response file.
+  *
+  * RETURNS:
+  *     `dropt_error_none` on success.
+  *     `dropt_error_insufficient_memory` on allocation failure.
+  *     `dropt_error_unknown` if the file couldn't be read.
+  */
+static dropt_error
+load_response_file(dropt_context* context, const dropt_char* path,
+                   response_buffer* buffer)
+{
+#ifdef DROPT_USE_MMAP
+    struct stat st;
+    long pageSize = sysconf(_SC_PAGESIZE);
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) { return dropt_error_unknown; }
+
+    /* Mapping is zero-copy: the pages are private, so tokenizing only
+     * copies the pages that it writes to.  The mapping must end in a
+     * partial page so that the zero-filled remainder can hold the last
+     * argument's `NUL`-terminator; otherwise, and for anything that isn't
+     * a regular file, fall back to reading the file.
+     */
+    if (   fstat(fd, &st) == 0
+        && S_ISREG(st.st_mode)
+        && st.st_size > 0
+        && pageSize > 0
+        && (unsigned long) st.st_size < (unsigned long) SIZE_MAX
+        && st.st_size % pageSize != 0)
+    {
+        size_t size = (size_t) st.st_size;
+        void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                       fd, 0);
+        if (p != MAP_FAILED)
+        {
+            close(fd);
+            buffer->text = p;
+            buffer->length = size;
+            buffer->mapped = true;
+            buffer->mappedSize = size;
+            return dropt_error_none;
+        }
+    }
+
+    close(fd);
+#endif
+
+    return read_response_file(context, path, buffer);
+}
+
+
+/** release_response_files
+  *
+  *     Releases the response files from the last expansion.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  */
+static void
+release_response_files(dropt_context* context)
+{
+    response_file_state* state = &context->responseFiles;
+    size_t i;
+
+    for (i = 0; i < state->numBuffers; i++)
+    {
+#ifdef DROPT_USE_MMAP
+        if (state->buffers[i].mapped)
+        {
+            munmap(state->buffers[i].text, state->buffers[i].mappedSize);
+            continue;
+        }
+#endif
+        context_free(context, state->buffers[i].text);
+    }
+
+    state->numBuffers = 0;
+    state->numArgs = 0;
+}
+
+
+/** free_response_files
+  *
+  *     Frees all memory used for response file expansion.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  */
+static void
+free_response_files(dropt_context* context)
+{
+    response_file_state* state = &context->responseFiles;
+
+    release_response_files(context);
+
+    context_free(context, state->args);
+    state->args = NULL;
+    state->argsCapacity = 0;
+
+    context_free(context, state->buffers);
+    state->buffers = NULL;
+    state->buffersCapacity = 0;
+}
+
+
+/** grow_array
+  *
+  *     Ensures that an array allocated with a context's allocator has room
+  *     for at least one more element.
+  *
+  * PARAMETERS:
+  *     IN context      : The dropt context.
+  *     IN/OUT array    : The array.
+  *     IN count        : The number of elements in use.
+  *     IN/OUT capacity : The number of elements allocated.
+  *     IN elementSize  : The size of each element, in bytes.
+  *
+  * RETURNS:
+  *     `true` on success, `false` on allocation failure.
+  */
+static bool
+grow_array(dropt_context* context, void** array, size_t count,
+           size_t* capacity, size_t elementSize)
+{
+    size_t newCapacity;
+    void* p;
+
+    if (count < *capacity) { return true; }
+
+    newCapacity = (*capacity == 0) ? 16 : *capacity * 2;
+    if (newCapacity <= *capacity) { return false; }
+
+    p = dropt_allocator_realloc(&context->allocator, *array,
+                                newCapacity, elementSize);
+    if (p == NULL) { return false; }
+
+    *array = p;
+    *capacity = newCapacity;
+    return true;
+}
+
+
+/** push_expanded_arg
+  *
+  *     Appends an argument to the expanded argument list.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *     IN arg         : The argument.
+  *
+  * RETURNS:
+  *     `dropt_error_none` on success, `dropt_error_insufficient_memory` on
+  *       failure.
+  */
+static dropt_error
+push_expanded_arg(dropt_context* context, dropt_char* arg)
+{
+    response_file_state* state = &context->responseFiles;
+    void* args = state->args;
+
+    if (!grow_array(context, &args, state->numArgs, &state->argsCapacity,
+                    sizeof *state->args))
+    {
+        return dropt_error_insufficient_memory;
+    }
+
+    state->args = args;
+    state->args[state->numArgs++] = arg;
+    return dropt_error_none;
+}
+
+
+/** expand_argument
+  *
+  *     Appends an argument to the expanded argument list, recursively
+  *     expanding it if it names a response file.  Arguments that name
+  *     unreadable files are kept as-is.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *     IN arg         : The argument.
+  *     IN depth       : The number of response files that `arg` is nested
+  *                        in.
+  *
+  * RETURNS:
+  *     An error code.  Sets the context's error details on failure.
+  */
+static dropt_error
+expand_argument(dropt_context* context, dropt_char* arg, unsigned int depth)
+{
+    response_file_state* state = &context->responseFiles;
+    response_buffer buffer;
+    const dropt_char* cursor;
+    const dropt_char* end;
+    dropt_char* output;
+    dropt_char* token;
+    void* buffers;
+    dropt_error err;
+
+    if (arg[0] != DROPT_TEXT_LITERAL('@'))
+    {
+        err = push_expanded_arg(context, arg);
+        goto exit;
+    }
+
+    if (depth >= state->maxDepth)
+    {
+        err = dropt_error_response_file_depth;
+        set_error_details(context, err,
+                          make_char_array(arg, dropt_strlen(arg)), NULL);
+        return err;
+    }
+
+    buffers = state->buffers;
+    if (!grow_array(context, &buffers, state->numBuffers,
+                    &state->buffersCapacity, sizeof *state->buffers))
+    {
+        err = dropt_error_insufficient_memory;
+        goto exit;
+    }
+    state->buffers = buffers;
+
+    err = load_response_file(context, arg + 1, &buffer);
+    if (err == dropt_error_unknown)
+    {
+        err = push_expanded_arg(context, arg);
+        goto exit;
+    }
+    else if (err != dropt_error_none)
+    {
+        goto exit;
+    }
+
+    /* Track the buffer before anything else can fail so that it will be
+     * released.
+     */
+    state->buffers[state->numBuffers++] = buffer;
+
+    /* Split the text in place. */
+    cursor = buffer.text;
+    end = buffer.text + buffer.length;
+    output = buffer.text;
+    while ((token = next_token(state->syntax, &cursor, end, &output)) != NULL)
+    {
+        err = expand_argument(context, token, depth + 1);
+        if (err != dropt_error_none) { return err; }
+    }
+
+exit:
+    if (err == dropt_error_insufficient_memory)
+    {
+        set_error_details(context, err,
+                          make_char_array(arg, dropt_strlen(arg)), NULL);
+    }
+    return err;
+}
+
+
+/** expand_response_files
+  *
+  *     Expands the response files in a list of command-line arguments (see
+  *     `dropt_enable_response_files`).
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN argc        : The maximum number of arguments to expand from argv.
+  *                      Pass -1 to expand all arguments up to a `NULL`
+  *                        sentinel value.
+  *     IN argv        : The list of command-line arguments.
+  *                      Must not be `NULL`.
+  *     OUT expanded   : On output, the `NULL`-terminated expanded list, or
+  *                        `argv` if there was nothing to expand.
+  *
+  * RETURNS:
+  *     `true` on success, `false` on failure.  Sets the context's error
+  *       details on failure.
+  */
+static bool
+expand_response_files(dropt_context* context, int argc, dropt_char** argv,
+                      dropt_char*** expanded)
+{
+    size_t n;
+    size_t i;
+
+    assert(context != NULL);
+    assert(argv != NULL);
+    assert(expanded != NULL);
+
+    release_response_files(context);
+    *expanded = argv;
+
+    for (n = 0; (argc == -1 || n < (size_t) argc) && argv[n] != NULL; n++)
+    {
+        /* Nothing to do. */
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        if (argv[i][0] == DROPT_TEXT_LITERAL('@')) { break; }
+    }
+
+    if (i == n) { return true; }
+
+    for (i = 0; i < n; i++)
+    {
+        if (expand_argument(context, argv[i], 0) != dropt_error_none)
+        {
+            return false;
+        }
+    }
+
+    if (push_expanded_arg(context, NULL) != dropt_error_none)
+    {
+        set_error_details(context, dropt_error_insufficient_memory,
+                          make_char_array(DROPT_TEXT_LITERAL(""), 0), NULL);
+        return false;
+    }
+
+    *expanded = context->responseFiles.args;
+    return true;
+}
+
+
+/** dropt_split_command_line
+  *
+  *     Splits a string into arguments, such as for `dropt_parse`.  The
+  *     arguments are unquoted and written consecutively to a single buffer.
+  *
+  * PARAMETERS:
+  *     IN commandLine : The string to split.
+  *                      Must not be `NULL`.
+  *     IN quoting     : The quoting rules.
+  *                      Must not be `dropt_quoting_none`.
+  *     OUT buffer     : The buffer for the arguments.  Must have room for
+  *                        `dropt_strlen(commandLine) + 1` `dropt_char`s.
+  *                      May be the same as `commandLine` to split the string
+  *                        in place.
+  *                      Must not be `NULL`.
+  *     OUT argv       : On output, the arguments, followed by a `NULL`
+  *                        sentinel.
+  *                      May be `NULL` if `maxArgs` is 0.
+  *     IN maxArgs     : The number of elements in `argv`, including the
+  *                        sentinel.  `dropt_strlen(commandLine) / 2 + 2` is
+  *                        always enough.
+  *
+  * RETURNS:
+  *     The number of arguments.  If that's `maxArgs` or more, `argv` holds
+  *       only the first `maxArgs - 1` of them.
+  */
+size_t
+dropt_split_command_line(const dropt_char* commandLine,
+                         dropt_quoting quoting,
+                         dropt_char* buffer,
+                         dropt_char** argv, size_t maxArgs)
+{
+    const dropt_char* cursor = commandLine;
+    const dropt_char* end;
+    dropt_char* output = buffer;
+    dropt_char* token;
+    size_t numArgs = 0;
+
+    if (commandLine == NULL || buffer == NULL)
+    {
+        DROPT_MISUSE("No command-line or buffer specified.");
+        return 0;
+    }
+
+    if (   quoting != dropt_quoting_gnu
+        && quoting != dropt_quoting_posix
+        && quoting != dropt_quoting_msvc)
+    {
+        DROPT_MISUSE("Invalid quoting rules.");
+        return 0;
+    }
+
+    if (argv == NULL && maxArgs != 0)
+    {
+        DROPT_MISUSE("No argument list specified.");
+        return 0;
+    }
+
+    end = commandLine + dropt_strlen(commandLine);
+    while ((token = next_token(quoting, &cursor, end, &output)) != NULL)
+    {
+        if (numArgs + 1 < maxArgs) { argv[numArgs] = token; }
+        numArgs++;
+    }
+
+    if (maxArgs != 0) { argv[MIN(numArgs, maxArgs - 1)] = NULL; }
+    return numArgs;
+}
+
+
+/** dropt_parse
+  *
+  *     Parses command-line options.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *                      Must not be frozen (see `dropt_freeze_context`).
+  *     IN argc        : The maximum number of arguments to parse from argv.
+  *                      Pass -1 to parse all arguments up to a `NULL` sentinel
+  *                        value.
+  *     IN argv        : The list of command-line arguments, not including the
+  *                        initial program name.
+  *
+  * RETURNS:
+  *     A pointer to the first unprocessed element in `argv`.  If response
+  *       files were expanded (see `dropt_enable_response_files`), this
+  *       instead points into the `NULL`-terminated expanded list, which
+  *       remains valid until the next call to `dropt_parse` or until the
+  *       context is freed.
+  */
+dropt_char**
+dropt_parse(dropt_context* context,
+            int argc, dropt_char** argv)
+{
+    if (   argv == NULL
+        || !check_parse_configuration(context)
+        || argc == 0)
+    {
+        return argv;
+    }
+
+    init_lookup_tables(context);
+
+    if (context->responseFiles.syntax != dropt_quoting_none)
+    {
+        dropt_char** expanded;
+        if (!expand_response_files(context, argc, argv, &expanded))
+        {
+            return argv;
+        }
+
+        if (expanded != argv)
+        {
+            argc = -1;
+            argv = expanded;
+        }
+    }
+
+    return parse_arguments(context, argc, argv);
+}
+
+
+/** dropt_parse_source
+  *
+  *     Parses command-line options read on demand from an argument source,
+  *     such as a generator or a stream, instead of from a list.  Arguments
+  *     are consumed only as parsing needs them, looking ahead at most one
+  *     argument for an option's value; when parsing stops, the first
+  *     unprocessed argument is the one that the source would return next.
+  *
+  *     Response files (see `dropt_enable_response_files`) are not
+  *     expanded, and error details are never deferred (see
+  *     `dropt_defer_error_details`).
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *                      Must not be frozen (see `dropt_freeze_context`).
+  *     IN source      : The argument source.
+  *                      Must not be `NULL`.
+  *
+  * RETURNS:
+  *     The error encountered while parsing, if any.
+  */
+dropt_error
+dropt_parse_source(dropt_context* context, const dropt_arg_source* source)
+{
+    parse_state ps;
+
+    if (source == NULL || source->peek == NULL || source->next == NULL)
+    {
+        DROPT_MISUSE("No argument source specified.");
+        return dropt_error_bad_configuration;
+    }
+
+    if (!check_parse_configuration(context))
+    {
+        return dropt_error_bad_configuration;
+    }
+
+    init_lookup_tables(context);
+
+    ps.option = NULL;
+    ps.optionArgument = NULL;
+    ps.source = source;
+    ps.argv = NULL;
+    ps.argCurrent = NULL;
+    ps.argNext = NULL;
+    ps.argsLeft = 0;
+    ps.moreInput = false;
+    ps.awaitingArgument = false;
+
+    parse_loop(context, &ps);
+    return context->errorDetails.err;
+}
+
+
+/** init_chunk_parse_state
+  *
+  *     Initializes the parse state for a chunk of an incremental parse.
+  *
+  * PARAMETERS:
+  *     OUT ps        : The parse state.
+  *     IN argc       : The number of arguments in the chunk, or -1.
+  *     IN argv       : The chunk.  May be `NULL` if there are no arguments.
+  *     IN moreInput  : Whether more chunks might follow.
+  */
+static void
+init_chunk_parse_state(parse_state* ps, int argc, dropt_char** argv,
+                       bool moreInput)
+{
+    ps->option = NULL;
+    ps->optionArgument = NULL;
+    ps->source = NULL;
+    ps->argv = argv;
+    ps->argCurrent = argv;
+    ps->argNext = argv;
+    ps->argsLeft = (argv == NULL) ? 0 : (argc == -1) ? INT_MAX : argc;
+    ps->moreInput = moreInput;
+    ps->awaitingArgument = false;
+}
+
+
+/** resolve_pending_option
+  *
+  *     Gives the option that ended the previous chunk of an incremental
+  *     parse its value.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *     IN/OUT ps      : The parse state for the current chunk.  If
+  *                        `ps->moreInput` is `false`, the option goes
+  *                        without a value if it can.
+  *
+  * RETURNS:
+  *     `true` if parsing should continue, `false` if it should halt.
+  */
+static bool
+resolve_pending_option(dropt_context* context, parse_state* ps)
+{
+    const dropt_char* arg = context->incremental.pendingArg;
+    dropt_error err;
+
+    ps->option = context->incremental.pendingOption;
+    ps->optionArgument = NULL;
+    err = parse_option_arg(context, ps);
+    assert(!ps->awaitingArgument);
+
+    context->incremental.pendingOption = NULL;
+    context->incremental.pendingArg = NULL;
+
+    if (err != dropt_error_none)
+    {
+        /* The option was the entire argument for a long option or the last
+         * one in a group of short options.
+         */
+        size_t len = dropt_strlen(arg);
+        if (arg[1] == DROPT_TEXT_LITERAL('-'))
+        {
+            set_error_details(context, err, make_char_array(arg, len),
+                              ps->optionArgument);
+        }
+        else
+        {
+            set_short_option_error_details(context, err, arg[len - 1],
+                                           ps->optionArgument);
+        }
+        return false;
+    }
+
+    return !(ps->option->attr & dropt_attr_halt);
+}
+
+
+/** dropt_begin_incremental_parse
+  *
+  *     Starts parsing command-line options that arrive in chunks (see
+  *     `dropt_parse_chunk`).  Clears the context's error.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *                      Must not be frozen (see `dropt_freeze_context`).
+  */
+void
+dropt_begin_incremental_parse(dropt_context* context)
+{
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return;
+    }
+
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
+    }
+
+    clear_error_details(context);
+    context->incremental.active = true;
+    context->incremental.done = false;
+    context->incremental.pendingOption = NULL;
+    context->incremental.pendingArg = NULL;
+}
+
+
+/** dropt_parse_chunk
+  *
+  *     Parses the next chunk of an incremental parse (see
+  *     `dropt_begin_incremental_parse`).  Options are handled as soon as
+  *     their chunk arrives.  If a chunk ends with an option that takes its
+  *     value from the next argument, the option is handled once the next
+  *     chunk arrives, without rescanning anything.  The argument with that
+  *     option must remain valid until then.
+  *
+  *     Once option processing stops, any further chunks are left
+  *     unprocessed.
+  *
+  *     Response files (see `dropt_enable_response_files`) are not expanded.
+  *     Deferred error locations (see `dropt_get_error_location`) refer to
+  *     the chunk.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *                      Must not be frozen (see `dropt_freeze_context`).
+  *     IN argc        : The maximum number of arguments to parse from argv.
+  *                      Pass -1 to parse all arguments up to a `NULL` sentinel
+  *                        value.
+  *     IN argv        : The chunk of arguments.
+  *                      May be `NULL` if `argc` is 0.
+  *     OUT rest       : On output, a pointer to the first unprocessed element
+  *                        in `argv`.
+  *                      Pass `NULL` if unwanted.
+  *
+  * RETURNS:
+  *     `dropt_chunk_parsed` if all of the arguments were processed.
+  *     `dropt_chunk_need_argument` if the last option is waiting for its
+  *       value.
+  *     `dropt_chunk_done` if option processing stopped at a non-option
+  *       argument, at "--", at an option that halts parsing, or because of
+  *       an error (see `dropt_get_error`).
+  */
+dropt_chunk_status
+dropt_parse_chunk(dropt_context* context, int argc, dropt_char** argv,
+                  dropt_char*** rest)
+{
+    dropt_chunk_status status = dropt_chunk_done;
+    parse_state ps;
+
+    init_chunk_parse_state(&ps, argc, argv, true);
+
+    if (argv == NULL && argc != 0)
+    {
+        DROPT_MISUSE("No argument list specified.");
+        goto exit;
+    }
+
+    if (!check_parse_configuration(context)) { goto exit; }
+
+    if (!context->incremental.active)
+    {
+        DROPT_MISUSE("No incremental parse is in progress.");
+        goto exit;
+    }
+
+    if (context->incremental.done) { goto exit; }
+
+    init_lookup_tables(context);
+
+    if (context->incremental.pendingOption != NULL)
+    {
+        if (peek_argument(&ps) == NULL)
+        {
+            status = dropt_chunk_need_argument;
+            goto exit;
+        }
+
+        if (!resolve_pending_option(context, &ps))
+        {
+            context->incremental.done = true;
+            goto exit;
+        }
+
+        ps.option = NULL;
+        ps.optionArgument = NULL;
+    }
+
+    if (parse_loop(context, &ps) && !ps.awaitingArgument)
+    {
+        context->incremental.done = true;
+    }
+    else if (ps.awaitingArgument)
+    {
+        context->incremental.pendingOption = ps.option;
+        context->incremental.pendingArg = *ps.argCurrent;
+        status = dropt_chunk_need_argument;
+    }
+    else
+    {
+        status = dropt_chunk_parsed;
+    }
+
+exit:
+    if (rest != NULL) { *rest = ps.argNext; }
+    return status;
+}
+
+
+/** dropt_end_incremental_parse
+  *
+  *     Finishes an incremental parse (see `dropt_begin_incremental_parse`).
+  *     An option still waiting for its value goes without one if its value
+  *     is optional and fails with `dropt_error_insufficient_arguments`
+  *     otherwise.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *                      Must not be frozen (see `dropt_freeze_context`).
+  *
+  * RETURNS:
+  *     The error encountered while parsing, if any.
+  */
+dropt_error
+dropt_end_incremental_parse(dropt_context* context)
+{
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return dropt_error_bad_configuration;
+    }
+
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return dropt_error_bad_configuration;
+    }
+
+    if (   context->incremental.active
+        && !context->incremental.done
+        && context->incremental.pendingOption != NULL)
+    {
+        parse_state ps;
+        init_chunk_parse_state(&ps, 0, NULL, false);
+        resolve_pending_option(context, &ps);
+    }
+
+    context->incremental.active = false;
+    context->incremental.done = false;
+    context->incremental.pendingOption = NULL;
+    context->incremental.pendingArg = NULL;
+
+    return context->errorDetails.err;
+}
+
+
+/** dropt_parse_batch
+  *
+  *     Parses many independent lists of command-line arguments in one call.
+  *     The context is validated and its lookup tables are initialized once
+  *     for the entire batch.
+  *
+  *     Each list is parsed as if by a separate call to `dropt_parse`, with
+  *     the context's error cleared beforehand.  When the call returns, the
+  *     context holds the error details (if any) for the last list only.
+  *     Response files (see `dropt_enable_response_files`) are not expanded.
+  *
+  *     If the context has a result tape (see `dropt_set_result_tape`), the
+  *     lists' entries are appended to it in order, and each list's result
+  *     says where its entries are.  The entries recorded for a list that
+  *     failed to parse are left on the tape.
+  *
+  *     To parse a batch on multiple threads, freeze the context (see
+  *     `dropt_freeze_context`) and give each thread its own parse context
+  *     and its own slice of the batch.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *                      Must not be frozen (see `dropt_freeze_context`).
+  *     IN n           : The number of argument lists.
+  *     IN argcs       : The maximum number of arguments to parse from each
+  *                        list (see `dropt_parse`).
+  *                      May be `NULL` if every list is `NULL`-terminated.
+  *     IN argvs       : The argument lists, not including the initial
+  *                        program names.
+  *                      Individual lists may be `NULL`.
+  *     OUT results    : On output, the error code, the first unprocessed
+  *                        argument, and the result tape entries for each
+  *                        list.
+  *                      Must have room for `n` elements.
+  *
+  * RETURNS:
+  *     The number of argument lists that failed to parse.
+  */
+size_t
+dropt_parse_batch(dropt_context* context, size_t n,
+                  const int* argcs, dropt_char** const* argvs,
+                  dropt_parse_result* results)
+{
+    size_t numFailed = 0;
+    size_t i;
+
+    if (n == 0) { return 0; }
+
+    if (argvs == NULL || results == NULL)
+    {
+        DROPT_MISUSE("No argument lists or results specified.");
+        return n;
+    }
+
+    if (!check_parse_configuration(context))
+    {
+        for (i = 0; i < n; i++)
+        {
+            results[i].err = dropt_error_bad_configuration;
+            results[i].rest = argvs[i];
+            results[i].tape_start = 0;
+            results[i].tape_length = 0;
+        }
+        return n;
+    }
+
+    init_lookup_tables(context);
+
+    for (i = 0; i < n; i++)
+    {
+        int argc = (argcs == NULL) ? -1 : argcs[i];
+
+        clear_error_details(context);
+
+        results[i].tape_start = context->tapeLength;
+        results[i].rest = (argvs[i] == NULL || argc == 0)
+                          ? argvs[i]
+                          : parse_arguments(context, argc, argvs[i]);
+        results[i].err = context->errorDetails.err;
+        results[i].tape_length = context->tapeLength - results[i].tape_start;
+        if (results[i].err != dropt_error_none) { numFailed++; }
+    }
+
+    return numFailed;
+}
+
+
+/** new_context
+  *
+  *     Creates a new dropt context with the specified allocator.
+  *
+  * PARAMETERS:
+  *     IN options   : The list of option specifications.
+  *                    Must not be `NULL`.
+  *     IN allocator : The allocator for the context and its data.
+  *                    Must not be `NULL`.
+  *
+  * RETURNS:
+  *     An allocated dropt context, or `NULL` on error.
+  */
+static dropt_context*
+new_context(const dropt_option* options, const dropt_allocator* allocator)
+{
+    dropt_context* context = NULL;
+    size_t n;
+
+    assert(allocator != NULL);
+
+    if (options == NULL)
+    {
+        DROPT_MISUSE("No option list specified.");
+        goto exit;
+    }
+
+    /* Sanity-check the options. */
+    for (n = 0; is_valid_option(&options[n]); n++)
+    {
+        if (   options[n].short_name == DROPT_TEXT_LITERAL('=')
+            || (   options[n].long_name != NULL
+                && dropt_strchr(options[n].long_name, DROPT_TEXT_LITERAL('=')) != NULL))
+        {
+            DROPT_MISUSE("Invalid option list. '=' may not be used in an option name.");
+            goto exit;
+        }
+    }
+
+    context = dropt_allocator_realloc(allocator, NULL, 1, sizeof *context);
+    if (context == NULL)
+    {
+        goto exit;
+    }
+    else
+    {
+        dropt_context emptyContext = { 0 };
+        *context = emptyContext;
+
+        context->allocator = *allocator;
+        context->selfAllocator = *allocator;
+        context->options = options;
+        context->numOptions = n;
+        dropt_set_strncmp(context, NULL);
+    }
+
+exit:
+    return context;
+}
+
+
+/** dropt_new_context
+  *
+  *     Creates a new dropt context.
+  *
+  * PARAMETERS:
+  *     IN options : The list of option specifications.
+  *                  Must not be `NULL`.
+  *                  The list is *not* copied and must outlive the dropt
+  *                    context.
+  *
+  * RETURNS:
+  *     An allocated dropt context.  The caller is responsible for freeing
+  *       it with `dropt_free_context` when no longer needed.
+  *     Returns `NULL` on error.
+  */
+dropt_context*
+dropt_new_context(const dropt_option* options)
+{
+    dropt_allocator allocator;
+    dropt_get_allocator(&allocator);
+    return new_context(options, &allocator);
+}
+
+
+/** dropt_new_composite_context
+  *
+  *     Creates a dropt context that combines the options of several
+  *     contexts, as if their option lists were concatenated, without copying
+  *     the lists.  Options are numbered through each part's options in turn
+  *     (see `dropt_get_option`).  If multiple options have equivalent names,
+  *     the first one wins.
+  *
+  *     Each part's lookup tables are built (if they haven't been already)
+  *     and kept with the part, so a part may be shared by any number of
+  *     composite contexts.  The composite context's sorted index of long
+  *     names is merged from the parts' indices instead of being sorted
+  *     again, provided that the parts compare names the same way as the
+  *     composite context (see `dropt_set_strncmp` and
+  *     `dropt_set_case_insensitive`).
+  *
+  *     The new context has the default settings; it doesn't inherit the
+  *     parts' settings.
+  *
+  * PARAMETERS:
+  *     IN parts    : The dropt contexts to combine.
+  *                   Must not be `NULL`.
+  *                   The array is copied, but the contexts must outlive the
+  *                     composite context.
+  *     IN numParts : The number of elements in `parts`.
+  *                   Must not be 0.
+  *
+  * RETURNS:
+  *     An allocated dropt context.  The caller is responsible for freeing
+  *       it with `dropt_free_context` when no longer needed.
+  *     Returns `NULL` on error.
+  */
+dropt_context*
+dropt_new_composite_context(dropt_context* const* parts, size_t numParts)
+{
+    dropt_context* context = NULL;
+    dropt_allocator allocator;
+    size_t numOptions = 0;
+    size_t i;
+
+    if (parts == NULL || numParts == 0)
+    {
+        DROPT_MISUSE("No dropt contexts specified.");
+        return NULL;
+    }
+
+    for (i = 0; i < numParts; i++)
+    {
+        if (parts[i] == NULL)
+        {
+            DROPT_MISUSE("No dropt context specified.");
+            return NULL;
+        }
+
+        if (numOptions > SIZE_MAX - parts[i]->numOptions) { return NULL; }
+        numOptions += parts[i]->numOptions;
+    }
+
+    /* The part and option pointers follow the context in the same
+     * allocation, so parse contexts (see `dropt_new_parse_context`) can
+     * share them without owning them.
+     */
+    if (   numParts > (SIZE_MAX - sizeof *context) / sizeof *parts
+        || numOptions > (SIZE_MAX - sizeof *context - numParts * sizeof *parts)
+                        / sizeof *(context->optionRefs))
+    {
+        return NULL;
+    }
+
+    dropt_get_allocator(&allocator);
+    context = dropt_allocator_realloc(&allocator, NULL, 1,
+                                      sizeof *context
+                                      + numParts * sizeof *parts
+                                      + numOptions * sizeof *(context->optionRefs));
+    if (context != NULL)
+    {
+        dropt_context emptyContext = { 0 };
+        size_t k = 0;
+
+        *context = emptyContext;
+        context->allocator = allocator;
+        context->selfAllocator = allocator;
+        context->numOptions = numOptions;
+        context->parts = (dropt_context**) (context + 1);
+        context->numParts = numParts;
+        context->optionRefs = (const dropt_option**) (context->parts + numParts);
+        dropt_set_strncmp(context, NULL);
+
+        for (i = 0; i < numParts; i++)
+        {
+            dropt_context* part = parts[i];
+            size_t j;
+
+            context->parts[i] = part;
+            for (j = 0; j < part->numOptions; j++)
+            {
+                context->optionRefs[k++] = context_option(part, j);
+            }
+
+            /* Our index is merged from the parts' indices. */
+            if (!part->frozen) { init_lookup_tables(part); }
+        }
+        assert(k == numOptions);
+    }
+
+    return context;
+}
+
+
+/** add_arena_block
+  *
+  *     Adds the space for an arena block to a running total, saturating on
+  *     overflow.
+  *
+  * PARAMETERS:
+  *     IN total       : The running total, in bytes.
+  *     IN numElements : The number of elements in the block.
+  *     IN elementSize : The size of each element, in bytes.
+  *
+  * RETURNS:
+  *     The new total.
+  */
+static size_t
+add_arena_block(size_t total, size_t numElements, size_t elementSize)
+{
+    size_t size;
+
+    if (numElements == 0) { return total; }
+
+    size = numElements * elementSize;
+    if (size / elementSize != numElements) { return SIZE_MAX; }
+
+    size = arena_round_up(size);
+    if (size == 0 || size > SIZE_MAX - sizeof (arena_block)) { return SIZE_MAX; }
+
+    size += sizeof (arena_block);
+    return (total > SIZE_MAX - size) ? SIZE_MAX : total + size;
+}
+
+
+/** arena_size
+  *
+  *     Computes an arena size that is large enough for a dropt context (see
+  *     `dropt_new_context_in_arena`), its lookup tables, and the error
+  *     details for option names and arguments of up to
+  *     `DROPT_ARENA_ERROR_LENGTH` characters.
+  *
+  *     The lookup tables include the optional ones for case-insensitive
+  *     lookups, hashed lookups, and abbreviations, but not the subcommand
+  *     hash, which depends on the subcommands.
+  *
+  * PARAMETERS:
+  *     IN numOptions    : The number of options.
+  *     IN numLong       : The number of options with long names.
+  *     IN numShort      : The number of options with short names.
+  *     IN numNameChars  : The total length of the long names, including
+  *                          their `NUL`-terminators.
+  *     IN maxNameLength : The length of the longest long name.
+  *
+  * RETURNS:
+  *     The arena size, in bytes.
+  *     Returns 0 on overflow.
+  */
+static size_t
+arena_size(size_t numOptions, size_t numLong, size_t numShort,
+           size_t numNameChars, size_t maxNameLength)
+{
+    size_t numBuckets = (numLong + 1) / 2;
+    size_t total;
+
+    total = arena_round_up(sizeof (context_arena));
+    total = add_arena_block(total, 1, sizeof (dropt_context));
+
+    /* The long name index, plus its temporary sorted copy. */
+    total = add_arena_block(total, numLong, sizeof (option_proxy));
+    total = add_arena_block(total, numLong,
+                            2 * sizeof (dropt_uint32)
+                            + long_name_prefix_length * sizeof (dropt_char));
+
+    /* The long name hash, plus its temporary tables. */
+    total = add_arena_block(total, numLong, sizeof (hash_key));
+    total = add_arena_block(total, numLong, sizeof (size_t));
+    total = add_arena_block(total, numBuckets + 1, sizeof (size_t));
+    total = add_arena_block(total, MAX(numBuckets, numLong), sizeof (size_t));
+    total = add_arena_block(total, numBuckets + 2 * numLong,
+                            sizeof (dropt_uint32));
+
+    /* The short name table or, for custom comparison functions, the sorted
+     * short names.
+     */
+#ifdef DROPT_USE_WCHAR
+    total = add_arena_block(total, MAX(8, 4 * numShort),
+                            sizeof (short_name_slot));
+#else
+    total = add_arena_block(total, UCHAR_MAX + 1, sizeof (dropt_uint32));
+    (void) numShort;
+#endif
+    total = add_arena_block(total, numOptions, sizeof (option_proxy));
+
+    /* The folded long names for case-insensitive lookups, plus the buffer
+     * for folding names too long for the stack.
+     */
+    total = add_arena_block(total, numOptions, sizeof (dropt_char*));
+    total = add_arena_block(total, numNameChars, sizeof (dropt_char));
+    if (maxNameLength > fold_buffer_length)
+    {
+        total = add_arena_block(total, maxNameLength, sizeof (dropt_char));
+    }
+
+    /* The abbreviation trie. */
+    total = add_arena_block(total, numLong, 2 * sizeof (prefix_trie_node));
+
+    /* The error details. */
+    total = add_arena_block(total, DROPT_ARENA_ERROR_LENGTH + 1,
+                            sizeof (dropt_char));
+    total = add_arena_block(total, DROPT_ARENA_ERROR_LENGTH + 1,
+                            sizeof (dropt_char));
+
+    return (total == SIZE_MAX) ? 0 : total;
+}
+
+
+/** dropt_arena_size
+  *
+  *     Computes an arena size that is large enough for a dropt context with
+  *     the specified options (see `dropt_new_context_in_arena`).
+  *
+  * PARAMETERS:
+  *     IN options : The list of option specifications.
+  *                  Must not be `NULL`.
+  *
+  * RETURNS:
+  *     The arena size, in bytes.
+  *     Returns 0 on error.
+  */
+size_t
+dropt_arena_size(const dropt_option* options)
+{
+    size_t numOptions;
+    size_t numLong = 0;
+    size_t numShort = 0;
+    size_t numNameChars = 0;
+    size_t maxNameLength = 0;
+
+    if (options == NULL)
+    {
+        DROPT_MISUSE("No option list specified.");
+        return 0;
+    }
+
+    for (numOptions = 0; is_valid_option(&options[numOptions]); numOptions++)
+    {
+        if (options[numOptions].long_name != NULL)
+        {
+            size_t len = dropt_strlen(options[numOptions].long_name);
+            if (len > maxNameLength) { maxNameLength = len; }
+            if (numNameChars > SIZE_MAX - len - 1) { return 0; }
+            numNameChars += len + 1;
+            numLong++;
+        }
+        if (options[numOptions].short_name != DROPT_TEXT_LITERAL('\0'))
+        {
+            numShort++;
+        }
+    }
+
+    return arena_size(numOptions, numLong, numShort, numNameChars,
+                      maxNameLength);
+}
+
+
+/** dropt_context_size
+  *
+  *     Computes a buffer size that is large enough for any dropt context with
+  *     up to the specified number of options and long names of up to the
+  *     specified length (see `dropt_init_context_in`).
+  *
+  * PARAMETERS:
+  *     IN numOptions    : The number of options, excluding the terminating
+  *                          sentinel.
+  *     IN maxNameLength : The length of the longest long name.
+  *
+  * RETURNS:
+  *     The buffer size, in bytes.
+  *     Returns 0 on overflow.
+  */
+size_t
+dropt_context_size(size_t numOptions, size_t maxNameLength)
+{
+    if (   maxNameLength == SIZE_MAX
+        || (   numOptions != 0
+            && maxNameLength + 1 > SIZE_MAX / numOptions))
+    {
+        return 0;
+    }
+
+    return arena_size(numOptions, numOptions, numOptions,
+                      numOptions * (maxNameLength + 1), maxNameLength);
+}
+
+
+/** dropt_new_context_in_arena
+  *
+  *     Creates a new dropt context that lives in a single block of memory
+  *     along with its lookup tables and error details.  The lookup tables
+  *     are built immediately.
+  *
+  *     Use `dropt_reset_context` between parses to reclaim the arena space
+  *     used by error details; steady-state parsing then uses no heap memory
+  *     (except for error messages; see `dropt_get_error_message`).  Anything
+  *     that doesn't fit in the arena falls back to the global allocator.
+  *
+  * PARAMETERS:
+  *     IN options    : The list of option specifications.
+  *                     Must not be `NULL`.
+  *                     The list is *not* copied and must outlive the dropt
+  *                       context.
+  *     IN buffer     : The memory for the arena.  Must be suitably aligned
+  *                       for any object, and must outlive the dropt
+  *                       context.
+  *                     Pass `NULL` to have dropt allocate the arena with the
+  *                       global allocator.
+  *     IN bufferSize : The size of the arena, in bytes.
+  *                     Pass 0 with a `NULL` buffer to use
+  *                       `dropt_arena_size(options)`.
+  *
+  * RETURNS:
+  *     A dropt context.  The caller is responsible for freeing it with
+  *       `dropt_free_context` when no longer needed.
+  *     Returns `NULL` on error.
+  */
+dropt_context*
+dropt_new_context_in_arena(const dropt_option* options,
+                           void* buffer, size_t bufferSize)
+{
+    context_arena* arena;
+    dropt_allocator allocator;
+    dropt_context* context;
+    size_t headerSize = arena_round_up(sizeof *arena);
+    bool owned = false;
+
+    if (options == NULL)
+    {
+        DROPT_MISUSE("No option list specified.");
+        return NULL;
+    }
+
+    if (buffer == NULL && bufferSize == 0)
+    {
+        bufferSize = dropt_arena_size(options);
+    }
+
+    if (bufferSize < headerSize)
+    {
+        DROPT_MISUSE("The arena is too small.");
+        return NULL;
+    }
+
+    if (buffer == NULL)
+    {
+        buffer = dropt_safe_malloc(bufferSize, 1);
+        if (buffer == NULL) { return NULL; }
+        owned = true;
+    }
+    else if ((dropt_uintptr) buffer % ARENA_ALIGNMENT != 0)
+    {
+        DROPT_MISUSE("The arena is misaligned.");
+        return NULL;
+    }
+
+    arena = buffer;
+    arena->base = buffer;
+    arena->size = bufferSize;
+    arena->top = headerSize;
+    arena->lastBlock = NO_ARENA_BLOCK;
+    arena->mark = arena->top;
+    arena->markLastBlock = arena->lastBlock;
+    arena->owned = owned;
+
+    allocator.reallocate = arena_reallocate;
+    allocator.deallocate = arena_deallocate;
+    allocator.user_data = arena;
+
+    context = new_context(options, &allocator);
+    if (context == NULL)
+    {
+        if (owned) { dropt_free(buffer); }
+        return NULL;
+    }
+
+    context->arena = arena;
+    init_lookup_tables(context);
+    return context;
+}
+
+
+/** dropt_init_context_in
+  *
+  *     Creates a new dropt context in caller-provided storage, such as a
+  *     stack or static buffer.  This is like `dropt_new_context_in_arena`
+  *     except that the buffer must be large enough for the context and its
+  *     lookup tables, so creating the context allocates no memory.  Parsing
+  *     then allocates no memory either if error details are deferred (see
+  *     `dropt_defer_error_details`) or if they are no longer than
+  *     `DROPT_ARENA_ERROR_LENGTH` characters and `dropt_reset_context` is
+  *     called between parses.
+  *
+  *     The buffer has room for the lookup tables needed for case-insensitive
+  *     lookups, hashed lookups, and abbreviations.  Subcommands (see
+  *     `dropt_set_subcommands`) are the exception: their contexts always
+  *     live on the heap, and their lookup table spills to the heap if the
+  *     buffer has no room for it.
+  *
+  *     The context still must be freed with `dropt_free_context`, which
+  *     doesn't free the buffer.
+  *
+  * PARAMETERS:
+  *     IN buffer     : The storage for the context.  Must be suitably aligned
+  *                       for any object, and must outlive the dropt
+  *                       context.
+  *                     Must not be `NULL`.
+  *     IN bufferSize : The size of `buffer`, in bytes.  Must be at least
+  *                       `dropt_arena_size(options)`, which
+  *                       `dropt_context_size` bounds by the number of
+  *                       options and the length of the longest long name.
+  *     IN options    : The list of option specifications.
+  *                     Must not be `NULL`.
+  *                     The list is *not* copied and must outlive the dropt
+  *                       context.
+  *
+  * RETURNS:
+  *     The dropt context, which is located within `buffer`.
+  *     Returns `NULL` if `buffer` is too small or on error.
+  */
+dropt_context*
+dropt_init_context_in(void* buffer, size_t bufferSize,
+                      const dropt_option* options)
+{
+    size_t requiredSize;
+
+    if (buffer == NULL)
+    {
+        DROPT_MISUSE("No buffer specified.");
+        return NULL;
+    }
+
+    requiredSize = dropt_arena_size(options);
+    if (requiredSize == 0) { return NULL; }
+
+    if (bufferSize < requiredSize) { return NULL; }
+
+    return dropt_new_context_in_arena(options, buffer, bufferSize);
+}
+
+
+/** dropt_reset_context
+  *
+  *     Prepares a dropt context for another parse: clears its error and
+  *     rewinds its result tape (see `dropt_set_result_tape`).  For an
+  *     arena-based context (see `dropt_new_context_in_arena`), also reclaims
+  *     all arena space other than that used by the context and its lookup
+  *     tables.  This includes the arguments expanded from response files
+  *     (see `dropt_enable_response_files`), so the list returned by the
+  *     previous `dropt_parse` call must no longer be used.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *                      Must not be frozen (see `dropt_freeze_context`).
+  */
+void
+dropt_reset_context(dropt_context* context)
+{
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return;
+    }
+
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
+    }
+
+    clear_error_details(context);
+    context->tapeLength = 0;
+
+    if (context->arena != NULL)
+    {
+        /* The response file state may live above the mark. */
+        free_response_files(context);
+
+        context->arena->top = context->arena->mark;
+        context->arena->lastBlock = context->arena->markLastBlock;
+    }
+}
+
+
+/** index_blob_sizes
+  *
+  *     Computes the sizes of the sections of a serialized lookup index.
+  *
+  * PARAMETERS:
+  *     IN header       : The header of the serialized index.
+  *                       Must not be `NULL`.
+  *     OUT longSize    : On output, the size of the `long_name_index`
+  *                         section.
+  *     OUT shortSize   : On output, the size of the `short_name_table`
+  *                         section.
+  *     OUT hashSize    : On output, the size of the `long_name_hash` section.
+  *
+  * RETURNS:
+  *     The total size of the serialized index, in bytes, including the
+  *       header.  All of the sizes are in units of `dropt_uint32`.
+  *     Returns 0 on overflow.
+  */
+static size_t
+index_blob_sizes(const index_blob_header* header,
+                 size_t* longSize, size_t* shortSize, size_t* hashSize)
+{
+    size_t perLongName = 2 + long_name_prefix_length * sizeof (dropt_char)
+                             / sizeof (dropt_uint32);
+#ifdef DROPT_USE_WCHAR
+    size_t perShortSlot = 2;
+#else
+    size_t perShortSlot = 1;
+#endif
+    size_t total;
+
+    assert(header != NULL);
+    assert(longSize != NULL);
+    assert(shortSize != NULL);
+    assert(hashSize != NULL);
+
+    /* Each count is at most 2^32, so none of these can overflow a 64-bit
+     * `size_t`.  Be careful anyway.
+     */
+    if (   header->longCount > SIZE_MAX / perLongName
+        || header->numShortSlots > SIZE_MAX / perShortSlot
+        || header->numHashSlots > (SIZE_MAX - header->numHashBuckets) / 2)
+    {
+        return 0;
+    }
+
+    *longSize = header->longCount * perLongName;
+    *shortSize = header->numShortSlots * perShortSlot;
+    *hashSize = header->numHashBuckets + 2 * (size_t) header->numHashSlots;
+
+    total = sizeof *header / sizeof (dropt_uint32);
+    if (   *longSize > SIZE_MAX - total
+        || *shortSize > SIZE_MAX - total - *longSize
+        || *hashSize > SIZE_MAX - total - *longSize - *shortSize)
+    {
+        return 0;
+    }
+    total += *longSize + *shortSize + *hashSize;
+
+    return (total > SIZE_MAX / sizeof (dropt_uint32))
+           ? 0
+           : total * sizeof (dropt_uint32);
+}
+
+
+/** dropt_serialize_index
+  *
+  *     Serializes the lookup index of a dropt context into a flat,
+  *     position-independent blob.  The blob may be saved (e.g. to a file)
+  *     and later passed to `dropt_new_context_from_index` to create a context
+  *     without needing to build the index again.
+  *
+  *     The blob uses the native byte order and character width, and it's
+  *     valid only with the same option table.  The index is built for the
+  *     default string comparison function, so contexts with a custom
+  *     `dropt_strncmp_func` can't be serialized.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     OUT buffer     : On output, the serialized index.
+  *                      Pass `NULL` to query the required size.
+  *     IN bufferSize  : The size of `buffer`, in bytes.
+  *
+  * RETURNS:
+  *     The size of the serialized index, in bytes.  If `buffer` is `NULL`
+  *       or is too small, nothing is written.
+  *     Returns 0 on error.
+  */
+size_t
+dropt_serialize_index(dropt_context* context,
+                      void* buffer, size_t bufferSize)
+{
+    index_blob_header header = { 0 };
+    size_t longSize, shortSize, hashSize;
+    size_t blobSize;
+    size_t i;
+
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return 0;
+    }
+
+    if (   context->ncmpstr != dropt_strncmp
+        || context->numOptions >= EMPTY_HASH_SLOT)
+    {
+        return 0;
+    }
+
+    init_lookup_tables(context);
+
+    assert(sizeof header == DROPT_INDEX_HEADER_LENGTH * sizeof (dropt_uint32));
+
+    header.magic = DROPT_INDEX_MAGIC;
+    header.version = DROPT_INDEX_VERSION;
+    header.charSize = sizeof (dropt_char);
+    header.numOptions = (dropt_uint32) context->numOptions;
+
+    for (i = 0; i < context->numOptions; i++)
+    {
+        if (   context_option(context, i)->long_name != NULL
+            && context->longIndex.lengths == NULL)
+        {
+            /* We failed to build the index. */
+            return 0;
+        }
+    }
+
+    /* The index omits duplicate long names. */
+    header.longCount = (dropt_uint32) context->longIndex.count;
+
+    if (context->shortTable.slots == NULL)
+    {
+        return 0;
+    }
+#ifdef DROPT_USE_WCHAR
+    header.numShortSlots = (dropt_uint32) (context->shortTable.mask + 1);
+#else
+    header.numShortSlots = UCHAR_MAX + 1;
+#endif
+
+    if (context->longHash.seeds != NULL)
+    {
+        header.numHashBuckets = (dropt_uint32) context->longHash.numBuckets;
+        header.numHashSlots = (dropt_uint32) context->longHash.numSlots;
+    }
+
+    blobSize = index_blob_sizes(&header, &longSize, &shortSize, &hashSize);
+    if (blobSize == 0 || buffer == NULL || bufferSize < blobSize)
+    {
+        return blobSize;
+    }
+
+    {
+        dropt_uint32* p = buffer;
+
+        memcpy(p, &header, sizeof header);
+        p += sizeof header / sizeof *p;
+
+        if (longSize != 0)
+        {
+            /* The index arrays share a single, contiguous allocation. */
+            memcpy(p, context->longIndex.lengths, longSize * sizeof *p);
+            p += longSize;
+        }
+
+        memcpy(p, context->shortTable.slots, shortSize * sizeof *p);
+        p += shortSize;
+
+        if (hashSize != 0)
+        {
+            memcpy(p, context->longHash.seeds, hashSize * sizeof *p);
+            p += hashSize;
+        }
+
+        assert((size_t) ((unsigned char*) p - (unsigned char*) buffer)
+               == blobSize);
+    }
+
+    return blobSize;
+}
+
+
+/** validate_index_blob
+  *
+  *     Checks that the lookup tables borrowed from a serialized index are
+  *     consistent with a dropt context's option list.  This guards against
+  *     blobs that were generated for a different option table or that were
+  *     corrupted, which could otherwise cause out-of-bounds reads or wrong
+  *     lookups.
+  *
+  * PARAMETERS:
+  *     IN context : The dropt context.
+  *                  Must not be `NULL`.
+  *
+  * RETURNS:
+  *     true if the tables are consistent, false otherwise.
+  */
+static bool
+validate_index_blob(dropt_context* context)
+{
+    const long_name_index* longIndex = &context->longIndex;
+    const short_name_table* table = &context->shortTable;
+    const long_name_hash* hash = &context->longHash;
+    unsigned char* indexed = NULL;
+    size_t numLongNames = 0;
+    size_t i;
+    bool success = false;
+
+    assert(context != NULL);
+
+    for (i = 0; i < context->numOptions; i++)
+    {
+        if (context_option(context, i)->long_name != NULL) { numLongNames++; }
+    }
+
+    if ((longIndex->lengths == NULL) != (numLongNames == 0)) { goto exit; }
+
+    if (longIndex->lengths != NULL)
+    {
+        if (longIndex->count > numLongNames) { goto exit; }
+
+        indexed = context_malloc(context, context->numOptions, sizeof *indexed);
+        if (indexed == NULL) { goto exit; }
+        memset(indexed, 0, context->numOptions * sizeof *indexed);
+
+        /* The entries must name distinct options, must agree with the
+         * options' long names, and must be sorted without duplicates.
+         */
+        for (i = 0; i < longIndex->count; i++)
+        {
+            const dropt_char* prefix
+                = &longIndex->prefixes[i * long_name_prefix_length];
+            const dropt_char* longName;
+            size_t len;
+            size_t j;
+
+            if (longIndex->indices[i] >= context->numOptions) { goto exit; }
+
+            longName = context_option(context, longIndex->indices[i])->long_name;
+            if (longName == NULL) { goto exit; }
+
+            len = dropt_strlen(longName);
+            if (len != longIndex->lengths[i]) { goto exit; }
+
+            for (j = 0; j < long_name_prefix_length; j++)
+            {
+                if (prefix[j] != ((j < len) ? longName[j]
+                                            : DROPT_TEXT_LITERAL('\0')))
+                {
+                    goto exit;
+                }
+            }
+
+            if (   i > 0
+                && cmp_key_long_name_index(context,
+                                           make_char_array(longName, len),
+                                           i - 1) <= 0)
+            {
+                goto exit;
+            }
+
+            indexed[longIndex->indices[i]] = 1;
+        }
+
+        /* Every other long name must be a duplicate of an indexed name that
+         * appears earlier in the option list, which makes `count` the number
+         * of distinct long names.  Duplicates are rare, so searching for each
+         * one keeps the check linear in practice.
+         */
+        for (i = 0; i < context->numOptions; i++)
+        {
+            const dropt_char* longName = context_option(context, i)->long_name;
+            char_array key;
+            size_t lo = 0;
+            size_t hi = longIndex->count;
+            bool found = false;
+
+            if (longName == NULL || indexed[i]) { continue; }
+
+            key = make_char_array(longName, dropt_strlen(longName));
+            while (lo < hi)
+            {
+                size_t mid = lo + (hi - lo) / 2;
+                int ret = cmp_key_long_name_index(context, key, mid);
+                if (ret == 0)
+                {
+                    found = (longIndex->indices[mid] < i);
+                    break;
+                }
+                else if (ret < 0)
+                {
+                    hi = mid;
+                }
+                else
+                {
+                    lo = mid + 1;
+                }
+            }
+            if (!found) { goto exit; }
+        }
+    }
+
+    if (hash->seeds != NULL)
+    {
+        if (hash->numSlots != longIndex->count) { goto exit; }
+
+        for (i = 0; i < hash->numSlots; i++)
+        {
+            const dropt_char* longName;
+
+            if (hash->slots[i] >= context->numOptions) { goto exit; }
+
+            longName = context_option(context, hash->slots[i])->long_name;
+            if (   longName == NULL
+                || dropt_strlen(longName) != hash->lengths[i])
+            {
+                goto exit;
+            }
+        }
+    }
+
+#ifdef DROPT_USE_WCHAR
+    {
+        /* Probing stops only at an unoccupied slot, so there must be one. */
+        bool hasEmptySlot = false;
+        for (i = 0; i <= table->mask; i++)
+        {
+            if (table->slots[i].shortName == 0)
+            {
+                hasEmptySlot = true;
+            }
+            else if (   table->slots[i].option >= context->numOptions
+                     || (dropt_uint32) context_option(context,
+                                                      table->slots[i].option)
+                                       ->short_name
+                        != table->slots[i].shortName)
+            {
+                goto exit;
+            }
+        }
+        if (!hasEmptySlot) { goto exit; }
+    }
+#else
+    for (i = 0; i <= UCHAR_MAX; i++)
+    {
+        if (   table->slots[i] != EMPTY_HASH_SLOT
+            && (   table->slots[i] >= context->numOptions
+                || (unsigned char) context_option(context, table->slots[i])
+                                   ->short_name
+                   != i))
+        {
+            goto exit;
+        }
+    }
+#endif
+
+    success = true;
+
+exit:
+    context_free(context, indexed);
+    return success;
+}
+
+
+/** dropt_new_context_from_index
+  *
+  *     Creates a new dropt context that uses a lookup index previously
+  *     generated by `dropt_serialize_index`.  The index isn't copied, so
+  *     creating the context doesn't require sorting the options or
+  *     allocating lookup tables.  The index is still checked against the
+  *     list of options, which takes time linear in the number of options.
+  *
+  * PARAMETERS:
+  *     IN options   : The list of option specifications.
+  *                    Must not be `NULL`.
+  *                    Must be identical to the list used to create the
+  *                      serialized index.
+  *                    The list is *not* copied and must outlive the dropt
+  *                      context.
+  *     IN index     : The serialized lookup index (e.g. a memory-mapped
+  *                      file).
+  *                    Must not be `NULL`.
+  *                    Must be aligned to a 4-byte boundary.
+  *                    The index is *not* copied and must outlive the dropt
+  *                      context.
+  *     IN indexSize : The size of `index`, in bytes.
+  *
+  * RETURNS:
+  *     An allocated dropt context.  The caller is responsible for freeing
+  *       it with `dropt_free_context` when no longer needed.
+  *     Returns `NULL` on error, including if the index is malformed or
+  *       doesn't match the list of options.
+  */
+dropt_context*
+dropt_new_context_from_index(const dropt_option* options,
+                             const void* index, size_t indexSize)
+{
+    dropt_context* context = NULL;
+    index_blob_header header;
+    size_t longSize, shortSize, hashSize;
+    dropt_uint32* p;
+
+    if (index == NULL)
+    {
+        DROPT_MISUSE("No index specified.");
+        return NULL;
+    }
+
+    if (   indexSize < sizeof header
+        || (dropt_uintptr) index % sizeof (dropt_uint32) != 0)
+    {
+        return NULL;
+    }
+
+    memcpy(&header, index, sizeof header);
+    if (   header.magic != DROPT_INDEX_MAGIC
+        || header.version != DROPT_INDEX_VERSION
+        || header.charSize != sizeof (dropt_char)
+        || header.numShortSlots == 0
+        || (header.numHashBuckets == 0) != (header.numHashSlots == 0)
+        || index_blob_sizes(&header, &longSize, &shortSize, &hashSize)
+           != indexSize)
+    {
+        return NULL;
+    }
+
+#ifdef DROPT_USE_WCHAR
+    if ((header.numShortSlots & (header.numShortSlots - 1)) != 0)
+    {
+        return NULL;
+    }
+#else
+    if (header.numShortSlots != UCHAR_MAX + 1) { return NULL; }
+#endif
+
+    context = dropt_new_context(options);
+    if (context == NULL) { return NULL; }
+
+    if (header.numOptions != context->numOptions)
+    {
+        dropt_free_context(context);
+        return NULL;
+    }
+
+    /* The index is never written through these pointers. */
+    p = (dropt_uint32*) index + sizeof header / sizeof *p;
+
+    if (header.longCount != 0)
+    {
+        long_name_index* longIndex = &context->longIndex;
+        longIndex->count = header.longCount;
+        longIndex->lengths = p;
+        longIndex->indices = longIndex->lengths + header.longCount;
+        longIndex->prefixes = (dropt_char*) (longIndex->indices
+                                             + header.longCount);
+        longIndex->borrowed = true;
+        p += longSize;
+    }
+
+    context->shortTable.slots = (void*) p;
+#ifdef DROPT_USE_WCHAR
+    context->shortTable.mask = header.numShortSlots - 1;
+#endif
+    context->shortTable.borrowed = true;
+    p += shortSize;
+
+    if (header.numHashBuckets != 0)
+    {
+        long_name_hash* hash = &context->longHash;
+        hash->numBuckets = header.numHashBuckets;
+        hash->numSlots = header.numHashSlots;
+        hash->seeds = p;
+        hash->slots = hash->seeds + hash->numBuckets;
+        hash->lengths = hash->slots + hash->numSlots;
+        hash->borrowed = true;
+        context->useHashedLookup = true;
+    }
+
+    if (!validate_index_blob(context))
+    {
+        dropt_free_context(context);
+        return NULL;
+    }
+
+    return context;
+}
+
+
+/** dropt_freeze_context
+  *
+  *     Builds all of a dropt context's lookup tables eagerly and makes its
+  *     settings read-only.  A frozen context may be shared by multiple
+  *     threads through parse contexts (see `dropt_new_parse_context`).
+  *
+  *     The context's settings (e.g. its string comparison function and its
+  *     error handler) can't be changed after it's frozen, and it can't be
+  *     used for parsing directly.  Freezing a context clears its error.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *
+  * RETURNS:
+  *     An error code.  If the lookup tables couldn't be built, returns
+  *       `dropt_error_insufficient_memory`, and the context isn't frozen.
+  */
+dropt_error
+dropt_freeze_context(dropt_context* context)
+{
+    bool hasLongNames = false;
+    size_t i;
+
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return dropt_error_bad_configuration;
+    }
+
+    if (context->frozen) { return dropt_error_none; }
+
+    init_lookup_tables(context);
+
+    for (i = 0; i < context->numOptions; i++)
+    {
+        if (context_option(context, i)->long_name != NULL) { hasLongNames = true; }
+    }
+
+    if (   (hasLongNames && context->longIndex.lengths == NULL)
+        || (   context->numOptions != 0
+            && context->shortTable.slots == NULL
+            && context->sortedByShort == NULL))
+    {
+        return dropt_error_insufficient_memory;
+    }
+
+    clear_error_details(context);
+    context->frozen = true;
+    return dropt_error_none;
+}
+
+
+/** dropt_new_parse_context
+  *
+  *     Creates a lightweight dropt context for parsing with a frozen
+  *     context's options, settings, and lookup tables.  The lookup tables are
+  *     shared, not copied; the new context holds only per-parse state, such
+  *     as error details.
+  *
+  *     A frozen context is never modified by parsing through its parse
+  *     contexts, so multiple threads may parse concurrently, each with its
+  *     own parse context, without locking.  A parse context may be reused
+  *     for any number of calls to `dropt_parse`.
+  *
+  * PARAMETERS:
+  *     IN frozenContext : The frozen dropt context.
+  *                        Must not be `NULL`.
+  *                        Must outlive the new context.
+  *
+  * RETURNS:
+  *     An allocated dropt context.  The caller is responsible for freeing
+  *       it with `dropt_free_context` when no longer needed.
+  *     Returns `NULL` on error.
+  */
+dropt_context*
+dropt_new_parse_context(const dropt_context* frozenContext)
+{
+    dropt_context* context;
+    dropt_allocator allocator;
+
+    if (frozenContext == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return NULL;
+    }
+
+    if (!frozenContext->frozen)
+    {
+        DROPT_MISUSE("The dropt context must be frozen first.");
+        return NULL;
+    }
+
+    /* Parse contexts may be used concurrently, so they can't share an
+     * arena.
+     */
+    if (frozenContext->arena != NULL)
+    {
+        dropt_get_allocator(&allocator);
+    }
+    else
+    {
+        allocator = frozenContext->allocator;
+    }
+
+    context = dropt_allocator_realloc(&allocator, NULL, 1, sizeof *context);
+    if (context != NULL)
+    {
+        *context = *frozenContext;
+        context->allocator = allocator;
+        context->selfAllocator = allocator;
+        context->arena = NULL;
+        context->frozen = false;
+
+        context->errorDetails.err = dropt_error_none;
+        context->errorDetails.optionName = NULL;
+        context->errorDetails.optionArgument = NULL;
+        context->errorDetails.message = NULL;
+        context->errorDetails.argv = NULL;
+        context->errorDetails.candidates = NULL;
+        context->errorDetails.numCandidates = 0;
+
+        context->longIndex.borrowed = true;
+        context->longHash.borrowed = true;
+        context->shortTable.borrowed = true;
+        context->sortedByShortBorrowed = true;
+        context->foldedNamesBorrowed = true;
+        context->prefixTrie.borrowed = true;
+        context->subcommands.borrowed = true;
+
+        /* Parse contexts create their own subcommand contexts. */
+        context->subcommands.children = NULL;
+
+        context->tape = NULL;
+        context->tapeCapacity = 0;
+        context->tapeLength = 0;
+
+        context->responseFiles.args = NULL;
+        context->responseFiles.numArgs = 0;
+        context->responseFiles.argsCapacity = 0;
+        context->responseFiles.buffers = NULL;
+        context->responseFiles.numBuffers = 0;
+        context->responseFiles.buffersCapacity = 0;
+
+        context->incremental.active = false;
+        context->incremental.done = false;
+        context->incremental.pendingOption = NULL;
+        context->incremental.pendingArg = NULL;
+    }
+
+    return context;
+}
+
+
+/** free_subcommand_contexts
+  *
+  *     Frees the contexts created for a dropt context's subcommands.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  */
+static void
+free_subcommand_contexts(dropt_context* context)
+{
+    subcommand_registry* registry;
+
+    assert(context != NULL);
+
+    registry = &context->subcommands;
+    if (registry->children != NULL)
+    {
+        size_t i;
+        for (i = 0; i < registry->count; i++)
+        {
+            dropt_free_context(registry->children[i]);
+        }
+
+        dropt_allocator_free(&registry->allocator, registry->children);
+        registry->children = NULL;
+    }
+}
+
+
+/** dropt_free_context
+  *
+  *     Frees a dropt context.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context to free.
+  *                      May be `NULL`.
+  */
+void
+dropt_free_context(dropt_context* context)
+{
+    if (context != NULL)
+    {
+        dropt_allocator selfAllocator = context->selfAllocator;
+        context_arena* arena = context->arena;
+
+        clear_error_details(context);
+        free_subcommand_contexts(context);
+        free_lookup_tables(context);
+        free_response_files(context);
+        dropt_allocator_free(&selfAllocator, context);
+
+        if (arena != NULL && arena->owned) { dropt_free(arena->base); }
+    }
+}
+
+
+/** dropt_get_options
+  *
+  * PARAMETERS:
+  *     IN context : The dropt context.
+  *                  Must not be `NULL`.
+  *
+  * RETURNS:
+  *     The context's list of option specifications.
+  *     Returns `NULL` for a composite context (see
+  *       `dropt_new_composite_context`), which has no single list; use
+  *       `dropt_get_option` instead.
+  */
+const dropt_option*
+dropt_get_options(const dropt_context* context)
+{
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return NULL;
+    }
+
+    return context->options;
+}
+
+
+/** dropt_get_option
+  *
+  *     Gets an option by number, as recorded on result tapes (see
+  *     `dropt_tape_entry`).  A composite context (see
+  *     `dropt_new_composite_context`) numbers its parts' options in turn.
+  *     For a subcommand's context (see `dropt_get_subcommand_context`),
+  *     inherited options are numbered after the subcommand's own.
+  *
+  * PARAMETERS:
+  *     IN context : The dropt context.
+  *                  Must not be `NULL`.
+  *     IN index   : The option's number.
+  *
+  * RETURNS:
+  *     A pointer to the option specification, or `NULL` if there is no
+  *       option with that number.
+  */
+const dropt_option*
+dropt_get_option(const dropt_context* context, size_t index)
+{
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return NULL;
+    }
+
+    while (context != NULL && index >= context->numOptions)
+    {
+        index -= context->numOptions;
+        context = context->parent;
+    }
+
+    return (context == NULL) ? NULL : context_option(context, index);
+}
+
+
+/** dropt_set_subcommands
+  *
+  *     Registers subcommands with a dropt context, for command-lines of the
+  *     form `prog [global options] <subcommand> [subcommand options]`.
+  *     Parse the global options with the context; parsing stops at the
+  *     subcommand name, which can be resolved with `dropt_find_subcommand`.
+  *     Then parse the remaining arguments with the context that
+  *     `dropt_get_subcommand_context` returns for it.
+  *
+  *     The names are hashed along with the other lookup tables.  No
+  *     context is created for a subcommand until it's requested, so
+  *     registering many subcommands is cheap.
+  *
+  *     Replacing the subcommands frees any contexts created for the
+  *     previous ones.
+  *
+  * PARAMETERS:
+  *     IN/OUT context  : The dropt context.
+  *                       Must not be `NULL`.
+  *     IN subcommands  : The list of subcommands, terminated by an entry
+  *                         whose name is `NULL`.
+  *                       The list is *not* copied and must outlive the
+  *                         dropt context.
+  *                       Pass `NULL` to remove the subcommands.
+  */
+void
+dropt_set_subcommands(dropt_context* context,
+                      const dropt_subcommand* subcommands)
+{
+    size_t n = 0;
+
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return;
+    }
+
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
+    }
+
+    if (subcommands != NULL)
+    {
+        for (n = 0; subcommands[n].name != NULL; n++)
+        {
+            if (subcommands[n].options == NULL)
+            {
+                DROPT_MISUSE("No option list specified for a subcommand.");
+                return;
+            }
+        }
+    }
+
+    free_subcommand_contexts(context);
+    free_subcommand_hash(context, &context->subcommands);
+    context->subcommands.list = subcommands;
+    context->subcommands.count = n;
+}
+
+
+/** dropt_find_subcommand
+  *
+  *     Finds a subcommand registered with `dropt_set_subcommands` by name.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN name        : The subcommand name to search for.
+  *                      Must not be `NULL`.
+  *
+  * RETURNS:
+  *     A pointer to the corresponding subcommand or `NULL` if not found.
+  */
+const dropt_subcommand*
+dropt_find_subcommand(dropt_context* context, const dropt_char* name)
+{
+    const subcommand_registry* registry;
+    size_t i;
+
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return NULL;
+    }
+
+    if (name == NULL)
+    {
+        DROPT_MISUSE("No subcommand name specified.");
+        return NULL;
+    }
+
+    if (!context->frozen) { init_lookup_tables(context); }
+
+    registry = &context->subcommands;
+    if (registry->slots != NULL)
+    {
+        dropt_uint32 j = registry->slots[find_subcommand_slot(
+                             registry, make_char_array(name, dropt_strlen(name)))];
+        return (j == EMPTY_HASH_SLOT) ? NULL : &registry->list[j];
+    }
+
+    /* Fall back to a linear search. */
+    for (i = 0; i < registry->count; i++)
+    {
+        if (dropt_strcmp(registry->list[i].name, name) == 0)
+        {
+            return &registry->list[i];
+        }
+    }
+    return NULL;
+}
+
+
+/** dropt_get_subcommand_context
+  *
+  *     Gets the dropt context for a subcommand, creating it on first use.
+  *     The subcommand's context inherits the parent context's string
+  *     comparison function, error handler, and lookup and error-reporting
+  *     settings, which may then be changed independently.
+  *
+  *     Options that aren't in the subcommand's list are looked up in the
+  *     parent context (and then in its parent, and so on) using the
+  *     parent's lookup tables, so global options may also follow the
+  *     subcommand without being copied into each subcommand's list.
+  *
+  *     A frozen context can't create subcommand contexts; use a parse
+  *     context (see `dropt_new_parse_context`) instead.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN subcommand  : The subcommand, as returned by
+  *                        `dropt_find_subcommand`.
+  *                      Must be one of the context's subcommands.
+  *
+  * RETURNS:
+  *     The subcommand's dropt context.  It belongs to the parent context,
+  *       which frees it.
+  *     Returns `NULL` on error.
+  */
+dropt_context*
+dropt_get_subcommand_context(dropt_context* context,
+                             const dropt_subcommand* subcommand)
+{
+    subcommand_registry* registry;
+    dropt_context* child;
+    size_t i;
+    size_t j;
+
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return NULL;
+    }
+
+    registry = &context->subcommands;
+    if (   subcommand == NULL
+        || registry->list == NULL
+        || subcommand < registry->list
+        || subcommand >= registry->list + registry->count)
+    {
+        DROPT_MISUSE("The subcommand isn't registered with the dropt context.");
+        return NULL;
+    }
+
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return NULL;
+    }
+
+    i = (size_t) (subcommand - registry->list);
+    if (registry->children != NULL && registry->children[i] != NULL)
+    {
+        return registry->children[i];
+    }
+
+    if (registry->children == NULL)
+    {
+        /* Subcommand contexts outlive `dropt_reset_context`, so they can't
+         * live in an arena.
+         */
+        if (context->arena != NULL)
+        {
+            dropt_get_allocator(&registry->allocator);
+        }
+        else
+        {
+            registry->allocator = context->allocator;
+        }
+
+        registry->children = dropt_allocator_realloc(&registry->allocator,
+                                                     NULL, registry->count,
+                                                     sizeof *(registry->children));
+        if (registry->children == NULL) { return NULL; }
+
+        for (j = 0; j < registry->count; j++)
+        {
+            registry->children[j] = NULL;
+        }
+    }
+
+    child = new_context(subcommand->options, &registry->allocator);
+    if (child == NULL) { return NULL; }
+
+    child->parent = context;
+    child->ncmpstr = context->ncmpstr;
+    child->useHashedLookup = context->useHashedLookup;
+    child->allowAbbreviations = context->allowAbbreviations;
+    child->maxSuggestions = context->maxSuggestions;
+    child->allowConcatenatedArgs = context->allowConcatenatedArgs;
+    child->deferErrorDetails = context->deferErrorDetails;
+    child->errorHandler = context->errorHandler;
+    child->errorHandlerData = context->errorHandlerData;
+
+    /* The subcommand's context looks up inherited options with our
+     * tables.
+     */
+    init_lookup_tables(context);
+
+    registry->children[i] = child;
+    return child;
+}
+
+
+/** dropt_init_help_params
+  *
+  *     Initializes a `dropt_help_params` structure with the default values.
+  *
+  * PARAMETERS:
+  *     OUT helpParams : On output, set to the default help parameters.
+  *                      Must not be `NULL`.
+  */
+void
+dropt_init_help_params(dropt_help_params* helpParams)
+{
+    if (helpParams == NULL)
+    {
+        DROPT_MISUSE("No dropt help parameters specified.");
+        return;
+    }
+
+    helpParams->indent = default_help_indent;
+    helpParams->description_start_column = default_description_start_column;
+    helpParams->blank_lines_between_options = true;
+}
+
+
+/** dropt_set_error_handler
+  *
+  *     Sets the callback function used to generate error strings from error
+  *     codes.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN handler     : The error handler callback.
+  *                      Pass `NULL` to use the default error handler.
+  *     IN handlerData : Caller-defined callback data.
+  */
+void
+dropt_set_error_handler(dropt_context* context,
+                        dropt_error_handler_func handler,
+                        void* handlerData)
+{
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return;
+    }
+
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
+    }
+
+    context->errorHandler = handler;
+    context->errorHandlerData = handlerData;
+}
+
+
+/** dropt_set_strncmp
+  *
+  *     Sets the callback function used to compare strings.
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN cmp         : The string comparison function.
+  *                      Pass `NULL` to use the default string comparison
+  *                        function.
+  */
+void
+dropt_set_strncmp(dropt_context* context, dropt_strncmp_func cmp)
+{
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return;
+    }
+
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
+    }
+
+    if (cmp == NULL) { cmp = dropt_strncmp; }
+    context->ncmpstr = cmp;
+
+    /* Changing the sort method invalidates our existing lookup tables. */
+    free_lookup_tables(context);
+}
+
+
+/** dropt_set_case_insensitive
+  *
+  *     Specifies whether option names should be matched without regard to
+  *     the case of ASCII letters, so that "--Verbose" matches an option
+  *     named "verbose" and "-Q" matches an option named 'q'.  Unlike
+  *     installing `dropt_strnicmp` with `dropt_set_strncmp`, this folds the
+  *     option names once when the lookup tables are built and each parsed
+  *     name once per lookup, so the hashed and direct lookup tables remain
+  *     available.
+  *
+  *     Folding is locale-independent.  Non-ASCII characters must match
+  *     exactly.
+  *
+  *     Setting a string comparison function with `dropt_set_strncmp`
+  *     disables case-insensitive matching.
+  *
+  *     (Matching is case-sensitive by default.)
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN enable      : Pass 1 to ignore case, 0 otherwise.
+  */
+void
+dropt_set_case_insensitive(dropt_context* context, dropt_bool enable)
+{
+    dropt_set_strncmp(context, enable ? fold_strncmp : NULL);
 }
 
 
-/** dropt_parse
+/** dropt_allow_abbreviations
   *
-  *     Parses command-line options.
+  *     Specifies whether long options may be abbreviated to any unambiguous
+  *     prefix of their names, so that "--verb" matches "--verbose" unless
+  *     another long name also begins with "verb".  An exact match always
+  *     takes precedence.  An ambiguous abbreviation fails with
+  *     `dropt_error_ambiguous_option`, and the options that it could refer
+  *     to can be retrieved with `dropt_get_error_candidates`.
+  *
+  *     Abbreviations are resolved with a trie built along with the other
+  *     lookup tables, in time proportional to the length of the
+  *     abbreviation.  Contexts with a custom `dropt_strncmp_func` binary
+  *     search the sorted lookup tables instead.
+  *
+  *     (Abbreviations are disabled by default.)
   *
   * PARAMETERS:
   *     IN/OUT context : The dropt context.
   *                      Must not be `NULL`.
-  *     IN argc        : The maximum number of arguments to parse from argv.
-  *                      Pass -1 to parse all arguments up to a `NULL` sentinel
-  *                        value.
-  *     IN argv        : The list of command-line arguments, not including the
-  *                        initial program name.
-  *
-  * RETURNS:
-  *     A pointer to the first unprocessed element in `argv`.
+  *     IN allow       : Pass 1 to allow abbreviations, 0 otherwise.
   */
-dropt_char**
-dropt_parse(dropt_context* context,
-            int argc, dropt_char** argv)
+void
+dropt_allow_abbreviations(dropt_context* context, dropt_bool allow)
 {
-    dropt_char* arg;
-    parse_state ps;
-
-    ps.option = NULL;
-    ps.optionArgument = NULL;
-    ps.argNext = argv;
-
-    if (argv == NULL)
-    {
-        /* Nothing to do. */
-        goto exit;
-    }
-
     if (context == NULL)
     {
         DROPT_MISUSE("No dropt context specified.");
-        set_error_details(context, dropt_error_bad_configuration,
-                          make_char_array(DROPT_TEXT_LITERAL(""), 0),
-                          NULL);
-        goto exit;
+        return;
     }
 
-#ifdef DROPT_NO_STRING_BUFFERS
-    if (context->errorHandler == NULL)
+    if (context->frozen)
     {
-        DROPT_MISUSE("No error handler specified.");
-        set_error_details(context, dropt_error_bad_configuration,
-                          make_char_array(DROPT_TEXT_LITERAL(""), 0),
-                          NULL);
-        goto exit;
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
     }
-#endif
 
-    if (argc == -1)
+    if (context->allowAbbreviations != (allow != 0))
     {
-        argc = 0;
-        while (argv[argc] != NULL) { argc++; }
+        context->allowAbbreviations = (allow != 0);
+        free_lookup_tables(context);
     }
+}
+
 
-    if (argc == 0)
+/** dropt_enable_suggestions
+  *
+  *     Specifies how many long option names to suggest when a long option
+  *     is invalid.  The suggestions are the names closest to the mistyped
+  *     one by edit distance, closest first, and can be retrieved with
+  *     `dropt_get_error_candidates`.  Only names within a few edits are
+  *     suggested, and hidden options are never suggested.
+  *
+  *     Mistyped names longer than 64 characters (32 characters for
+  *     compilers without 64-bit integers) don't get suggestions.
+  *
+  *     (Suggestions are disabled by default.)
+  *
+  * PARAMETERS:
+  *     IN/OUT context     : The dropt context.
+  *                          Must not be `NULL`.
+  *     IN maxSuggestions  : The most suggestions to make, up to 8.
+  *                          Pass 0 to disable suggestions.
+  */
+void
+dropt_enable_suggestions(dropt_context* context, unsigned int maxSuggestions)
+{
+    if (context == NULL)
     {
-        /* Nothing to do. */
-        goto exit;
+        DROPT_MISUSE("No dropt context specified.");
+        return;
     }
 
-    init_lookup_tables(context);
-
-    ps.argsLeft = argc;
-
-    while (   ps.argsLeft-- > 0
-           && (arg = *ps.argNext) != NULL
-           && arg[0] == DROPT_TEXT_LITERAL('-'))
+    if (context->frozen)
     {
-        if (arg[1] == DROPT_TEXT_LITERAL('\0'))
-        {
-            /* - */
-
-            /* This intentionally leaves "-" unprocessed for the caller to
-             * deal with.  This allows construction of programs that treat
-             * "-" to mean `stdin`.
-             */
-            goto exit;
-        }
-
-        ps.argNext++;
-
-        if (arg[1] == DROPT_TEXT_LITERAL('-'))
-        {
-            if (!parse_long_option(context, &ps, arg)) { goto exit; }
-        }
-        else
-        {
-            /* Short name. (-x) */
-            if (!parse_short_option(context, &ps, arg)) { goto exit; }
-        }
-
-        ps.option = NULL;
-        ps.optionArgument = NULL;
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
     }
 
-exit:
-    return ps.argNext;
+    context->maxSuggestions = MIN(maxSuggestions, max_suggestions);
 }
 
 
-/** dropt_new_context
+/** dropt_enable_hashed_lookup
   *
-  *     Creates a new dropt context.
+  *     Specifies whether long options should be looked up with a perfect hash
+  *     instead of with a binary search.  The hash is built along with the
+  *     other lookup tables and costs a little more to construct, but it is
+  *     faster for large option tables.
   *
-  * PARAMETERS:
-  *     IN options : The list of option specifications.
-  *                  Must not be `NULL`.
-  *                  The list is *not* copied and must outlive the dropt
-  *                    context.
+  *     The hash is used only with the default string comparison function;
+  *     contexts with a custom `dropt_strncmp_func` always use the sorted
+  *     lookup tables.
   *
-  * RETURNS:
-  *     An allocated dropt context.  The caller is responsible for freeing
-  *       it with `dropt_free_context` when no longer needed.
-  *     Returns `NULL` on error.
+  *     (Hashed lookup is disabled by default.)
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN enable      : Pass 1 to use hashed lookup, 0 otherwise.
   */
-dropt_context*
-dropt_new_context(const dropt_option* options)
+void
+dropt_enable_hashed_lookup(dropt_context* context, dropt_bool enable)
 {
-    dropt_context* context = NULL;
-    size_t n;
-
-    if (options == NULL)
+    if (context == NULL)
     {
-        DROPT_MISUSE("No option list specified.");
-        goto exit;
+        DROPT_MISUSE("No dropt context specified.");
+        return;
     }
 
-    /* Sanity-check the options. */
-    for (n = 0; is_valid_option(&options[n]); n++)
+    if (context->frozen)
     {
-        if (   options[n].short_name == DROPT_TEXT_LITERAL('=')
-            || (   options[n].long_name != NULL
-                && dropt_strchr(options[n].long_name, DROPT_TEXT_LITERAL('=')) != NULL))
-        {
-            DROPT_MISUSE("Invalid option list. '=' may not be used in an option name.");
-            goto exit;
-        }
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
     }
 
-    context = malloc(sizeof *context);
-    if (context == NULL)
-    {
-        goto exit;
-    }
-    else
+    if (context->useHashedLookup != (enable != 0))
     {
-        dropt_context emptyContext = { 0 };
-        *context = emptyContext;
-
-        context->options = options;
-        context->numOptions = n;
-        dropt_set_strncmp(context, NULL);
+        context->useHashedLookup = (enable != 0);
+        free_lookup_tables(context);
     }
-
-exit:
-    return context;
 }
 
 
-/** dropt_free_context
+/** dropt_defer_error_details
   *
-  *     Frees a dropt context.
+  *     Specifies whether parsing errors should record only the location of
+  *     the failing argument (see `dropt_get_error_location`) instead of
+  *     copying the option name and argument.  Deferred error details don't
+  *     allocate memory; they are copied only if they are retrieved with
+  *     `dropt_get_error_details` or `dropt_get_error_message`, which
+  *     requires that the parsed argument list still be valid.
+  *
+  *     (Error details are not deferred by default.)
   *
   * PARAMETERS:
-  *     IN/OUT context : The dropt context to free.
-  *                      May be `NULL`.
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN defer       : Pass 1 to defer error details, 0 otherwise.
   */
 void
-dropt_free_context(dropt_context* context)
+dropt_defer_error_details(dropt_context* context, dropt_bool defer)
 {
-    dropt_clear_error(context);
-    free_lookup_tables(context);
-    free(context);
+    if (context == NULL)
+    {
+        DROPT_MISUSE("No dropt context specified.");
+        return;
+    }
+
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
+    }
+
+    context->deferErrorDetails = (defer != 0);
 }
 
 
-/** dropt_get_options
+/** dropt_enable_response_files
   *
-  * PARAMETERS:
-  *     IN context : The dropt context.
-  *                  Must not be `NULL`.
+  *     Specifies whether `dropt_parse` should expand response files.  An
+  *     argument of the form "@FILE" is replaced with the arguments read
+  *     from FILE, which may name further response files.  Arguments that
+  *     name files that can't be read are left as-is.
   *
-  * RETURNS:
-  *     The context's list of option specifications.
+  *     Where possible, response files are memory-mapped and split into
+  *     arguments in place, without copying them.
+  *
+  *     (Response files are not expanded by default.)
+  *
+  * PARAMETERS:
+  *     IN/OUT context : The dropt context.
+  *                      Must not be `NULL`.
+  *     IN syntax      : The rules for splitting response files into
+  *                        arguments.
+  *                      Pass `dropt_quoting_none` to disable
+  *                        expansion.
+  *     IN maxDepth    : How deeply response files may be nested.  1 allows
+  *                        response files only in the original argument
+  *                        list.  Exceeding the limit fails with
+  *                        `dropt_error_response_file_depth`.
+  *                      Pass 0 to use `DROPT_RESPONSE_FILE_MAX_DEPTH`.
   */
-const dropt_option*
-dropt_get_options(const dropt_context* context)
+void
+dropt_enable_response_files(dropt_context* context,
+                            dropt_quoting syntax,
+                            unsigned int maxDepth)
 {
     if (context == NULL)
     {
         DROPT_MISUSE("No dropt context specified.");
-        return NULL;
+        return;
     }
 
-    return context->options;
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
+    }
+
+    if (   syntax != dropt_quoting_none
+        && syntax != dropt_quoting_gnu
+        && syntax != dropt_quoting_posix
+        && syntax != dropt_quoting_msvc)
+    {
+        DROPT_MISUSE("Invalid response file syntax.");
+        return;
+    }
+
+    context->responseFiles.syntax = syntax;
+    context->responseFiles.maxDepth = (maxDepth == 0)
+                                      ? DROPT_RESPONSE_FILE_MAX_DEPTH
+                                      : maxDepth;
 }
 
 
-/** dropt_init_help_params
+/** dropt_set_context_allocator
   *
-  *     Initializes a `dropt_help_params` structure with the default values.
+  *     Sets the allocator for a dropt context's lookup tables and error
+  *     details.  By default, a context uses the global allocator that was
+  *     in effect when it was created (see `dropt_set_allocator`).
+  *
+  *     Memory that dropt returns to the caller and error messages always use
+  *     the global allocator.
   *
   * PARAMETERS:
-  *     OUT helpParams : On output, set to the default help parameters.
+  *     IN/OUT context : The dropt context.
   *                      Must not be `NULL`.
+  *     IN allocator   : The allocator to use.  It is copied.
+  *                      Pass `NULL` to use the current global allocator.
   */
 void
-dropt_init_help_params(dropt_help_params* helpParams)
+dropt_set_context_allocator(dropt_context* context,
+                            const dropt_allocator* allocator)
 {
-    if (helpParams == NULL)
+    if (context == NULL)
     {
-        DROPT_MISUSE("No dropt help parameters specified.");
+        DROPT_MISUSE("No dropt context specified.");
         return;
     }
 
-    helpParams->indent = default_help_indent;
-    helpParams->description_start_column = default_description_start_column;
-    helpParams->blank_lines_between_options = true;
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
+    }
+
+    if (context->arena != NULL)
+    {
+        DROPT_MISUSE("An arena-based context's allocator can't be changed.");
+        return;
+    }
+
+    if (allocator != NULL && (allocator->reallocate == NULL
+                              || allocator->deallocate == NULL))
+    {
+        DROPT_MISUSE("Incomplete allocator specified.");
+        return;
+    }
+
+    /* Release everything allocated with the old allocator. */
+    clear_error_details(context);
+    free_lookup_tables(context);
+
+    if (allocator == NULL)
+    {
+        dropt_get_allocator(&context->allocator);
+    }
+    else
+    {
+        context->allocator = *allocator;
+    }
 }
 
 
-/** dropt_set_error_handler
+/** dropt_set_result_tape
   *
-  *     Sets the callback function used to generate error strings from error
-  *     codes.
+  *     Makes `dropt_parse` record matched options to a caller-provided tape
+  *     instead of invoking their handlers.  Recording performs no
+  *     allocations and calls no handlers; the caller may look up, skip, or
+  *     convert the recorded arguments later.
+  *
+  *     Records are appended across calls to `dropt_parse`.  Call this
+  *     function again to rewind the tape.  If the tape fills up, parsing
+  *     stops with `dropt_error_insufficient_memory`.
+  *
+  *     An option's argument is recorded the same way that it would be
+  *     passed to its handler, except that an optional argument is recorded
+  *     only if it's specified with '=' or concatenated with its short
+  *     option.
+  *
+  *     A frozen context can't have a tape, since its parse contexts would
+  *     share it.  Give each parse context its own tape instead.
   *
   * PARAMETERS:
   *     IN/OUT context : The dropt context.
   *                      Must not be `NULL`.
-  *     IN handler     : The error handler callback.
-  *                      Pass `NULL` to use the default error handler.
-  *     IN handlerData : Caller-defined callback data.
+  *     IN tape        : The tape to record to.
+  *                      Pass `NULL` to restore normal handler invocation.
+  *                      Must outlive its use by the dropt context.
+  *     IN capacity    : The number of entries that `tape` can hold.
   */
 void
-dropt_set_error_handler(dropt_context* context,
-                        dropt_error_handler_func handler,
-                        void* handlerData)
+dropt_set_result_tape(dropt_context* context,
+                      dropt_tape_entry* tape, size_t capacity)
 {
     if (context == NULL)
     {
@@ -1539,36 +8059,38 @@ dropt_set_error_handler(dropt_context* context,
         return;
     }
 
-    context->errorHandler = handler;
-    context->errorHandlerData = handlerData;
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
+    }
+
+    context->tape = tape;
+    context->tapeCapacity = (tape == NULL) ? 0 : capacity;
+    context->tapeLength = 0;
 }
 
 
-/** dropt_set_strncmp
-  *
-  *     Sets the callback function used to compare strings.
+/** dropt_get_tape_length
   *
   * PARAMETERS:
-  *     IN/OUT context : The dropt context.
-  *                      Must not be `NULL`.
-  *     IN cmp         : The string comparison function.
-  *                      Pass `NULL` to use the default string comparison
-  *                        function.
+  *     IN context : The dropt context.
+  *                  Must not be `NULL`.
+  *
+  * RETURNS:
+  *     The number of entries recorded to the context's result tape (see
+  *       `dropt_set_result_tape`).
   */
-void
-dropt_set_strncmp(dropt_context* context, dropt_strncmp_func cmp)
+size_t
+dropt_get_tape_length(const dropt_context* context)
 {
     if (context == NULL)
     {
         DROPT_MISUSE("No dropt context specified.");
-        return;
+        return 0;
     }
 
-    if (cmp == NULL) { cmp = dropt_strncmp; }
-    context->ncmpstr = cmp;
-
-    /* Changing the sort method invalidates our existing lookup tables. */
-    free_lookup_tables(context);
+    return context->tapeLength;
 }
 
 
@@ -1593,6 +8115,12 @@ dropt_allow_concatenated_arguments(dropt_context* context, dropt_bool allow)
         return;
     }
 
+    if (context->frozen)
+    {
+        DROPT_MISUSE("The dropt context is frozen.");
+        return;
+    }
+
     context->allowConcatenatedArgs = (allow != 0);
 }
 
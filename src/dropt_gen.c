@@ -0,0 +1,893 @@
+/** dropt_gen.c
+  *
+  * Compiles a declarative option specification into C source code that
+  * defines a `dropt_option` table along with its precomputed lookup index.
+  * Contexts created from the generated code don't need to sort their
+  * options or to allocate lookup tables at run-time.
+  *
+  * Copyright (C) 2006-2018 James D. Lin <jamesdlin@berkeley.edu>
+  *
+  * The latest version of this file can be downloaded from:
+  * <http://www.taenarum.com/software/dropt/>
+  *
+  * This software is provided 'as-is', without any express or implied
+  * warranty.  In no event will the authors be held liable for any damages
+  * arising from the use of this software.
+  *
+  * Permission is granted to anyone to use this software for any purpose,
+  * including commercial applications, and to alter it and redistribute it
+  * freely, subject to the following restrictions:
+  *
+  * 1. The origin of this software must not be misrepresented; you must not
+  *    claim that you wrote the original software. If you use this software
+  *    in a product, an acknowledgment in the product documentation would be
+  *    appreciated but is not required.
+  *
+  * 2. Altered source versions must be plainly marked as such, and must not be
+  *    misrepresented as being the original software.
+  *
+  * 3. This notice may not be removed or altered from any source distribution.
+  */
+
+/* Usage: dropt_gen SPEC_FILE OUTPUT_C_FILE OUTPUT_H_FILE
+ *
+ * The specification is a line-oriented text file.  Blank lines and lines
+ * starting with '#' are ignored.  Other lines are either directives or
+ * options:
+ *
+ *     name IDENTIFIER
+ *         Required.  The name of the generated option table.  The generated
+ *         code also defines `IDENTIFIER_new_context()`, and
+ *         `IDENTIFIER_get_index()` to get the serialized lookup index (see
+ *         `dropt_new_context_from_index`).
+ *
+ *     include <header.h>
+ *     include "header.h"
+ *         Adds an `#include` directive to the generated source (e.g. for
+ *         the declarations of handlers and destination variables).
+ *
+ *     hashed
+ *         Enables hashed lookup of long options (see
+ *         `dropt_enable_hashed_lookup`).
+ *
+ * An option line consists of whitespace-separated fields, in any order:
+ *
+ *     -x                         The short name.
+ *     --name                     The long name.
+ *     description="TEXT"         The help text.
+ *     arg_description="TEXT"     The description of the option's argument.
+ *     handler=EXPRESSION         The handler callback.
+ *     dest=EXPRESSION            The address of the handler's destination.
+ *     attr=EXPRESSION            The option's attributes.
+ *     extra_data=EXPRESSION      Additional data for the handler.
+ *
+ * Quoted text is emitted verbatim as a C string literal, so it may use C
+ * escape sequences.  Expressions are emitted verbatim and may not contain
+ * whitespace.  For example:
+ *
+ *     name my_options
+ *     include "my_options_data.h"
+ *     description="Main options:"
+ *     -h --help description="Shows help." handler=dropt_handle_bool dest=&showHelp attr=dropt_attr_halt
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "dropt.h"
+#include "dropt_string.h"
+
+#if __STDC_VERSION__ >= 199901L
+    #include <stdint.h>
+    #include <stdbool.h>
+
+    typedef uint32_t dropt_uint32;
+#else
+    typedef enum { false, true } bool;
+
+    /* Assume that `unsigned int` is 32 bits wide. */
+    typedef unsigned int dropt_uint32;
+#endif
+
+
+enum
+{
+    max_line_length = 4096,
+    max_fields = 16
+};
+
+
+/** The parsed form of an option line.  Names are stored as they appeared
+  * in the specification; everything else is stored as C source text.
+  */
+typedef struct
+{
+    char shortName;
+    char* longName;
+    char* description;
+    char* argDescription;
+    char* handler;
+    char* dest;
+    char* attr;
+    char* extraData;
+} option_spec;
+
+
+typedef struct
+{
+    const char* fileName;
+    char* name;
+
+    char** includes;
+    size_t numIncludes;
+
+    bool hashed;
+
+    option_spec* options;
+    size_t numOptions;
+} table_spec;
+
+
+/** dummy_handler
+  *
+  *     A placeholder handler for the options used to build the lookup index.
+  *     It's never called.
+  */
+static dropt_error
+dummy_handler(dropt_context* context, const dropt_option* option,
+              const dropt_char* optionArgument, void* dest)
+{
+    (void) context;
+    (void) option;
+    (void) optionArgument;
+    (void) dest;
+    return dropt_error_none;
+}
+
+
+/** duplicate_string
+  *
+  * PARAMETERS:
+  *     IN s   : The string to copy.  Might not be `NUL`-terminated.
+  *     IN len : The number of characters to copy.
+  *
+  * RETURNS:
+  *     An allocated, `NUL`-terminated copy of the string.  The program
+  *       exits if memory is exhausted.
+  */
+static char*
+duplicate_string(const char* s, size_t len)
+{
+    char* copy = malloc(len + 1);
+    if (copy == NULL)
+    {
+        fprintf(stderr, "dropt_gen: Insufficient memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+
+/** spec_error
+  *
+  *     Reports an error in the specification file and exits.
+  *
+  * PARAMETERS:
+  *     IN spec    : The table specification.
+  *     IN line    : The line number of the error.
+  *     IN message : The error message.
+  */
+static void
+spec_error(const table_spec* spec, unsigned long line, const char* message)
+{
+    fprintf(stderr, "%s:%lu: %s\n", spec->fileName, line, message);
+    exit(EXIT_FAILURE);
+}
+
+
+/** split_fields
+  *
+  *     Splits a line into whitespace-separated fields.  Whitespace between
+  *     double quotes doesn't separate fields.
+  *
+  * PARAMETERS:
+  *     IN/OUT line   : The line to split.  `NUL`-terminators are written
+  *                       into it.
+  *     OUT fields    : On output, the fields.
+  *     IN maxFields  : The capacity of `fields`.
+  *
+  * RETURNS:
+  *     The number of fields, or `(size_t) -1` if the line is malformed.
+  */
+static size_t
+split_fields(char* line, char** fields, size_t maxFields)
+{
+    size_t n = 0;
+    char* p = line;
+
+    for (;;)
+    {
+        bool quoted = false;
+
+        while (isspace((unsigned char) *p)) { p++; }
+        if (*p == '\0') { break; }
+
+        if (n == maxFields) { return (size_t) -1; }
+        fields[n++] = p;
+
+        while (*p != '\0' && (quoted || !isspace((unsigned char) *p)))
+        {
+            if (*p == '\\' && quoted && p[1] != '\0')
+            {
+                p++;
+            }
+            else if (*p == '"')
+            {
+                quoted = !quoted;
+            }
+            p++;
+        }
+
+        if (quoted) { return (size_t) -1; }
+
+        if (*p != '\0') { *p++ = '\0'; }
+    }
+
+    return n;
+}
+
+
+/** is_valid_name
+  *
+  * PARAMETERS:
+  *     IN s : The name from the specification.
+  *
+  * RETURNS:
+  *     true if `s` may be used in an option name.  Names are restricted to
+  *       printable ASCII characters that don't need escaping.
+  */
+static bool
+is_valid_name(const char* s)
+{
+    for (; *s != '\0'; s++)
+    {
+        if (   !isgraph((unsigned char) *s)
+            || (unsigned char) *s > 0x7F
+            || *s == '=' || *s == '"' || *s == '\'' || *s == '\\')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/** parse_option_line
+  *
+  *     Parses the fields of an option line.
+  *
+  * PARAMETERS:
+  *     IN spec       : The table specification.
+  *     IN lineNumber : The line number, for error messages.
+  *     IN fields     : The fields of the line.
+  *     IN numFields  : The number of fields.
+  *     OUT option    : On output, the parsed option.
+  */
+static void
+parse_option_line(const table_spec* spec, unsigned long lineNumber,
+                  char** fields, size_t numFields, option_spec* option)
+{
+    option_spec emptyOption = { 0 };
+    size_t i;
+
+    *option = emptyOption;
+
+    for (i = 0; i < numFields; i++)
+    {
+        char* field = fields[i];
+        char* value = strchr(field, '=');
+        char** dest = NULL;
+        bool quoted = false;
+
+        if (field[0] == '-' && field[1] == '-')
+        {
+            if (option->longName != NULL)
+            {
+                spec_error(spec, lineNumber, "Multiple long names.");
+            }
+            if (field[2] == '\0' || !is_valid_name(&field[2]))
+            {
+                spec_error(spec, lineNumber, "Invalid long name.");
+            }
+            option->longName = duplicate_string(&field[2], strlen(&field[2]));
+            continue;
+        }
+        else if (field[0] == '-')
+        {
+            if (option->shortName != '\0')
+            {
+                spec_error(spec, lineNumber, "Multiple short names.");
+            }
+            if (field[1] == '\0' || field[2] != '\0' || !is_valid_name(&field[1]))
+            {
+                spec_error(spec, lineNumber, "Invalid short name.");
+            }
+            option->shortName = field[1];
+            continue;
+        }
+
+        if (value == NULL || value == field)
+        {
+            spec_error(spec, lineNumber, "Expected a field of the form KEY=VALUE.");
+        }
+        *value++ = '\0';
+
+        if (strcmp(field, "description") == 0)
+        {
+            dest = &option->description;
+            quoted = true;
+        }
+        else if (strcmp(field, "arg_description") == 0)
+        {
+            dest = &option->argDescription;
+            quoted = true;
+        }
+        else if (strcmp(field, "handler") == 0)
+        {
+            dest = &option->handler;
+        }
+        else if (strcmp(field, "dest") == 0)
+        {
+            dest = &option->dest;
+        }
+        else if (strcmp(field, "attr") == 0)
+        {
+            dest = &option->attr;
+        }
+        else if (strcmp(field, "extra_data") == 0)
+        {
+            dest = &option->extraData;
+        }
+        else
+        {
+            spec_error(spec, lineNumber, "Unknown field.");
+        }
+
+        if (*dest != NULL)
+        {
+            spec_error(spec, lineNumber, "Duplicate field.");
+        }
+
+        if (quoted)
+        {
+            size_t len = strlen(value);
+            if (len < 2 || value[0] != '"' || value[len - 1] != '"')
+            {
+                spec_error(spec, lineNumber, "Expected a quoted string.");
+            }
+        }
+        else if (value[0] == '\0' || strchr(value, '"') != NULL)
+        {
+            spec_error(spec, lineNumber, "Invalid expression.");
+        }
+
+        *dest = duplicate_string(value, strlen(value));
+    }
+
+    if (   option->shortName == '\0'
+        && option->longName == NULL
+        && option->description == NULL)
+    {
+        spec_error(spec, lineNumber,
+                   "Options must have a name or a description.");
+    }
+
+    if (   (option->shortName != '\0' || option->longName != NULL)
+        && option->handler == NULL)
+    {
+        spec_error(spec, lineNumber, "Options with names must have a handler.");
+    }
+}
+
+
+/** read_spec
+  *
+  *     Reads a table specification from a file.
+  *
+  * PARAMETERS:
+  *     IN fileName : The name of the specification file.
+  *     OUT spec    : On output, the table specification.
+  *
+  * RETURNS:
+  *     true on success, false if the file couldn't be read.  The program
+  *       exits if the specification is malformed.
+  */
+static bool
+read_spec(const char* fileName, table_spec* spec)
+{
+    static char line[max_line_length];
+
+    table_spec emptySpec = { 0 };
+    unsigned long lineNumber = 0;
+    FILE* f = fopen(fileName, "r");
+    if (f == NULL) { return false; }
+
+    *spec = emptySpec;
+    spec->fileName = fileName;
+
+    while (fgets(line, sizeof line, f) != NULL)
+    {
+        char* fields[max_fields];
+        size_t numFields;
+
+        const char* p = line;
+
+        lineNumber++;
+
+        if (strchr(line, '\n') == NULL && !feof(f))
+        {
+            spec_error(spec, lineNumber, "Line too long.");
+        }
+
+        while (isspace((unsigned char) *p)) { p++; }
+        if (*p == '#') { continue; }
+
+        numFields = split_fields(line, fields, max_fields);
+        if (numFields == (size_t) -1)
+        {
+            spec_error(spec, lineNumber, "Malformed line.");
+        }
+
+        if (numFields == 0)
+        {
+            continue;
+        }
+        else if (strcmp(fields[0], "name") == 0)
+        {
+            size_t i;
+            if (numFields != 2 || spec->name != NULL)
+            {
+                spec_error(spec, lineNumber, "Expected a single table name.");
+            }
+            for (i = 0; fields[1][i] != '\0'; i++)
+            {
+                if (   !(isalnum((unsigned char) fields[1][i]) || fields[1][i] == '_')
+                    || (i == 0 && isdigit((unsigned char) fields[1][i])))
+                {
+                    spec_error(spec, lineNumber, "Invalid table name.");
+                }
+            }
+            spec->name = duplicate_string(fields[1], strlen(fields[1]));
+        }
+        else if (strcmp(fields[0], "include") == 0)
+        {
+            char** includes;
+            if (numFields != 2)
+            {
+                spec_error(spec, lineNumber, "Expected a single header.");
+            }
+
+            includes = dropt_safe_realloc(spec->includes,
+                                          spec->numIncludes + 1,
+                                          sizeof *includes);
+            if (includes == NULL) { spec_error(spec, lineNumber, "Insufficient memory."); }
+            spec->includes = includes;
+            spec->includes[spec->numIncludes++]
+                = duplicate_string(fields[1], strlen(fields[1]));
+        }
+        else if (strcmp(fields[0], "hashed") == 0)
+        {
+            if (numFields != 1)
+            {
+                spec_error(spec, lineNumber, "Unexpected arguments.");
+            }
+            spec->hashed = true;
+        }
+        else
+        {
+            option_spec* options = dropt_safe_realloc(spec->options,
+                                                      spec->numOptions + 1,
+                                                      sizeof *options);
+            if (options == NULL) { spec_error(spec, lineNumber, "Insufficient memory."); }
+            spec->options = options;
+            parse_option_line(spec, lineNumber, fields, numFields,
+                              &spec->options[spec->numOptions++]);
+        }
+    }
+
+    fclose(f);
+
+    if (spec->name == NULL)
+    {
+        spec_error(spec, lineNumber, "No table name specified.");
+    }
+
+    return true;
+}
+
+
+/** free_spec
+  *
+  *     Frees the memory used by a table specification.
+  *
+  * PARAMETERS:
+  *     IN/OUT spec : The table specification.
+  */
+static void
+free_spec(table_spec* spec)
+{
+    size_t i;
+
+    free(spec->name);
+    spec->name = NULL;
+
+    for (i = 0; i < spec->numIncludes; i++) { free(spec->includes[i]); }
+    dropt_free(spec->includes);
+    spec->includes = NULL;
+    spec->numIncludes = 0;
+
+    for (i = 0; i < spec->numOptions; i++)
+    {
+        option_spec* option = &spec->options[i];
+        free(option->longName);
+        free(option->description);
+        free(option->argDescription);
+        free(option->handler);
+        free(option->dest);
+        free(option->attr);
+        free(option->extraData);
+    }
+    dropt_free(spec->options);
+    spec->options = NULL;
+    spec->numOptions = 0;
+}
+
+
+/** to_dropt_string
+  *
+  * PARAMETERS:
+  *     IN s : An ASCII string.
+  *
+  * RETURNS:
+  *     An allocated copy of `s` as a `dropt_char` string.  The program exits
+  *       if memory is exhausted.
+  */
+static dropt_char*
+to_dropt_string(const char* s)
+{
+    size_t len = strlen(s);
+    size_t i;
+    dropt_char* copy = dropt_safe_malloc(len + 1, sizeof *copy);
+    if (copy == NULL)
+    {
+        fprintf(stderr, "dropt_gen: Insufficient memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i <= len; i++)
+    {
+        copy[i] = (dropt_char) s[i];
+    }
+    return copy;
+}
+
+
+/** build_index
+  *
+  *     Builds and serializes the lookup index for the specified options.
+  *
+  * PARAMETERS:
+  *     IN spec       : The table specification.
+  *     OUT indexSize : On output, the size of the index, in bytes.
+  *
+  * RETURNS:
+  *     The allocated index, or `NULL` on error.
+  */
+static void*
+build_index(const table_spec* spec, size_t* indexSize)
+{
+    static const dropt_char placeholder[] = DROPT_TEXT_LITERAL("");
+
+    void* index = NULL;
+    dropt_context* context = NULL;
+    size_t i;
+
+    dropt_option* options = dropt_safe_malloc(spec->numOptions + 1,
+                                              sizeof *options);
+    if (options == NULL) { goto exit; }
+
+    memset(options, 0, (spec->numOptions + 1) * sizeof *options);
+
+    /* Only the names (and the number of options) matter to the index.  Give
+     * every option a description so that none of them look like the
+     * sentinel.
+     */
+    for (i = 0; i < spec->numOptions; i++)
+    {
+        options[i].short_name = (dropt_char) spec->options[i].shortName;
+        options[i].long_name = (spec->options[i].longName == NULL)
+                               ? NULL
+                               : to_dropt_string(spec->options[i].longName);
+        options[i].description = placeholder;
+        options[i].handler = dummy_handler;
+    }
+
+    context = dropt_new_context(options);
+    if (context == NULL) { goto exit; }
+
+    dropt_enable_hashed_lookup(context, spec->hashed);
+
+    *indexSize = dropt_serialize_index(context, NULL, 0);
+    if (*indexSize == 0) { goto exit; }
+
+    index = malloc(*indexSize);
+    if (   index != NULL
+        && dropt_serialize_index(context, index, *indexSize) != *indexSize)
+    {
+        free(index);
+        index = NULL;
+    }
+
+exit:
+    dropt_free_context(context);
+    if (options != NULL)
+    {
+        for (i = 0; i < spec->numOptions; i++)
+        {
+            dropt_free((dropt_char*) options[i].long_name);
+        }
+        dropt_free(options);
+    }
+    return index;
+}
+
+
+/** base_name
+  *
+  * RETURNS:
+  *     The file name component of a path.
+  */
+static const char*
+base_name(const char* path)
+{
+    const char* p = strrchr(path, '/');
+#ifdef _WIN32
+    const char* q = strrchr(path, '\\');
+    if (q != NULL && (p == NULL || q > p)) { p = q; }
+#endif
+    return (p == NULL) ? path : p + 1;
+}
+
+
+/** write_string_field
+  *
+  *     Writes a quoted string from the specification as a C initializer.
+  */
+static void
+write_string_field(FILE* f, const char* s)
+{
+    if (s == NULL)
+    {
+        fputs("NULL", f);
+    }
+    else
+    {
+        fprintf(f, "DROPT_TEXT_LITERAL(%s)", s);
+    }
+}
+
+
+/** write_source
+  *
+  *     Writes the generated C source file.
+  *
+  * PARAMETERS:
+  *     IN f          : The output stream.
+  *     IN spec       : The table specification.
+  *     IN header     : The name of the generated header, as it should be
+  *                       included.
+  *     IN index      : The serialized lookup index.
+  *     IN indexSize  : The size of the index, in bytes.
+  */
+static void
+write_source(FILE* f, const table_spec* spec, const char* header,
+             const dropt_uint32* index, size_t indexSize)
+{
+    size_t i;
+
+    fprintf(f, "/* Generated by dropt_gen from %s.  Do not edit. */\n\n",
+            base_name(spec->fileName));
+    fprintf(f, "#include <stdint.h>\n\n");
+    fprintf(f, "#include \"dropt.h\"\n");
+    for (i = 0; i < spec->numIncludes; i++)
+    {
+        fprintf(f, "#include %s\n", spec->includes[i]);
+    }
+    fprintf(f, "#include \"%s\"\n\n\n", header);
+
+    fprintf(f, "const dropt_option %s[] = {\n", spec->name);
+    for (i = 0; i < spec->numOptions; i++)
+    {
+        const option_spec* option = &spec->options[i];
+
+        fputs("    { ", f);
+        if (option->shortName == '\0')
+        {
+            fputs("DROPT_TEXT_LITERAL('\\0')", f);
+        }
+        else
+        {
+            fprintf(f, "DROPT_TEXT_LITERAL('%c')", option->shortName);
+        }
+
+        fputs(", ", f);
+        if (option->longName == NULL)
+        {
+            fputs("NULL", f);
+        }
+        else
+        {
+            fprintf(f, "DROPT_TEXT_LITERAL(\"%s\")", option->longName);
+        }
+
+        fputs(", ", f);
+        write_string_field(f, option->description);
+        fputs(", ", f);
+        write_string_field(f, option->argDescription);
+        fprintf(f, ", %s, %s, %s, %s },\n",
+                (option->handler == NULL) ? "NULL" : option->handler,
+                (option->dest == NULL) ? "NULL" : option->dest,
+                (option->attr == NULL) ? "0" : option->attr,
+                (option->extraData == NULL) ? "0" : option->extraData);
+    }
+    fputs("    { 0 }\n};\n\n\n", f);
+
+    /* The index is stored as an array of 32-bit integers so that it's
+     * suitably aligned.
+     */
+    fprintf(f, "static const uint32_t %s_index[] = {", spec->name);
+    for (i = 0; i < indexSize / sizeof *index; i++)
+    {
+        fprintf(f, "%s0x%08lXU,", (i % 6 == 0) ? "\n    " : " ",
+                (unsigned long) index[i]);
+    }
+    fputs("\n};\n\n\n", f);
+
+    fprintf(f,
+            "const void*\n"
+            "%s_get_index(size_t* indexSize)\n"
+            "{\n"
+            "    *indexSize = sizeof %s_index;\n"
+            "    return %s_index;\n"
+            "}\n\n\n",
+            spec->name, spec->name, spec->name);
+
+    fprintf(f,
+            "/* The index is valid only for the configuration that generated it.  If it\n"
+            " * can't be used, fall back to building the index at run-time.\n"
+            " */\n"
+            "dropt_context*\n"
+            "%s_new_context(void)\n"
+            "{\n"
+            "    dropt_context* context\n"
+            "        = dropt_new_context_from_index(%s, %s_index,\n"
+            "                                       sizeof %s_index);\n"
+            "    if (context == NULL)\n"
+            "    {\n"
+            "        context = dropt_new_context(%s);\n"
+            "        if (context != NULL) { dropt_enable_hashed_lookup(context, %d); }\n"
+            "    }\n"
+            "    return context;\n"
+            "}\n",
+            spec->name, spec->name, spec->name, spec->name, spec->name,
+            spec->hashed ? 1 : 0);
+}
+
+
+/** write_header
+  *
+  *     Writes the generated C header file.
+  *
+  * PARAMETERS:
+  *     IN f    : The output stream.
+  *     IN spec : The table specification.
+  */
+static void
+write_header(FILE* f, const table_spec* spec)
+{
+    size_t i;
+    char* guard = duplicate_string(spec->name, strlen(spec->name));
+    for (i = 0; guard[i] != '\0'; i++)
+    {
+        guard[i] = (char) toupper((unsigned char) guard[i]);
+    }
+
+    fprintf(f, "/* Generated by dropt_gen from %s.  Do not edit. */\n\n",
+            base_name(spec->fileName));
+    fprintf(f, "#ifndef DROPT_GEN_%s_H\n#define DROPT_GEN_%s_H\n\n",
+            guard, guard);
+    fprintf(f, "#include <stddef.h>\n\n");
+    fprintf(f, "#include \"dropt.h\"\n\n");
+    fprintf(f, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n");
+    fprintf(f, "extern const dropt_option %s[];\n\n", spec->name);
+    fprintf(f, "const void* %s_get_index(size_t* indexSize);\n", spec->name);
+    fprintf(f, "dropt_context* %s_new_context(void);\n\n", spec->name);
+    fprintf(f, "#ifdef __cplusplus\n} /* extern \"C\" */\n#endif\n\n");
+    fprintf(f, "#endif /* DROPT_GEN_%s_H */\n", guard);
+
+    free(guard);
+}
+
+
+int
+main(int argc, char** argv)
+{
+    table_spec spec;
+    void* index = NULL;
+    size_t indexSize = 0;
+    FILE* f;
+    int status = EXIT_FAILURE;
+
+    if (argc != 4)
+    {
+        fprintf(stderr, "Usage: dropt_gen SPEC_FILE OUTPUT_C_FILE OUTPUT_H_FILE\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!read_spec(argv[1], &spec))
+    {
+        fprintf(stderr, "dropt_gen: Unable to read %s.\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    index = build_index(&spec, &indexSize);
+    if (index == NULL)
+    {
+        fprintf(stderr, "dropt_gen: Unable to build the lookup index.\n");
+        goto exit;
+    }
+
+    /* Don't leave truncated files behind if writing fails. */
+    f = fopen(argv[3], "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "dropt_gen: Unable to write %s.\n", argv[3]);
+        goto exit;
+    }
+    write_header(f, &spec);
+    if (ferror(f) | fclose(f))
+    {
+        fprintf(stderr, "dropt_gen: Unable to write %s.\n", argv[3]);
+        remove(argv[3]);
+        goto exit;
+    }
+
+    f = fopen(argv[2], "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "dropt_gen: Unable to write %s.\n", argv[2]);
+        remove(argv[3]);
+        goto exit;
+    }
+    write_source(f, &spec, base_name(argv[3]), index, indexSize);
+    if (ferror(f) | fclose(f))
+    {
+        fprintf(stderr, "dropt_gen: Unable to write %s.\n", argv[2]);
+        remove(argv[2]);
+        remove(argv[3]);
+        goto exit;
+    }
+
+    status = EXIT_SUCCESS;
+
+exit:
+    free(index);
+    free_spec(&spec);
+    return status;
+}
@@ -30,6 +30,8 @@
 #include <string.h>
 #include <limits.h>
 #include <float.h>
+#include <math.h>
+#include <locale.h>
 #include <errno.h>
 #include <assert.h>
 
@@ -45,8 +47,926 @@
 
 #define ABS(x) (((x) < 0) ? -(x) : (x))
 
+#define ARRAY_LENGTH(array) (sizeof (array) / sizeof (array)[0])
+
 typedef enum { false, true } bool;
 
+/* Decimal integers are converted eight digits at a time with 64-bit
+ * arithmetic when it's available.
+ */
+#if    !defined DROPT_USE_WCHAR \
+    && !defined DROPT_NO_SWAR \
+    && (__STDC_VERSION__ >= 199901L || defined _MSC_VER)
+    #define DROPT_SWAR_DIGITS 1
+
+    #if __STDC_VERSION__ >= 199901L
+        #include <stdint.h>
+        typedef uint64_t swar_word;
+    #else
+        typedef unsigned __int64 swar_word;
+    #endif
+
+    #define SWAR_CONSTANT(high, low) \
+        (((swar_word) (high) << 32) | (swar_word) (low))
+#endif
+
+/* Decimal numbers with few enough digits are converted with a single
+ * floating-point operation, which is correctly rounded only if `double`
+ * arithmetic isn't carried out with extra precision.
+ */
+#if    (defined FLT_EVAL_METHOD && FLT_EVAL_METHOD == 0) \
+    || defined __SSE2_MATH__ || defined __aarch64__ \
+    || defined _M_X64 || defined _M_ARM64
+    #define DROPT_FAST_REAL 1
+#endif
+
+#if __STDC_VERSION__ >= 199901L || defined _MSC_VER
+    #define DROPT_HAVE_STRTOLD 1
+#endif
+
+
+/** is_ascii_space
+  *
+  * RETURNS:
+  *     `true` if `c` is an ASCII whitespace character, `false` otherwise.
+  *       Unlike `isspace`, this doesn't depend on the locale.
+  */
+static bool
+is_ascii_space(dropt_char c)
+{
+    return    c == DROPT_TEXT_LITERAL(' ')
+           || (c >= DROPT_TEXT_LITERAL('\t') && c <= DROPT_TEXT_LITERAL('\r'));
+}
+
+
+/** digit_value
+  *
+  * RETURNS:
+  *     The value of `c` as a digit in bases up to 36, or `UINT_MAX` if `c`
+  *       isn't a digit.
+  */
+static unsigned int
+digit_value(dropt_char c)
+{
+    unsigned int digit = (unsigned int) (c - DROPT_TEXT_LITERAL('0'));
+    if (digit < 10) { return digit; }
+
+    /* Setting this bit maps only 'A'-'Z' onto 'a'-'z'. */
+    digit = (unsigned int) ((c | 0x20) - DROPT_TEXT_LITERAL('a'));
+    return (digit < 26) ? digit + 10 : UINT_MAX;
+}
+
+
+#ifdef DROPT_SWAR_DIGITS
+/** load_eight_digits
+  *
+  * RETURNS:
+  *     The eight characters starting at `s` packed into a word, with the
+  *       first character in the least significant byte.
+  */
+static swar_word
+load_eight_digits(const char* s)
+{
+    const unsigned char* p = (const unsigned char*) s;
+    return   (swar_word) p[0]
+           | ((swar_word) p[1] << 8)
+           | ((swar_word) p[2] << 16)
+           | ((swar_word) p[3] << 24)
+           | ((swar_word) p[4] << 32)
+           | ((swar_word) p[5] << 40)
+           | ((swar_word) p[6] << 48)
+           | ((swar_word) p[7] << 56);
+}
+
+
+/** load_short_digits
+  *
+  *     Like `load_eight_digits` but loads fewer characters, padded with
+  *     leading '0' characters.
+  *
+  * PARAMETERS:
+  *     IN s : The characters.
+  *     IN n : The number of characters to load, from 1 to 7.
+  */
+static swar_word
+load_short_digits(const char* s, size_t n)
+{
+    const unsigned char* p = (const unsigned char*) s;
+    unsigned int padding = (unsigned int) (8 - n) * 8;
+    swar_word v = 0;
+    size_t i;
+
+    assert(n > 0 && n < 8);
+
+    for (i = 0; i < n; i++) { v |= (swar_word) p[i] << (i * 8); }
+    return   (v << padding)
+           | (SWAR_CONSTANT(0x30303030, 0x30303030) >> (64 - padding));
+}
+
+
+/** is_eight_digits
+  *
+  * RETURNS:
+  *     `true` if every byte of `v` is an ASCII decimal digit.
+  */
+static bool
+is_eight_digits(swar_word v)
+{
+    const swar_word high = SWAR_CONSTANT(0xF0F0F0F0, 0xF0F0F0F0);
+    return (  (v & high)
+            | (((v + SWAR_CONSTANT(0x06060606, 0x06060606)) & high) >> 4))
+           == SWAR_CONSTANT(0x33333333, 0x33333333);
+}
+
+
+/** eight_digits_value
+  *
+  *     Converts eight ASCII decimal digits in parallel by combining adjacent
+  *     pairs of digits, then of 2-digit numbers, then of 4-digit numbers.
+  *
+  * RETURNS:
+  *     The value of the digits in `v` (see `load_eight_digits`).
+  */
+static unsigned long
+eight_digits_value(swar_word v)
+{
+    v = ((v & SWAR_CONSTANT(0x0F0F0F0F, 0x0F0F0F0F)) * (10 * 256 + 1)) >> 8;
+    v = ((v & SWAR_CONSTANT(0x00FF00FF, 0x00FF00FF)) * (100 * 65536 + 1)) >> 16;
+    return (unsigned long)
+           (((v & SWAR_CONSTANT(0x0000FFFF, 0x0000FFFF))
+             * SWAR_CONSTANT(10000, 1)) >> 32);
+}
+#endif /* DROPT_SWAR_DIGITS */
+
+
+/** parse_magnitude
+  *
+  *     Parses an unsigned integer that occupies the rest of a string.
+  *
+  * PARAMETERS:
+  *     IN s      : The digits, optionally preceded by "0x" (for base 16 or
+  *                   0) or "0b" (for base 2 or 0).
+  *     IN base   : The base, from 2 to 36, or 0 to determine the base from
+  *                   the prefix as `strtoul` does.
+  *     IN limit  : The largest acceptable value.
+  *     OUT out   : On success, set to the parsed value.
+  *                 On error, left untouched.
+  *
+  * RETURNS:
+  *     dropt_error_none
+  *     dropt_error_mismatch
+  *     dropt_error_overflow
+  */
+static dropt_error
+parse_magnitude(const dropt_char* s, unsigned int base, unsigned long limit,
+                unsigned long* out)
+{
+    unsigned long val = 0;
+    unsigned long cutoff;
+    unsigned int cutoffDigit;
+    bool overflow = false;
+
+    if (   s[0] == DROPT_TEXT_LITERAL('0')
+        && (s[1] == DROPT_TEXT_LITERAL('x') || s[1] == DROPT_TEXT_LITERAL('X'))
+        && (base == 0 || base == 16)
+        && digit_value(s[2]) < 16)
+    {
+        base = 16;
+        s += 2;
+    }
+    else if (   s[0] == DROPT_TEXT_LITERAL('0')
+             && (s[1] == DROPT_TEXT_LITERAL('b') || s[1] == DROPT_TEXT_LITERAL('B'))
+             && (base == 0 || base == 2)
+             && digit_value(s[2]) < 2)
+    {
+        base = 2;
+        s += 2;
+    }
+    else if (base == 0)
+    {
+        base = (s[0] == DROPT_TEXT_LITERAL('0')) ? 8 : 10;
+    }
+
+    if (s[0] == DROPT_TEXT_LITERAL('\0')) { return dropt_error_mismatch; }
+
+    /* Avoid division by a variable for the common bases. */
+    switch (base)
+    {
+        case 10:
+            cutoff = limit / 10;
+            cutoffDigit = (unsigned int) (limit % 10);
+            break;
+        case 16:
+            cutoff = limit >> 4;
+            cutoffDigit = (unsigned int) (limit & 0xF);
+            break;
+        case 8:
+            cutoff = limit >> 3;
+            cutoffDigit = (unsigned int) (limit & 0x7);
+            break;
+        case 2:
+            cutoff = limit >> 1;
+            cutoffDigit = (unsigned int) (limit & 0x1);
+            break;
+        default:
+            cutoff = limit / base;
+            cutoffDigit = (unsigned int) (limit % base);
+            break;
+    }
+
+#ifdef DROPT_SWAR_DIGITS
+    if (base == 10)
+    {
+        size_t remaining = strlen(s);
+        while (remaining >= 8)
+        {
+            swar_word chunk = load_eight_digits(s);
+            unsigned long chunkValue;
+
+            if (!is_eight_digits(chunk)) { break; }
+
+            chunkValue = eight_digits_value(chunk);
+            if (val > (limit - chunkValue) / 100000000UL)
+            {
+                /* Let the loop below check the remaining characters. */
+                overflow = true;
+                break;
+            }
+            val = val * 100000000UL + chunkValue;
+            s += 8;
+            remaining -= 8;
+        }
+
+        /* Fewer than eight digits can't overflow by themselves. */
+        if (val == 0 && remaining > 0 && remaining < 8)
+        {
+            swar_word chunk = load_short_digits(s, remaining);
+            if (is_eight_digits(chunk))
+            {
+                *out = eight_digits_value(chunk);
+                return dropt_error_none;
+            }
+        }
+    }
+#endif
+
+    for (; *s != DROPT_TEXT_LITERAL('\0'); s++)
+    {
+        unsigned int digit = digit_value(*s);
+        if (digit >= base) { return dropt_error_mismatch; }
+
+        if (   !overflow
+            && (val < cutoff || (val == cutoff && digit <= cutoffDigit)))
+        {
+            val = val * base + digit;
+        }
+        else
+        {
+            overflow = true;
+        }
+    }
+
+    if (overflow) { return dropt_error_overflow; }
+
+    *out = val;
+    return dropt_error_none;
+}
+
+
+/** dropt_parse_long
+  *
+  *     Parses a string representing a signed integer.  Unlike `strtol`,
+  *     this doesn't depend on the locale or use `errno`, and the entire
+  *     string (other than leading whitespace) must be a number.
+  *
+  * PARAMETERS:
+  *     IN s    : The string.
+  *               Leading ASCII whitespace and a sign are allowed.
+  *     IN base : The base, from 2 to 36.  Pass 0 to treat numbers prefixed
+  *                 with "0x" as hexadecimal, "0b" as binary, and "0" as
+  *                 octal.
+  *     OUT out : On success, set to the parsed value.
+  *               On error, left untouched.
+  *
+  * RETURNS:
+  *     dropt_error_none
+  *     dropt_error_bad_configuration
+  *     dropt_error_mismatch
+  *     dropt_error_overflow
+  */
+dropt_error
+dropt_parse_long(const dropt_char* s, int base, long* out)
+{
+    bool negative = false;
+    unsigned long magnitude = 0;
+    dropt_error err;
+
+    if (s == NULL || out == NULL || base < 0 || base == 1 || base > 36)
+    {
+        DROPT_MISUSE("Invalid arguments to dropt_parse_long.");
+        return dropt_error_bad_configuration;
+    }
+
+    while (is_ascii_space(*s)) { s++; }
+
+    if (*s == DROPT_TEXT_LITERAL('-'))
+    {
+        negative = true;
+        s++;
+    }
+    else if (*s == DROPT_TEXT_LITERAL('+'))
+    {
+        s++;
+    }
+
+    err = parse_magnitude(s, (unsigned int) base,
+                          negative ? (unsigned long) LONG_MAX + 1 : LONG_MAX,
+                          &magnitude);
+    if (err == dropt_error_none)
+    {
+        /* Avoid overflow when negating `LONG_MIN`. */
+        *out = (negative && magnitude != 0)
+               ? -(long) (magnitude - 1) - 1
+               : (long) magnitude;
+    }
+    return err;
+}
+
+
+/** dropt_parse_ulong
+  *
+  *     Like `dropt_parse_long` but parses an unsigned integer.  Negative
+  *     numbers are rejected instead of wrapping around as they do with
+  *     `strtoul`.
+  *
+  * PARAMETERS:
+  *     See `dropt_parse_long`.
+  *
+  * RETURNS:
+  *     See `dropt_parse_long`.
+  */
+dropt_error
+dropt_parse_ulong(const dropt_char* s, int base, unsigned long* out)
+{
+    if (s == NULL || out == NULL || base < 0 || base == 1 || base > 36)
+    {
+        DROPT_MISUSE("Invalid arguments to dropt_parse_ulong.");
+        return dropt_error_bad_configuration;
+    }
+
+    while (is_ascii_space(*s)) { s++; }
+
+    if (*s == DROPT_TEXT_LITERAL('-')) { return dropt_error_mismatch; }
+    if (*s == DROPT_TEXT_LITERAL('+')) { s++; }
+
+    return parse_magnitude(s, (unsigned int) base, ULONG_MAX, out);
+}
+
+
+/* 2^53, above which not every integer is representable by a `double`. */
+#define DOUBLE_EXACT_LIMIT 9007199254740992.0
+
+/* Powers of 10 that are exactly representable by a `double`. */
+static const double exactPowersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define MAX_EXACT_POWER_OF_10 22
+
+typedef enum { real_float, real_double, real_long_double } real_type;
+
+
+/** scan_real
+  *
+  *     Scans a decimal or hexadecimal floating-point number whose significant
+  *     digits are exactly representable as a `double`.
+  *
+  * PARAMETERS:
+  *     IN s          : The string, without leading whitespace.
+  *     OUT negative  : Set to whether the number is negative.
+  *     OUT mantissa  : Set to the significant digits as an integer.
+  *     OUT exponent  : Set to the power of 10 (or of 2 for hexadecimal
+  *                       numbers) that scales `mantissa` to the number.
+  *     OUT hex       : Set to whether the number is hexadecimal.
+  *
+  * RETURNS:
+  *     `true` if the entire string was scanned, `false` if the string isn't
+  *       a simple number or has too many significant digits.
+  */
+static bool
+scan_real(const dropt_char* s, bool* negative, double* mantissa,
+          long* exponent, bool* hex)
+{
+    unsigned int base = 10;
+    unsigned int digitExponent = 1;
+    double limit;
+    double m = 0.0;
+    long e = 0;
+    long pendingZeros = 0;
+    bool sawDigit = false;
+    bool sawPoint = false;
+
+    *negative = false;
+    if (*s == DROPT_TEXT_LITERAL('-'))
+    {
+        *negative = true;
+        s++;
+    }
+    else if (*s == DROPT_TEXT_LITERAL('+'))
+    {
+        s++;
+    }
+
+    *hex = (   s[0] == DROPT_TEXT_LITERAL('0')
+            && (s[1] == DROPT_TEXT_LITERAL('x') || s[1] == DROPT_TEXT_LITERAL('X')));
+    if (*hex)
+    {
+        base = 16;
+        digitExponent = 4;
+        s += 2;
+    }
+
+    /* The largest mantissa that can take another digit exactly. */
+    limit = (*hex) ? 562949953421311.0 : 900719925474098.0;
+
+    for (;; s++)
+    {
+        unsigned int digit;
+
+        if (*s == DROPT_TEXT_LITERAL('.') && !sawPoint)
+        {
+            sawPoint = true;
+            continue;
+        }
+
+        digit = digit_value(*s);
+        if (digit >= base) { break; }
+
+        sawDigit = true;
+        if (sawPoint) { e -= digitExponent; }
+
+        /* Defer zeros so that trailing ones can go into the exponent. */
+        if (digit == 0)
+        {
+            pendingZeros++;
+            continue;
+        }
+
+        for (; pendingZeros > 0; pendingZeros--)
+        {
+            if (m > limit) { return false; }
+            m *= base;
+        }
+
+        if (m > limit) { return false; }
+        m = m * base + digit;
+    }
+
+    if (!sawDigit) { return false; }
+    e += pendingZeros * digitExponent;
+
+    if (   (!*hex && (*s == DROPT_TEXT_LITERAL('e') || *s == DROPT_TEXT_LITERAL('E')))
+        || (*hex && (*s == DROPT_TEXT_LITERAL('p') || *s == DROPT_TEXT_LITERAL('P'))))
+    {
+        bool negativeExponent = false;
+        long n = 0;
+
+        s++;
+        if (*s == DROPT_TEXT_LITERAL('-'))
+        {
+            negativeExponent = true;
+            s++;
+        }
+        else if (*s == DROPT_TEXT_LITERAL('+'))
+        {
+            s++;
+        }
+
+        if (digit_value(*s) >= 10) { return false; }
+        for (; digit_value(*s) < 10; s++)
+        {
+            /* Anything this large overflows or underflows anyway. */
+            if (n < 100000) { n = n * 10 + digit_value(*s); }
+        }
+        e += negativeExponent ? -n : n;
+    }
+
+    if (*s != DROPT_TEXT_LITERAL('\0')) { return false; }
+
+    *mantissa = m;
+    *exponent = e;
+    return true;
+}
+
+
+#ifdef DROPT_FAST_REAL
+/** near_float_midpoint
+  *
+  * PARAMETERS:
+  *     IN d : A correctly rounded `double` in the normal range of `float`.
+  *
+  * RETURNS:
+  *     `true` if `d` is within a `double` ULP of a point halfway between two
+  *       adjacent `float` values.  If not, the exact value that `d`
+  *       approximates rounds to the same `float` as `d` does.
+  */
+static bool
+near_float_midpoint(double d)
+{
+    int e;
+    double scaled;
+
+    /* Scale the `float` ULP to 1. */
+    frexp(d, &e);
+    scaled = ABS(ldexp(d, FLT_MANT_DIG - e));
+    scaled -= floor(scaled);
+    return ABS(scaled - 0.5) <= ldexp(1.0, FLT_MANT_DIG - DBL_MANT_DIG);
+}
+#endif
+
+
+/** convert_real
+  *
+  *     Converts a scanned number (see `scan_real`) with a single rounding if
+  *     possible.
+  *
+  * PARAMETERS:
+  *     IN type     : The type to convert to.
+  *     IN mantissa : The significant digits as an integer.
+  *     IN exponent : The power of 10 (or of 2 if `hex` is true) that scales
+  *                     `mantissa` to the number.
+  *     IN hex      : Whether the number is hexadecimal.
+  *     OUT out     : On success, set to the correctly rounded number.
+  *
+  * RETURNS:
+  *     `true` on success, `false` if the number needs a slower conversion.
+  */
+static bool
+convert_real(real_type type, double mantissa, long exponent, bool hex,
+             long double* out)
+{
+    if (mantissa == 0.0)
+    {
+        *out = 0.0;
+        return true;
+    }
+
+    if (hex)
+    {
+        /* Scaling the mantissa (which is less than 2^53) by a power of 2 is
+         * exact if the result stays in the normal range of `double`, which
+         * contains that of `float`.  Converting to `float` then rounds once
+         * and can't round past `FLT_MAX`.
+         */
+        if (type == real_float)
+        {
+            if (   exponent < FLT_MIN_EXP - 1
+                || exponent > FLT_MAX_EXP - 1 - DBL_MANT_DIG)
+            {
+                return false;
+            }
+            *out = (float) ldexp(mantissa, (int) exponent);
+        }
+        else
+        {
+            if (   exponent < DBL_MIN_EXP - 1
+                || exponent > DBL_MAX_EXP - DBL_MANT_DIG)
+            {
+                return false;
+            }
+            *out = ldexp(mantissa, (int) exponent);
+        }
+        return true;
+    }
+
+    if (exponent < -MAX_EXACT_POWER_OF_10) { return false; }
+
+    if (type == real_long_double)
+    {
+        if (exponent <= MAX_EXACT_POWER_OF_10)
+        {
+            long double m = mantissa;
+            *out = (exponent < 0)
+                   ? m / exactPowersOf10[-exponent]
+                   : m * exactPowersOf10[exponent];
+            return true;
+        }
+        return false;
+    }
+
+#ifdef DROPT_FAST_REAL
+    {
+        double d;
+
+        /* The mantissa and the power of 10 are exact, so a single operation
+         * rounds correctly.
+         */
+        if (exponent <= MAX_EXACT_POWER_OF_10)
+        {
+            d = (exponent < 0)
+                ? mantissa / exactPowersOf10[-exponent]
+                : mantissa * exactPowersOf10[exponent];
+        }
+        else if (exponent <= 2 * MAX_EXACT_POWER_OF_10)
+        {
+            /* Move the excess power of 10 into the mantissa if that's still
+             * exact.
+             */
+            double m = mantissa
+                       * exactPowersOf10[exponent - MAX_EXACT_POWER_OF_10];
+            if (m >= DOUBLE_EXACT_LIMIT) { return false; }
+            d = m * exactPowersOf10[MAX_EXACT_POWER_OF_10];
+        }
+        else
+        {
+            return false;
+        }
+
+        if (type == real_float)
+        {
+            /* Rounding the `double` to `float` might round the exact value
+             * twice.
+             */
+            if (d < FLT_MIN || d > FLT_MAX || near_float_midpoint(d))
+            {
+                return false;
+            }
+            *out = (float) d;
+            return true;
+        }
+
+        *out = d;
+        return true;
+    }
+#else
+    return false;
+#endif
+}
+
+
+/** strtod_real
+  *
+  *     Converts a number with the C library, translating the decimal point
+  *     to the current locale's.
+  *
+  * PARAMETERS:
+  *     IN type : The type to convert to.
+  *     IN s    : The string.
+  *     OUT out : On success, set to the converted number.
+  *
+  * RETURNS:
+  *     dropt_error_none
+  *     dropt_error_insufficient_memory
+  *     dropt_error_mismatch
+  *     dropt_error_overflow
+  *     dropt_error_underflow
+  *     dropt_error_unknown
+  */
+static dropt_error
+strtod_real(real_type type, const dropt_char* s, long double* out)
+{
+    dropt_error err = dropt_error_none;
+    const char* localePoint = localeconv()->decimal_point;
+    dropt_char buffer[128];
+    dropt_char* copy = NULL;
+    const dropt_char* p = s;
+    dropt_char* end;
+    long double val;
+    long double smallest;
+
+    if (   localePoint[0] != '\0'
+        && !(localePoint[0] == '.' && localePoint[1] == '\0'))
+    {
+        size_t pointLength = strlen(localePoint);
+        size_t length = dropt_strlen(s);
+        size_t i;
+        dropt_char* q;
+
+        copy = (length * pointLength < ARRAY_LENGTH(buffer))
+               ? buffer
+               : dropt_safe_malloc(length * pointLength + 1, sizeof *copy);
+        if (copy == NULL)
+        {
+            err = dropt_error_insufficient_memory;
+            goto exit;
+        }
+
+        q = copy;
+        for (i = 0; i < length; i++)
+        {
+            if (s[i] == (unsigned char) localePoint[0])
+            {
+                /* Only '.' is a decimal point. */
+                err = dropt_error_mismatch;
+                goto exit;
+            }
+            else if (s[i] == DROPT_TEXT_LITERAL('.'))
+            {
+                size_t j;
+                for (j = 0; j < pointLength; j++)
+                {
+                    *q++ = (unsigned char) localePoint[j];
+                }
+            }
+            else
+            {
+                *q++ = s[i];
+            }
+        }
+        *q = DROPT_TEXT_LITERAL('\0');
+        p = copy;
+    }
+
+    errno = 0;
+    switch (type)
+    {
+        case real_float:
+#ifdef DROPT_HAVE_STRTOLD
+            val = dropt_strtof(p, &end);
+#else
+            val = dropt_strtod(p, &end);
+            if (   ABS(val) >= ldexp(1.0, FLT_MAX_EXP)
+                              - ldexp(1.0, FLT_MAX_EXP - FLT_MANT_DIG - 1))
+            {
+                /* This would round past `FLT_MAX`, and converting it to
+                 * `float` would be undefined.
+                 */
+                errno = ERANGE;
+            }
+            else
+            {
+                val = (float) val;
+            }
+#endif
+            smallest = FLT_MIN;
+            break;
+        case real_long_double:
+#ifdef DROPT_HAVE_STRTOLD
+            val = dropt_strtold(p, &end);
+#else
+            val = dropt_strtod(p, &end);
+#endif
+            smallest = LDBL_MIN;
+            break;
+        case real_double:
+        default:
+            val = dropt_strtod(p, &end);
+            smallest = DBL_MIN;
+            break;
+    }
+
+    /* Check that we matched at least one digit.
+     * (`strtod` will return 0 if fed a string with no digits.)
+     */
+    if (*end == DROPT_TEXT_LITERAL('\0') && end > p)
+    {
+        if (errno == ERANGE)
+        {
+            /* Note that setting `errno` to `ERANGE` for underflow errors
+             * is implementation-defined behavior, but glibc, BSD's
+             * libc, and Microsoft's CRT all have implementations of
+             * `strtod` documented to return 0 and to set `errno` to
+             * `ERANGE` for such cases.
+             */
+            err = (ABS(val) <= smallest)
+                  ? dropt_error_underflow
+                  : dropt_error_overflow;
+        }
+        else if (errno != 0)
+        {
+            err = dropt_error_unknown;
+        }
+    }
+    else
+    {
+        err = dropt_error_mismatch;
+    }
+
+exit:
+    if (copy != buffer) { dropt_free(copy); }
+    if (err == dropt_error_none) { *out = val; }
+    return err;
+}
+
+
+/** parse_real
+  *
+  *     Parses a floating-point number of the specified type.
+  *
+  * PARAMETERS:
+  *     IN type : The type to parse.
+  *     IN s    : The string.
+  *     OUT out : On success, set to the parsed number.
+  *               On error, left untouched.
+  *
+  * RETURNS:
+  *     See `dropt_parse_double`.
+  */
+static dropt_error
+parse_real(real_type type, const dropt_char* s, long double* out)
+{
+    bool negative;
+    double mantissa;
+    long exponent;
+    bool hex;
+
+    while (is_ascii_space(*s)) { s++; }
+
+    if (   scan_real(s, &negative, &mantissa, &exponent, &hex)
+        && convert_real(type, mantissa, exponent, hex, out))
+    {
+        if (negative) { *out = -*out; }
+        return dropt_error_none;
+    }
+
+    return strtod_real(type, s, out);
+}
+
+
+/** dropt_parse_double
+  *
+  *     Parses a string representing a floating-point number.  Unlike
+  *     `strtod`, this always uses '.' as the decimal point, and the entire
+  *     string (other than leading whitespace) must be a number.  Decimal
+  *     numbers with at most about 15 significant digits and hexadecimal
+  *     numbers (such as "0x1.8p3") are converted without the C library.
+  *
+  * PARAMETERS:
+  *     IN s    : The string.
+  *     OUT out : On success, set to the correctly rounded number.
+  *               On error, left untouched.
+  *
+  * RETURNS:
+  *     dropt_error_none
+  *     dropt_error_unknown
+  *     dropt_error_bad_configuration
+  *     dropt_error_insufficient_memory
+  *     dropt_error_mismatch
+  *     dropt_error_overflow
+  *     dropt_error_underflow
+  */
+dropt_error
+dropt_parse_double(const dropt_char* s, double* out)
+{
+    long double val = 0.0;
+    dropt_error err;
+
+    if (s == NULL || out == NULL)
+    {
+        DROPT_MISUSE("Invalid arguments to dropt_parse_double.");
+        return dropt_error_bad_configuration;
+    }
+
+    err = parse_real(real_double, s, &val);
+    if (err == dropt_error_none) { *out = (double) val; }
+    return err;
+}
+
+
+/** dropt_parse_float
+  *
+  *     Like `dropt_parse_double` but parses a `float`.
+  */
+dropt_error
+dropt_parse_float(const dropt_char* s, float* out)
+{
+    long double val = 0.0;
+    dropt_error err;
+
+    if (s == NULL || out == NULL)
+    {
+        DROPT_MISUSE("Invalid arguments to dropt_parse_float.");
+        return dropt_error_bad_configuration;
+    }
+
+    err = parse_real(real_float, s, &val);
+    if (err == dropt_error_none) { *out = (float) val; }
+    return err;
+}
+
+
+/** dropt_parse_long_double
+  *
+  *     Like `dropt_parse_double` but parses a `long double`.
+  */
+dropt_error
+dropt_parse_long_double(const dropt_char* s, long double* out)
+{
+    long double val = 0.0;
+    dropt_error err;
+
+    if (s == NULL || out == NULL)
+    {
+        DROPT_MISUSE("Invalid arguments to dropt_parse_long_double.");
+        return dropt_error_bad_configuration;
+    }
+
+    err = parse_real(real_long_double, s, &val);
+    if (err == dropt_error_none) { *out = val; }
+    return err;
+}
+
 
 /** dropt_handle_bool
   *
@@ -188,7 +1108,6 @@ dropt_handle_verbose_bool(dropt_context* context,
   *
   * RETURNS:
   *     dropt_error_none
-  *     dropt_error_unknown
   *     dropt_error_bad_configuration
   *     dropt_error_insufficient_arguments
   *     dropt_error_mismatch
@@ -216,34 +1135,19 @@ dropt_handle_int(dropt_context* context,
     }
     else
     {
-        dropt_char* end;
-        long n;
-        errno = 0;
-        n = dropt_strtol(optionArgument, &end, 10);
-
-        /* Check that we matched at least one digit.
-         * (`strtol`/`strtoul` will return 0 if fed a string with no digits.)
-         */
-        if (*end == DROPT_TEXT_LITERAL('\0') && end > optionArgument)
+        long n = 0;
+        err = dropt_parse_long(optionArgument, 10, &n);
+        if (err == dropt_error_none)
         {
-            if (errno == ERANGE || n < INT_MIN || n > INT_MAX)
+            if (n < INT_MIN || n > INT_MAX)
             {
                 err = dropt_error_overflow;
-                val = (n < 0) ? INT_MIN : INT_MAX;
-            }
-            else if (errno == 0)
-            {
-                val = (int) n;
             }
             else
             {
-                err = dropt_error_unknown;
+                val = (int) n;
             }
         }
-        else
-        {
-            err = dropt_error_mismatch;
-        }
     }
 
     if (err == dropt_error_none) { *out = val; }
@@ -270,7 +1174,6 @@ dropt_handle_int(dropt_context* context,
   *
   * RETURNS:
   *     dropt_error_none
-  *     dropt_error_unknown
   *     dropt_error_bad_configuration
   *     dropt_error_insufficient_arguments
   *     dropt_error_mismatch
@@ -283,7 +1186,7 @@ dropt_handle_uint(dropt_context* context,
                   void* dest)
 {
     dropt_error err = dropt_error_none;
-    int val = 0;
+    unsigned int val = 0;
     unsigned int* out = dest;
 
     if (out == NULL)
@@ -302,34 +1205,19 @@ dropt_handle_uint(dropt_context* context,
     }
     else
     {
-        dropt_char* end;
-        unsigned long n;
-        errno = 0;
-        n = dropt_strtoul(optionArgument, &end, 10);
-
-        /* Check that we matched at least one digit.
-         * (`strtol`/`strtoul` will return 0 if fed a string with no digits.)
-         */
-        if (*end == DROPT_TEXT_LITERAL('\0') && end > optionArgument)
+        unsigned long n = 0;
+        err = dropt_parse_ulong(optionArgument, 10, &n);
+        if (err == dropt_error_none)
         {
-            if (errno == ERANGE || n > UINT_MAX)
+            if (n > UINT_MAX)
             {
                 err = dropt_error_overflow;
-                val = UINT_MAX;
-            }
-            else if (errno == 0)
-            {
-                val = (unsigned int) n;
             }
             else
             {
-                err = dropt_error_unknown;
+                val = (unsigned int) n;
             }
         }
-        else
-        {
-            err = dropt_error_mismatch;
-        }
     }
 
     if (err == dropt_error_none) { *out = val; }
@@ -345,8 +1233,9 @@ dropt_handle_uint(dropt_context* context,
   *     IN/OUT context    : The options context.
   *     IN option         : The matched option.  For more information, see
   *                         `dropt_option_handler_decl`.
-  *     IN optionArgument : A string representing a base-10 floating-point
-  *                           number.
+  *     IN optionArgument : A string representing a base-10 or hexadecimal
+  *                           floating-point number (see
+  *                           `dropt_parse_double`).
   *                         If `NULL`, returns
   *                           `dropt_error_insufficient_arguments`.
   *     OUT dest          : A `double*`.
@@ -357,6 +1246,7 @@ dropt_handle_uint(dropt_context* context,
   *     dropt_error_none
   *     dropt_error_unknown
   *     dropt_error_bad_configuration
+  *     dropt_error_insufficient_memory
   *     dropt_error_insufficient_arguments
   *     dropt_error_mismatch
   *     dropt_error_overflow
@@ -369,7 +1259,6 @@ dropt_handle_double(dropt_context* context,
                     void* dest)
 {
     dropt_error err = dropt_error_none;
-    double val = 0.0;
     double* out = dest;
 
     if (out == NULL)
@@ -384,39 +1273,87 @@ dropt_handle_double(dropt_context* context,
     }
     else
     {
-        dropt_char* end;
-        errno = 0;
-        val = dropt_strtod(optionArgument, &end);
+        err = dropt_parse_double(optionArgument, out);
+    }
 
-        /* Check that we matched at least one digit.
-         * (`strtod` will return 0 if fed a string with no digits.)
-         */
-        if (*end == DROPT_TEXT_LITERAL('\0') && end > optionArgument)
-        {
-            if (errno == ERANGE)
-            {
-                /* Note that setting `errno` to `ERANGE` for underflow errors
-                 * is implementation-defined behavior, but glibc, BSD's
-                 * libc, and Microsoft's CRT all have implementations of
-                 * `strtod` documented to return 0 and to set `errno` to
-                 * `ERANGE` for such cases.
-                 */
-                err = (ABS(val) <= DBL_MIN)
-                      ? dropt_error_underflow
-                      : dropt_error_overflow;
-            }
-            else if (errno != 0)
-            {
-                err = dropt_error_unknown;
-            }
-        }
-        else
-        {
-            err = dropt_error_mismatch;
-        }
+    return err;
+}
+
+
+/** dropt_handle_float
+  *
+  *     Like `dropt_handle_double` but stores a `float`.
+  *
+  * PARAMETERS:
+  *     OUT dest : A `float*`.
+  *     See `dropt_handle_double` for the rest.
+  *
+  * RETURNS:
+  *     See `dropt_handle_double`.
+  */
+dropt_error
+dropt_handle_float(dropt_context* context,
+                   const dropt_option* option,
+                   const dropt_char* optionArgument,
+                   void* dest)
+{
+    dropt_error err = dropt_error_none;
+    float* out = dest;
+
+    if (out == NULL)
+    {
+        DROPT_MISUSE("No handler destination specified.");
+        err = dropt_error_bad_configuration;
+    }
+    else if (   optionArgument == NULL
+             || optionArgument[0] == DROPT_TEXT_LITERAL('\0'))
+    {
+        err = dropt_error_insufficient_arguments;
+    }
+    else
+    {
+        err = dropt_parse_float(optionArgument, out);
+    }
+
+    return err;
+}
+
+
+/** dropt_handle_long_double
+  *
+  *     Like `dropt_handle_double` but stores a `long double`.
+  *
+  * PARAMETERS:
+  *     OUT dest : A `long double*`.
+  *     See `dropt_handle_double` for the rest.
+  *
+  * RETURNS:
+  *     See `dropt_handle_double`.
+  */
+dropt_error
+dropt_handle_long_double(dropt_context* context,
+                         const dropt_option* option,
+                         const dropt_char* optionArgument,
+                         void* dest)
+{
+    dropt_error err = dropt_error_none;
+    long double* out = dest;
+
+    if (out == NULL)
+    {
+        DROPT_MISUSE("No handler destination specified.");
+        err = dropt_error_bad_configuration;
+    }
+    else if (   optionArgument == NULL
+             || optionArgument[0] == DROPT_TEXT_LITERAL('\0'))
+    {
+        err = dropt_error_insufficient_arguments;
+    }
+    else
+    {
+        err = dropt_parse_long_double(optionArgument, out);
     }
 
-    if (err == dropt_error_none) { *out = val; }
     return err;
 }
 
@@ -94,31 +94,99 @@ struct dropt_stringstream
 #endif
 
 
-/** dropt_safe_malloc
+/** default_reallocate
+  *
+  *     The default `dropt_allocator` reallocation function.
+  */
+static void*
+default_reallocate(void* userData, void* p, size_t size)
+{
+    (void) userData;
+    return realloc(p, size);
+}
+
+
+/** default_deallocate
+  *
+  *     The default `dropt_allocator` deallocation function.
+  */
+static void
+default_deallocate(void* userData, void* p)
+{
+    (void) userData;
+    free(p);
+}
+
+
+static const dropt_allocator defaultAllocator = {
+    default_reallocate,
+    default_deallocate,
+    NULL
+};
+
+static dropt_allocator globalAllocator = {
+    default_reallocate,
+    default_deallocate,
+    NULL
+};
+
+
+/** dropt_set_allocator
+  *
+  *     Sets the global allocator.  The global allocator is used for memory
+  *     that dropt returns to callers (e.g. from `dropt_strdup` and
+  *     `dropt_get_help`), for error messages, and by default for dropt
+  *     contexts created afterward (see `dropt_set_context_allocator`).
   *
-  *     A version of `malloc` that checks for integer overflow.
+  *     This should be called before any other dropt function, and it must
+  *     not be called while memory obtained from the previous global
+  *     allocator is still outstanding.
   *
   * PARAMETERS:
-  *     IN numElements : The number of elements to allocate.
-  *     IN elementSize : The size of each element, in bytes.
+  *     IN allocator : The allocator to use.  It is copied.
+  *                    Pass `NULL` to use `realloc` and `free`.
+  */
+void
+dropt_set_allocator(const dropt_allocator* allocator)
+{
+    if (allocator != NULL && (allocator->reallocate == NULL
+                              || allocator->deallocate == NULL))
+    {
+        DROPT_MISUSE("Incomplete allocator specified.");
+        return;
+    }
+
+    globalAllocator = (allocator == NULL) ? defaultAllocator : *allocator;
+}
+
+
+/** dropt_get_allocator
   *
-  * RETURNS:
-  *     A pointer to the allocated memory.
-  *     Returns `NULL` if `numElements` is 0.
-  *     Returns `NULL` on error.
+  * PARAMETERS:
+  *     OUT allocator : On output, a copy of the global allocator.
+  *                     Must not be `NULL`.
   */
-void*
-dropt_safe_malloc(size_t numElements, size_t elementSize)
+void
+dropt_get_allocator(dropt_allocator* allocator)
 {
-    return dropt_safe_realloc(NULL, numElements, elementSize);
+    if (allocator == NULL)
+    {
+        DROPT_MISUSE("No allocator specified.");
+        return;
+    }
+
+    *allocator = globalAllocator;
 }
 
 
-/** dropt_safe_realloc
+/** dropt_allocator_realloc
   *
-  *     Wrapper around `realloc` to check for integer overflow.
+  *     Resizes a memory block with an allocator, checking for integer
+  *     overflow.
   *
   * PARAMETERS:
+  *     IN allocator   : The allocator to use.
+  *                      Pass `NULL` to use the global allocator.
   *     IN/OUT p       : A pointer to the memory block to resize.
   *                      If `NULL`, a new memory block of the specified size
   *                        will be allocated.
@@ -132,10 +200,13 @@ dropt_safe_malloc(size_t numElements, size_t elementSize)
   *     Returns `NULL` on error.
   */
 void*
-dropt_safe_realloc(void* p, size_t numElements, size_t elementSize)
+dropt_allocator_realloc(const dropt_allocator* allocator,
+                        void* p, size_t numElements, size_t elementSize)
 {
     size_t numBytes;
 
+    if (allocator == NULL) { allocator = &globalAllocator; }
+
     /* `elementSize` shouldn't legally be 0, but we check for it in case a
      * caller got the argument order wrong.
      */
@@ -144,7 +215,7 @@ dropt_safe_realloc(void* p, size_t numElements, size_t elementSize)
         /* The behavior of `realloc(p, 0)` is implementation-defined.  Let's
          * enforce a particular behavior.
          */
-        free(p);
+        dropt_allocator_free(allocator, p);
 
         assert(elementSize != 0);
         return NULL;
@@ -157,7 +228,88 @@ dropt_safe_realloc(void* p, size_t numElements, size_t elementSize)
         return NULL;
     }
 
-    return realloc(p, numBytes);
+    return allocator->reallocate(allocator->user_data, p, numBytes);
+}
+
+
+/** dropt_allocator_free
+  *
+  *     Frees a memory block with an allocator.
+  *
+  * PARAMETERS:
+  *     IN allocator : The allocator that allocated `p`.
+  *                    Pass `NULL` to use the global allocator.
+  *     IN/OUT p     : The memory block to free.
+  *                    May be `NULL`.
+  */
+void
+dropt_allocator_free(const dropt_allocator* allocator, void* p)
+{
+    if (allocator == NULL) { allocator = &globalAllocator; }
+    if (p != NULL) { allocator->deallocate(allocator->user_data, p); }
+}
+
+
+/** dropt_free
+  *
+  *     Frees memory that dropt returned to the caller.
+  *
+  * PARAMETERS:
+  *     IN/OUT p : The memory block to free.
+  *                May be `NULL`.
+  */
+void
+dropt_free(void* p)
+{
+    dropt_allocator_free(&globalAllocator, p);
+}
+
+
+/** dropt_safe_malloc
+  *
+  *     A version of `malloc` that checks for integer overflow and that uses
+  *     the global allocator.
+  *
+  * PARAMETERS:
+  *     IN numElements : The number of elements to allocate.
+  *     IN elementSize : The size of each element, in bytes.
+  *
+  * RETURNS:
+  *     A pointer to the allocated memory.
+  *     Returns `NULL` if `numElements` is 0.
+  *     Returns `NULL` on error.
+  */
+void*
+dropt_safe_malloc(size_t numElements, size_t elementSize)
+{
+    return dropt_allocator_realloc(&globalAllocator, NULL,
+                                   numElements, elementSize);
+}
+
+
+/** dropt_safe_realloc
+  *
+  *     A version of `realloc` that checks for integer overflow and that uses
+  *     the global allocator.
+  *
+  * PARAMETERS:
+  *     IN/OUT p       : A pointer to the memory block to resize.
+  *                      If `NULL`, a new memory block of the specified size
+  *                        will be allocated.
+  *     IN numElements : The number of elements to allocate.
+  *                      If 0, frees `p`.
+  *     IN elementSize : The size of each element, in bytes.
+  *
+  * RETURNS:
+  *     A pointer to the allocated memory.
+  *     Returns `NULL` if `numElements` is 0.
+  *     Returns `NULL` on error.
+  */
+void*
+dropt_safe_realloc(void* p, size_t numElements, size_t elementSize)
+{
+    return dropt_allocator_realloc(&globalAllocator, p,
+                                   numElements, elementSize);
 }
 
 
@@ -169,8 +321,8 @@ dropt_safe_realloc(void* p, size_t numElements, size_t elementSize)
   *     IN s : A `NUL`-terminated string to duplicate.
   *
   * RETURNS:
-  *     The duplicated string.  The caller is responsible for calling `free()`
-  *       on it when no longer needed.
+  *     The duplicated string.  The caller is responsible for calling
+  *       `dropt_free()` on it when no longer needed.
   *     Returns `NULL` on error.
   */
 dropt_char*
@@ -191,7 +343,7 @@ dropt_strdup(const dropt_char* s)
   *
   * RETURNS:
   *     The duplicated string, which is always `NUL`-terminated.  The caller is
-  *       responsible for calling `free()` on it when no longer needed.
+  *       responsible for calling `dropt_free()` on it when no longer needed.
   *     Returns `NULL` on error.
   */
 dropt_char*
@@ -398,7 +550,7 @@ dropt_snprintf(dropt_char* s, size_t n, const dropt_char* format, ...)
   *
   * RETURNS:
   *     The formatted string, which is always NUL-terminated.  The caller is
-  *       responsible for calling `free()` on it when no longer needed.
+  *       responsible for calling `dropt_free()` on it when no longer needed.
   *     Returns `NULL` on error.
   */
 dropt_char*
@@ -455,7 +607,7 @@ dropt_asprintf(const dropt_char* format, ...)
 dropt_stringstream*
 dropt_ssopen(void)
 {
-    dropt_stringstream* ss = malloc(sizeof *ss);
+    dropt_stringstream* ss = dropt_safe_malloc(1, sizeof *ss);
     if (ss != NULL)
     {
         ss->used = 0;
@@ -463,7 +615,7 @@ dropt_ssopen(void)
         ss->string = dropt_safe_malloc(ss->maxSize, sizeof *ss->string);
         if (ss->string == NULL)
         {
-            free(ss);
+            dropt_free(ss);
             ss = NULL;
         }
         else
@@ -487,8 +639,8 @@ dropt_ssclose(dropt_stringstream* ss)
 {
     if (ss != NULL)
     {
-        free(ss->string);
-        free(ss);
+        dropt_free(ss->string);
+        dropt_free(ss);
     }
 }
 
@@ -580,7 +732,7 @@ dropt_ssclear(dropt_stringstream* ss)
   * RETURNS:
   *     The `dropt_stringstream`'s string, which is always `NUL`-terminated.
   *       Note that the caller assumes ownership of the returned string and is
-  *       responsible for calling `free()` on it when no longer needed.
+  *       responsible for calling `dropt_free()` on it when no longer needed.
   */
 dropt_char*
 dropt_ssfinalize(dropt_stringstream* ss)
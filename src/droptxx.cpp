@@ -74,6 +74,18 @@ context_ref::get_options()
 }
 
 
+/** dropt::context_ref::get_option
+  *
+  *     A wrapper around `dropt_get_option`.
+  */
+const dropt_option*
+context_ref::get_option(std::size_t index)
+   const
+{
+   return dropt_get_option(mContext, index);
+}
+
+
 /** dropt::context_ref::set_error_handler
   *
   *     A wrapper around `dropt_set_error_handler`.
@@ -97,6 +109,161 @@ context_ref::set_strncmp(dropt_strncmp_func cmp)
 }
 
 
+/** dropt::context_ref::set_case_insensitive
+  *
+  *     A wrapper around `dropt_set_case_insensitive`.
+  */
+void
+context_ref::set_case_insensitive(bool enable)
+{
+    dropt_set_case_insensitive(mContext, enable);
+}
+
+
+/** dropt::context_ref::enable_hashed_lookup
+  *
+  *     A wrapper around `dropt_enable_hashed_lookup`.
+  */
+void
+context_ref::enable_hashed_lookup(bool enable)
+{
+    dropt_enable_hashed_lookup(mContext, enable);
+}
+
+
+/** dropt::context_ref::allow_abbreviations
+  *
+  *     A wrapper around `dropt_allow_abbreviations`.
+  */
+void
+context_ref::allow_abbreviations(bool allow)
+{
+    dropt_allow_abbreviations(mContext, allow);
+}
+
+
+/** dropt::context_ref::enable_suggestions
+  *
+  *     A wrapper around `dropt_enable_suggestions`.
+  */
+void
+context_ref::enable_suggestions(unsigned int maxSuggestions)
+{
+    dropt_enable_suggestions(mContext, maxSuggestions);
+}
+
+
+/** dropt::context_ref::serialize_index
+  *
+  *     A wrapper around `dropt_serialize_index`.
+  */
+std::size_t
+context_ref::serialize_index(void* buffer, std::size_t bufferSize)
+{
+    return dropt_serialize_index(mContext, buffer, bufferSize);
+}
+
+
+/** dropt::context_ref::set_subcommands
+  *
+  *     A wrapper around `dropt_set_subcommands`.
+  */
+void
+context_ref::set_subcommands(const dropt_subcommand* subcommands)
+{
+    dropt_set_subcommands(mContext, subcommands);
+}
+
+
+/** dropt::context_ref::find_subcommand
+  *
+  *     A wrapper around `dropt_find_subcommand`.
+  */
+const dropt_subcommand*
+context_ref::find_subcommand(const dropt_char* name)
+{
+    return dropt_find_subcommand(mContext, name);
+}
+
+
+/** dropt::context_ref::get_subcommand_context
+  *
+  *     A wrapper around `dropt_get_subcommand_context`.
+  */
+dropt_context*
+context_ref::get_subcommand_context(const dropt_subcommand* subcommand)
+{
+    return dropt_get_subcommand_context(mContext, subcommand);
+}
+
+
+/** dropt::context_ref::freeze
+  *
+  *     A wrapper around `dropt_freeze_context`.
+  */
+dropt_error
+context_ref::freeze()
+{
+    return dropt_freeze_context(mContext);
+}
+
+
+/** dropt::context_ref::set_allocator
+  *
+  *     A wrapper around `dropt_set_context_allocator`.
+  */
+void
+context_ref::set_allocator(const dropt_allocator* allocator)
+{
+    dropt_set_context_allocator(mContext, allocator);
+}
+
+
+/** dropt::context_ref::defer_error_details
+  *
+  *     A wrapper around `dropt_defer_error_details`.
+  */
+void
+context_ref::defer_error_details(bool defer)
+{
+    dropt_defer_error_details(mContext, defer);
+}
+
+
+/** dropt::context_ref::enable_response_files
+  *
+  *     A wrapper around `dropt_enable_response_files`.
+  */
+void
+context_ref::enable_response_files(dropt_quoting syntax,
+                                   unsigned int maxDepth)
+{
+    dropt_enable_response_files(mContext, syntax, maxDepth);
+}
+
+
+/** dropt::context_ref::set_result_tape
+  *
+  *     A wrapper around `dropt_set_result_tape`.
+  */
+void
+context_ref::set_result_tape(dropt_tape_entry* tape, std::size_t capacity)
+{
+    dropt_set_result_tape(mContext, tape, capacity);
+}
+
+
+/** dropt::context_ref::get_tape_length
+  *
+  *     A wrapper around `dropt_get_tape_length`.
+  */
+std::size_t
+context_ref::get_tape_length() const
+{
+    return dropt_get_tape_length(mContext);
+}
+
+
 /** dropt::allow_concatenated_arguments
   *
   *     A wrapper around `dropt_allow_concatenated_arguments`.
@@ -127,6 +294,63 @@ context_ref::parse(dropt_char** argv)
 }
 
 
+/** dropt::context_ref::parse_source
+  *
+  *     A wrapper around `dropt_parse_source`.
+  */
+dropt_error
+context_ref::parse_source(const dropt_arg_source& source)
+{
+    return dropt_parse_source(mContext, &source);
+}
+
+
+/** dropt::context_ref::begin_incremental_parse
+  *
+  *     A wrapper around `dropt_begin_incremental_parse`.
+  */
+void
+context_ref::begin_incremental_parse()
+{
+    dropt_begin_incremental_parse(mContext);
+}
+
+
+/** dropt::context_ref::parse_chunk
+  *
+  *     A wrapper around `dropt_parse_chunk`.
+  */
+dropt_chunk_status
+context_ref::parse_chunk(int argc, dropt_char** argv, dropt_char*** rest)
+{
+    return dropt_parse_chunk(mContext, argc, argv, rest);
+}
+
+
+/** dropt::context_ref::end_incremental_parse
+  *
+  *     A wrapper around `dropt_end_incremental_parse`.
+  */
+dropt_error
+context_ref::end_incremental_parse()
+{
+    return dropt_end_incremental_parse(mContext);
+}
+
+
+/** dropt::context_ref::parse_batch
+  *
+  *     A wrapper around `dropt_parse_batch`.
+  */
+std::size_t
+context_ref::parse_batch(std::size_t n, const int* argcs,
+                         dropt_char** const* argvs,
+                         dropt_parse_result* results)
+{
+    return dropt_parse_batch(mContext, n, argcs, argvs, results);
+}
+
+
 /** dropt::context_ref::get_error
   *
   *     A wrapper around `dropt_get_error`.
@@ -150,6 +374,29 @@ context_ref::get_error_details(dropt_char** optionName,
 }
 
 
+/** dropt::context_ref::get_error_location
+  *
+  *     A wrapper around `dropt_get_error_location`.
+  */
+bool
+context_ref::get_error_location(dropt_error_location* location) const
+{
+    return dropt_get_error_location(mContext, location) != 0;
+}
+
+
+/** dropt::context_ref::get_error_candidates
+  *
+  *     A wrapper around `dropt_get_error_candidates`.
+  */
+std::size_t
+context_ref::get_error_candidates(const dropt_option** candidates,
+                                  std::size_t maxCandidates) const
+{
+    return dropt_get_error_candidates(mContext, candidates, maxCandidates);
+}
+
+
 /** dropt::context_ref::get_error_message
   *
   *     A wrapper around `dropt_get_error_message`.
@@ -172,6 +419,17 @@ context_ref::clear_error()
 }
 
 
+/** dropt::context_ref::reset
+  *
+  *     A wrapper around `dropt_reset_context`.
+  */
+void
+context_ref::reset()
+{
+    dropt_reset_context(mContext);
+}
+
+
 #ifndef DROPT_NO_STRING_BUFFERS
 /** dropt::context_ref::get_help
   *
@@ -198,7 +456,7 @@ context_ref::get_help(const help_params& helpParams) const
     {
     }
 
-    free(p);
+    dropt_free(p);
     return s;
 }
 #endif
@@ -219,6 +477,50 @@ context::context(const dropt_option* options)
 }
 
 
+/** dropt::context::context
+  *
+  *     `dropt::context` constructor that combines the options of other
+  *     contexts (see `dropt_new_composite_context`).
+  *
+  * PARAMETERS:
+  *     IN parts    : The dropt contexts to combine.
+  *                   Must not be `NULL`.
+  *                   The contexts must outlive this one.
+  *     IN numParts : The number of elements in `parts`.
+  */
+context::context(dropt_context* const* parts, std::size_t numParts)
+: context_ref(dropt_new_composite_context(parts, numParts))
+{
+    if (mContext == NULL) { throw std::bad_alloc(); }
+}
+
+
+/** dropt::context::context
+  *
+  *     `dropt::context` constructor that uses a serialized lookup index (see
+  *     `dropt_new_context_from_index`).  If the index can't be used, the
+  *     context builds its own.
+  *
+  * PARAMETERS:
+  *     IN options   : The list of option specifications.
+  *                    Must not be `NULL`.
+  *     IN index     : The serialized lookup index.
+  *                    May be `NULL`.
+  *                    The index is *not* copied and must outlive the
+  *                      context.
+  *     IN indexSize : The size of `index`, in bytes.
+  */
+context::context(const dropt_option* options,
+                 const void* index, std::size_t indexSize)
+: context_ref((index == NULL || indexSize == 0)
+              ? NULL
+              : dropt_new_context_from_index(options, index, indexSize))
+{
+    if (mContext == NULL) { mContext = dropt_new_context(options); }
+    if (mContext == NULL) { throw std::bad_alloc(); }
+}
+
+
 /** dropt::context::~context
   *
   *     `dropt::context` destructor.
@@ -415,4 +717,32 @@ handle_double(dropt_context* context,
 }
 
 
+/** dropt::handle_float
+  *
+  *     A wrapper around `dropt_handle_float`.
+  */
+dropt_error
+handle_float(dropt_context* context,
+             const dropt_option* option,
+             const dropt_char* optionArgument,
+             void* dest)
+{
+    return dropt_handle_float(context, option, optionArgument, dest);
+}
+
+
+/** dropt::handle_long_double
+  *
+  *     A wrapper around `dropt_handle_long_double`.
+  */
+dropt_error
+handle_long_double(dropt_context* context,
+                   const dropt_option* option,
+                   const dropt_char* optionArgument,
+                   void* dest)
+{
+    return dropt_handle_long_double(context, option, optionArgument, dest);
+}
+
+
 } // namespace dropt
@@ -25,16 +25,29 @@
 #define _CRT_SECURE_NO_DEPRECATE
 #endif
 
+/* `mkstemp` isn't declared in strict ISO C modes. */
+#if    (defined __unix__ || defined __APPLE__) \
+    && !defined _POSIX_C_SOURCE && !defined _XOPEN_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <wctype.h>
 #include <float.h>
+#include <limits.h>
 #include <assert.h>
 
+#if defined __unix__ || defined __APPLE__
+    #define HAVE_MKSTEMP 1
+    #include <unistd.h>
+#endif
+
 #include "dropt.h"
 #include "dropt_string.h"
+#include "dropt_index.h"
 
 /* Compatibility junk. */
 #ifdef DROPT_USE_WCHAR
@@ -104,6 +117,14 @@ static optional_uint optionalUInt;
 
 static unsigned int ipAddress;
 
+enum { num_generated_options = 3000, num_generated_short_names = 0x80 };
+
+enum { max_temp_path_length = 512 };
+
+static dropt_char generatedNames[num_generated_options][16];
+static dropt_option generatedOptions[num_generated_options + 1];
+static dropt_uintptr generatedVal;
+
 
 static void
 init_option_defaults(void)
@@ -550,6 +571,17 @@ test_dropt_handlers(dropt_context* context)
     success &= TEST_HANDLER(int, context, T("123a"), dropt_error_mismatch, i, i);
     success &= TEST_HANDLER(int, context, T("3000000000"), dropt_error_overflow, i, i);
     success &= TEST_HANDLER(int, context, T("-3000000000"), dropt_error_overflow, i, i);
+    success &= TEST_HANDLER(int, context, T("12345678"), dropt_error_none, 12345678, 0);
+    success &= TEST_HANDLER(int, context, T("-2147483648"), dropt_error_none, INT_MIN, 0);
+    success &= TEST_HANDLER(int, context, T("2147483647"), dropt_error_none, INT_MAX, 0);
+    success &= TEST_HANDLER(int, context, T("2147483648"), dropt_error_overflow, i, i);
+    success &= TEST_HANDLER(int, context, T("0000000000000000000123"), dropt_error_none, 123, 0);
+    success &= TEST_HANDLER(int, context, T("123456789012345678901234567890"), dropt_error_overflow, i, i);
+    success &= TEST_HANDLER(int, context, T("12345678901234567890123456789a"), dropt_error_mismatch, i, i);
+    success &= TEST_HANDLER(int, context, T("1234567a"), dropt_error_mismatch, i, i);
+    success &= TEST_HANDLER(int, context, T("0x10"), dropt_error_mismatch, i, i);
+    success &= TEST_HANDLER(int, context, T(" \t123"), dropt_error_none, 123, 0);
+    success &= TEST_HANDLER(int, context, T("- 123"), dropt_error_mismatch, i, i);
 
     success &= TEST_HANDLER(uint, context, NULL, dropt_error_insufficient_arguments, u, u);
     success &= TEST_HANDLER(uint, context, T(""), dropt_error_insufficient_arguments, u, u);
@@ -567,6 +599,46 @@ test_dropt_handlers(dropt_context* context)
     success &= TEST_HANDLER(uint, context, T("3000000000"), dropt_error_none, 3000000000u, 0);
     success &= TEST_HANDLER(uint, context, T("-3000000000"), dropt_error_mismatch, u, u);
     success &= TEST_HANDLER(uint, context, T("5000000000"), dropt_error_overflow, u, u);
+    success &= TEST_HANDLER(uint, context, T("4294967295"), dropt_error_none, 4294967295u, 0);
+    success &= TEST_HANDLER(uint, context, T("4294967296"), dropt_error_overflow, u, u);
+    success &= TEST_HANDLER(uint, context, T("12345678a"), dropt_error_mismatch, u, u);
+    success &= TEST_HANDLER(uint, context, T(" -1"), dropt_error_mismatch, u, u);
+
+    {
+        long l = 0;
+        unsigned long ul = 0;
+
+        success &= VERIFY(dropt_parse_long(T("0x7fFF"), 0, &l) == dropt_error_none && l == 0x7FFF);
+        success &= VERIFY(dropt_parse_long(T("-0x10"), 16, &l) == dropt_error_none && l == -16);
+        success &= VERIFY(dropt_parse_long(T("ff"), 16, &l) == dropt_error_none && l == 255);
+        success &= VERIFY(dropt_parse_long(T("0b1011"), 0, &l) == dropt_error_none && l == 11);
+        success &= VERIFY(dropt_parse_long(T("1011"), 2, &l) == dropt_error_none && l == 11);
+        success &= VERIFY(dropt_parse_long(T("0b102"), 0, &l) == dropt_error_mismatch);
+        success &= VERIFY(dropt_parse_long(T("017"), 0, &l) == dropt_error_none && l == 15);
+        success &= VERIFY(dropt_parse_long(T("018"), 0, &l) == dropt_error_mismatch);
+        success &= VERIFY(dropt_parse_long(T("0"), 0, &l) == dropt_error_none && l == 0);
+        success &= VERIFY(dropt_parse_long(T("0x"), 0, &l) == dropt_error_mismatch);
+        success &= VERIFY(dropt_parse_long(T("zz"), 36, &l) == dropt_error_none && l == 36 * 36 - 1);
+        success &= VERIFY(dropt_parse_long(T("-"), 10, &l) == dropt_error_mismatch);
+        success &= VERIFY(dropt_parse_long(T("99999999999999999999"), 10, &l) == dropt_error_overflow);
+        success &= VERIFY(dropt_parse_long(T("-99999999999999999999"), 10, &l) == dropt_error_overflow);
+
+        l = 0;
+        success &= VERIFY(dropt_parse_long(T("-2147483648"), 10, &l) == dropt_error_none && l == -2147483647L - 1);
+        if (sizeof (long) * CHAR_BIT == 64)
+        {
+            success &= VERIFY(dropt_parse_long(T("-9223372036854775808"), 10, &l) == dropt_error_none && l == LONG_MIN);
+            success &= VERIFY(dropt_parse_long(T("9223372036854775807"), 10, &l) == dropt_error_none && l == LONG_MAX);
+            success &= VERIFY(dropt_parse_long(T("9223372036854775808"), 10, &l) == dropt_error_overflow);
+            success &= VERIFY(dropt_parse_ulong(T("18446744073709551615"), 10, &ul) == dropt_error_none && ul == ULONG_MAX);
+            success &= VERIFY(dropt_parse_ulong(T("18446744073709551616"), 10, &ul) == dropt_error_overflow);
+            success &= VERIFY(dropt_parse_ulong(T("0xFFFFFFFFFFFFFFFF"), 0, &ul) == dropt_error_none && ul == ULONG_MAX);
+            success &= VERIFY(dropt_parse_ulong(T("0x10000000000000000"), 0, &ul) == dropt_error_overflow);
+        }
+
+        success &= VERIFY(dropt_parse_ulong(T("0xCAFEBABE"), 0, &ul) == dropt_error_none && ul == 0xCAFEBABEul);
+        success &= VERIFY(dropt_parse_ulong(T("-0"), 0, &ul) == dropt_error_mismatch);
+    }
 
     success &= TEST_HANDLER(double, context, NULL, dropt_error_insufficient_arguments, d, d);
     success &= TEST_HANDLER(double, context, T(""), dropt_error_insufficient_arguments, d, d);
@@ -582,6 +654,43 @@ test_dropt_handlers(dropt_context* context)
     success &= TEST_HANDLER(double, context, T("a"), dropt_error_mismatch, d, d);
     success &= TEST_HANDLER(double, context, T("123a"), dropt_error_mismatch, d, d);
     success &= TEST_HANDLER(double, context, T("1e1024"), dropt_error_overflow, d, d);
+    success &= TEST_HANDLER(double, context, T("0x1.8p1"), dropt_error_none, 3.0, 0);
+    success &= TEST_HANDLER(double, context, T("-0x10"), dropt_error_none, -16.0, 0);
+    success &= TEST_HANDLER(double, context, T("0x1.8q1"), dropt_error_mismatch, d, d);
+    success &= TEST_HANDLER(double, context, T("1e23"), dropt_error_none, 1e23, 0);
+    success &= TEST_HANDLER(double, context, T("12.3e"), dropt_error_mismatch, d, d);
+    success &= TEST_HANDLER(double, context, T("1.2.3"), dropt_error_mismatch, d, d);
+    success &= TEST_HANDLER(double, context, T("."), dropt_error_mismatch, d, d);
+
+    {
+        double dv = 0.0;
+        float fv = 0.0f;
+        long double lv = 0.0;
+
+        success &= VERIFY(dropt_parse_double(T("0.1"), &dv) == dropt_error_none && dv == 0.1);
+        success &= VERIFY(dropt_parse_double(T("3.141592653589793"), &dv) == dropt_error_none && dv == 3.141592653589793);
+        success &= VERIFY(dropt_parse_double(T("1.7976931348623157e308"), &dv) == dropt_error_none && dv == DBL_MAX);
+        success &= VERIFY(dropt_parse_double(T("2.2250738585072014e-308"), &dv) == dropt_error_none && dv == DBL_MIN);
+        success &= VERIFY(dropt_parse_double(T("9007199254740993"), &dv) == dropt_error_none && dv == 9007199254740992.0);
+        success &= VERIFY(dropt_parse_double(T("0x1.fffffffffffffp1023"), &dv) == dropt_error_none && dv == DBL_MAX);
+        success &= VERIFY(dropt_parse_double(T("0x1p-1022"), &dv) == dropt_error_none && dv == DBL_MIN);
+        success &= VERIFY(dropt_parse_double(T("1000000000000000000000000000000"), &dv) == dropt_error_none && dv == 1e30);
+        success &= VERIFY(dropt_parse_double(T("0.000000000000000000000000000001"), &dv) == dropt_error_none && dv == 1e-30);
+        success &= VERIFY(dropt_parse_double(T("-0"), &dv) == dropt_error_none && dv == 0.0);
+        success &= VERIFY(dropt_parse_double(T("0e999999"), &dv) == dropt_error_none && dv == 0.0);
+
+        success &= VERIFY(dropt_parse_float(T("0.1"), &fv) == dropt_error_none && fv == 0.1f);
+        success &= VERIFY(dropt_parse_float(T("16777217"), &fv) == dropt_error_none && fv == 16777216.0f);
+        success &= VERIFY(dropt_parse_float(T("3.4028235e38"), &fv) == dropt_error_none && fv == FLT_MAX);
+        success &= VERIFY(dropt_parse_float(T("0x1.fffffep127"), &fv) == dropt_error_none && fv == FLT_MAX);
+        success &= VERIFY(dropt_parse_float(T("1e39"), &fv) == dropt_error_overflow);
+        success &= VERIFY(dropt_parse_float(T("0x1p128"), &fv) == dropt_error_overflow);
+        success &= VERIFY(dropt_parse_float(T("abc"), &fv) == dropt_error_mismatch);
+
+        success &= VERIFY(dropt_parse_long_double(T("0.5"), &lv) == dropt_error_none && lv == 0.5);
+        success &= VERIFY(dropt_parse_long_double(T("-0x1.8p1"), &lv) == dropt_error_none && lv == -3.0);
+        success &= VERIFY(dropt_parse_long_double(T("1e1"), &lv) == dropt_error_none && lv == 10.0);
+    }
 
     /* This test depends on implementation-dependent behavior of strtod, so
      * we're less strict.
@@ -1196,35 +1305,2391 @@ test_dropt_parse(dropt_context* context)
 }
 
 
-#ifdef DROPT_USE_WCHAR
-int
-wmain(int argc, wchar_t** argv)
-#else
-int
-main(int argc, char** argv)
-#endif
+static bool
+test_dropt_parse_batch(dropt_context* context)
+{
+    bool success = true;
+    dropt_parse_result results[4];
+
+    dropt_char* args0[] = { T("-n"), T("file"), NULL };
+    dropt_char* args1[] = { T("--bogus"), NULL };
+    dropt_char* args2[] = { T("-i"), T("42"), T("-q"), NULL };
+    dropt_char** argvs[] = { args0, args1, args2, NULL };
+    const int argcs[] = { -1, -1, 2, 0 };
+
+    normalFlag = false;
+    quiet = false;
+    intVal = 0;
+    success &= VERIFY(dropt_parse_batch(context, ARRAY_LENGTH(argvs), argcs,
+                                        argvs, results) == 1);
+
+    success &= VERIFY(results[0].err == dropt_error_none);
+    success &= VERIFY(results[0].rest == &args0[1]);
+    success &= VERIFY(results[1].err == dropt_error_invalid_option);
+    success &= VERIFY(results[2].err == dropt_error_none);
+    success &= VERIFY(results[2].rest == &args2[2]);
+    success &= VERIFY(results[3].err == dropt_error_none);
+    success &= VERIFY(results[3].rest == NULL);
+
+    success &= VERIFY(normalFlag == true);
+    success &= VERIFY(intVal == 42);
+    success &= VERIFY(quiet == false);
+
+    /* The error from the second list shouldn't leak into the context. */
+    success &= VERIFY(dropt_get_error(context) == dropt_error_none);
+
+    /* A failure in the last list should be left in the context. */
+    success &= VERIFY(dropt_parse_batch(context, 2, NULL, argvs, results) == 1);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+    dropt_clear_error(context);
+
+    /* Each list's results should locate its entries on the result tape. */
+    {
+        dropt_tape_entry tape[4];
+        dropt_char* args3[] = { T("-q"), T("--bogus"), NULL };
+        dropt_char** tapeArgvs[4];
+
+        tapeArgvs[0] = args0;
+        tapeArgvs[1] = args3;
+        tapeArgvs[2] = NULL;
+        tapeArgvs[3] = args2;
+
+        intVal = 0;
+        dropt_set_result_tape(context, tape, ARRAY_LENGTH(tape));
+        success &= VERIFY(dropt_parse_batch(context, ARRAY_LENGTH(tapeArgvs),
+                                            NULL, tapeArgvs, results) == 1);
+        success &= VERIFY(dropt_get_tape_length(context) == 4);
+
+        success &= VERIFY(results[0].tape_start == 0);
+        success &= VERIFY(results[0].tape_length == 1);
+        success &= VERIFY(results[1].err == dropt_error_invalid_option);
+        success &= VERIFY(results[1].tape_start == 1);
+        success &= VERIFY(results[1].tape_length == 1);
+        success &= VERIFY(results[2].tape_start == 2);
+        success &= VERIFY(results[2].tape_length == 0);
+        success &= VERIFY(results[3].tape_start == 2);
+        success &= VERIFY(results[3].tape_length == 2);
+
+        success &= VERIFY(string_equal(tape[results[3].tape_start].argument,
+                                       T("42")));
+
+        /* No handlers should have been called. */
+        success &= VERIFY(intVal == 0);
+
+        dropt_set_result_tape(context, NULL, 0);
+    }
+
+    return success;
+}
+
+
+static bool
+test_dropt_result_tape(dropt_context* context)
 {
+    bool success = true;
     dropt_char** rest;
-    dropt_context* droptContext = NULL;
+    dropt_tape_entry tape[8];
 
-    bool success = test_strings();
-    if (!success) { goto exit; }
+    dropt_char* args[] = { T("-n"), T("--string=foo"), T("-i"), T("42"),
+                           T("-qH"), T("-o=3"), T("-o"), T("file"), NULL };
 
-    droptContext = dropt_new_context(options);
-    if (droptContext == NULL)
+    normalFlag = false;
+    stringVal = NULL;
+    intVal = 0;
+    dropt_set_result_tape(context, tape, ARRAY_LENGTH(tape));
+    rest = dropt_parse(context, -1, args);
+    success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+    success &= VERIFY(rest == &args[7]);
+    success &= VERIFY(dropt_get_tape_length(context) == 7);
+
+    /* No handlers should have been called. */
+    success &= VERIFY(normalFlag == false);
+    success &= VERIFY(stringVal == NULL);
+    success &= VERIFY(intVal == 0);
+
+    success &= VERIFY(dropt_get_options(context)[tape[0].option_index].short_name == T('n'));
+    success &= VERIFY(tape[0].argument == NULL);
+    success &= VERIFY(dropt_get_options(context)[tape[1].option_index].short_name == T('s'));
+    success &= VERIFY(tape[1].argument == args[1] + 9);
+    success &= VERIFY(tape[1].argument_length == 3);
+    success &= VERIFY(dropt_get_options(context)[tape[2].option_index].short_name == T('i'));
+    success &= VERIFY(tape[2].argument == args[3]);
+    success &= VERIFY(tape[2].argument_length == 2);
+    success &= VERIFY(dropt_get_options(context)[tape[3].option_index].short_name == T('q'));
+    success &= VERIFY(dropt_get_options(context)[tape[4].option_index].short_name == T('H'));
+    success &= VERIFY(dropt_get_options(context)[tape[5].option_index].short_name == T('o'));
+    success &= VERIFY(tape[5].argument_length == 1);
+
+    /* Optional arguments must be specified with '='. */
+    success &= VERIFY(dropt_get_options(context)[tape[6].option_index].short_name == T('o'));
+    success &= VERIFY(tape[6].argument == NULL);
+
+    /* Test a tape that's too small. */
+    dropt_set_result_tape(context, tape, 2);
+    rest = dropt_parse(context, -1, args);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_insufficient_memory);
+    success &= VERIFY(dropt_get_tape_length(context) == 2);
+    dropt_clear_error(context);
+
+    dropt_set_result_tape(context, NULL, 0);
+    return success;
+}
+
+
+typedef struct
+{
+    size_t numAllocations;
+    size_t numOutstanding;
+} allocation_counts;
+
+
+static void*
+counting_reallocate(void* userData, void* p, size_t size)
+{
+    allocation_counts* counts = userData;
+    void* q = realloc(p, size);
+    if (p == NULL && q != NULL)
+    {
+        counts->numAllocations++;
+        counts->numOutstanding++;
+    }
+    return q;
+}
+
+
+static void
+counting_deallocate(void* userData, void* p)
+{
+    allocation_counts* counts = userData;
+    counts->numOutstanding--;
+    free(p);
+}
+
+
+static bool
+test_allocators(void)
+{
+    bool success = true;
+    dropt_context* context;
+    allocation_counts contextCounts = { 0 };
+    allocation_counts globalCounts = { 0 };
+    dropt_allocator contextAllocator;
+    dropt_allocator globalAllocator;
+    dropt_char* args[] = { T("--bogus"), NULL };
+
+    contextAllocator.reallocate = counting_reallocate;
+    contextAllocator.deallocate = counting_deallocate;
+    contextAllocator.user_data = &contextCounts;
+
+    globalAllocator = contextAllocator;
+    globalAllocator.user_data = &globalCounts;
+
+    /* Test a per-context allocator. */
+    context = dropt_new_context(options);
+    if (context == NULL)
     {
         fputts(T("Insufficient memory.\n"), stderr);
-        success = false;
-        goto exit;
+        return false;
     }
 
-    success = test_dropt_handlers(droptContext);
-    if (!success) { goto exit; }
+    dropt_set_context_allocator(context, &contextAllocator);
+    dropt_parse(context, -1, args);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+    success &= VERIFY(contextCounts.numAllocations != 0);
+    success &= VERIFY(contextCounts.numOutstanding != 0);
+    dropt_free_context(context);
+    success &= VERIFY(contextCounts.numOutstanding == 0);
 
-    dropt_set_error_handler(droptContext, my_dropt_error_handler, NULL);
+    /* Test the global allocator. */
+    dropt_set_allocator(&globalAllocator);
+    context = dropt_new_context(options);
+    if (context == NULL)
+    {
+        dropt_set_allocator(NULL);
+        fputts(T("Insufficient memory.\n"), stderr);
+        return false;
+    }
 
-    init_option_defaults();
-    success = test_dropt_parse(droptContext);
+    dropt_parse(context, -1, args);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+#ifndef DROPT_NO_STRING_BUFFERS
+    success &= VERIFY(dropt_get_error_message(context) != NULL);
+    {
+        dropt_char* help = dropt_get_help(context, NULL);
+        success &= VERIFY(help != NULL);
+        dropt_free(help);
+    }
+#endif
+    dropt_free_context(context);
+    dropt_set_allocator(NULL);
+
+    success &= VERIFY(globalCounts.numAllocations != 0);
+    success &= VERIFY(globalCounts.numOutstanding == 0);
+    success &= VERIFY(contextCounts.numOutstanding == 0);
+
+    return success;
+}
+
+
+static bool
+test_arena_context(void)
+{
+    bool success = true;
+    dropt_context* context;
+    allocation_counts globalCounts = { 0 };
+    dropt_allocator globalAllocator;
+    size_t arenaSize = dropt_arena_size(options);
+    void* arena = malloc(arenaSize);
+    dropt_char* goodArgs[] = { T("--normalFlag"), T("-n"), NULL };
+    dropt_char* badArgs[] = { T("--bogus=some-argument"), NULL };
+    int i;
+
+    success &= VERIFY(arenaSize != 0);
+    if (arena == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        return false;
+    }
+
+    globalAllocator.reallocate = counting_reallocate;
+    globalAllocator.deallocate = counting_deallocate;
+    globalAllocator.user_data = &globalCounts;
+
+    /* A context in a caller-supplied arena shouldn't touch the heap. */
+    dropt_set_allocator(&globalAllocator);
+    context = dropt_new_context_in_arena(options, arena, arenaSize);
+    if (context == NULL)
+    {
+        dropt_set_allocator(NULL);
+        free(arena);
+        fputts(T("Insufficient memory.\n"), stderr);
+        return false;
+    }
+
+    for (i = 0; i < 3; i++)
+    {
+        dropt_char* optionName = NULL;
+
+        dropt_parse(context, -1, goodArgs);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_none);
+        dropt_reset_context(context);
+
+        dropt_parse(context, -1, badArgs);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        dropt_get_error_details(context, &optionName, NULL);
+        success &= VERIFY(optionName != NULL && dropt_strcmp(optionName, T("--bogus")) == 0);
+        dropt_reset_context(context);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_none);
+    }
+
+    dropt_free_context(context);
+    success &= VERIFY(globalCounts.numAllocations == 0);
+
+    /* A context in static storage shouldn't touch the heap either. */
+    {
+        static union
+        {
+            double alignDouble;
+            void* alignPointer;
+            long alignLong;
+            unsigned char bytes[16384];
+        } storage;
+
+        size_t contextSize = dropt_context_size(ARRAY_LENGTH(options) - 1, 32);
+        success &= VERIFY(contextSize >= arenaSize);
+        success &= VERIFY(contextSize <= sizeof storage);
+        success &= VERIFY(dropt_init_context_in(&storage, arenaSize - 1,
+                                                options) == NULL);
+
+        context = dropt_init_context_in(&storage, sizeof storage, options);
+        success &= VERIFY(context != NULL);
+        if (context != NULL)
+        {
+            dropt_defer_error_details(context, 1);
+            dropt_parse(context, -1, badArgs);
+            success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+            dropt_free_context(context);
+        }
+        success &= VERIFY(globalCounts.numAllocations == 0);
+    }
+
+    /* A dropt-allocated arena should be one allocation. */
+    context = dropt_new_context_in_arena(options, NULL, 0);
+    success &= VERIFY(context != NULL);
+    if (context != NULL)
+    {
+        dropt_parse(context, -1, badArgs);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        dropt_free_context(context);
+    }
+    dropt_set_allocator(NULL);
+
+    success &= VERIFY(globalCounts.numAllocations == 1);
+    success &= VERIFY(globalCounts.numOutstanding == 0);
+
+    free(arena);
+    return success;
+}
+
+
+/* Verifies that a context in a buffer of exactly `dropt_arena_size` bytes
+ * has room for every kind of lookup table.
+ */
+static bool
+test_arena_lookup_tables(void)
+{
+    static dropt_option arenaOptions[400 + 1];
+
+    bool success = true;
+    dropt_context* context;
+    allocation_counts globalCounts = { 0 };
+    dropt_allocator globalAllocator;
+    size_t arenaSize;
+    void* arena;
+
+    memcpy(arenaOptions, generatedOptions,
+           (ARRAY_LENGTH(arenaOptions) - 1) * sizeof *arenaOptions);
+    ZERO_MEMORY(&arenaOptions[ARRAY_LENGTH(arenaOptions) - 1],
+                sizeof arenaOptions[0]);
+
+    arenaSize = dropt_arena_size(arenaOptions);
+    arena = malloc(arenaSize);
+    if (arena == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        return false;
+    }
+
+    globalAllocator.reallocate = counting_reallocate;
+    globalAllocator.deallocate = counting_deallocate;
+    globalAllocator.user_data = &globalCounts;
+
+    dropt_set_allocator(&globalAllocator);
+    context = dropt_init_context_in(arena, arenaSize, arenaOptions);
+    success &= VERIFY(context != NULL);
+    if (context != NULL)
+    {
+        dropt_char* exactArgs[] = { T("--OPT12"), NULL };
+        dropt_char* ambiguousArgs[] = { T("--opt00"), NULL };
+
+        dropt_defer_error_details(context, 1);
+        dropt_set_case_insensitive(context, 1);
+        dropt_allow_abbreviations(context, 1);
+        dropt_enable_hashed_lookup(context, 1);
+
+        generatedVal = 0;
+        dropt_parse(context, -1, exactArgs);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_none);
+        success &= VERIFY(generatedVal == 21);
+
+        dropt_parse(context, -1, ambiguousArgs);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_ambiguous_option);
+        dropt_reset_context(context);
+
+        dropt_free_context(context);
+    }
+    dropt_set_allocator(NULL);
+
+    success &= VERIFY(globalCounts.numAllocations == 0);
+
+    free(arena);
+    return success;
+}
+
+
+static bool
+test_deferred_error_details(void)
+{
+    bool success = true;
+    dropt_context* context;
+    allocation_counts counts = { 0 };
+    dropt_allocator allocator;
+    dropt_error_location location;
+    size_t numAllocations;
+    dropt_char* optionName = NULL;
+    dropt_char* optionArgument = NULL;
+
+    dropt_char* goodArgs[] = { T("-n"), NULL };
+    dropt_char* missingArgs[] = { T("-n"), T("--int"), T("abc"), NULL };
+    dropt_char* equalsArgs[] = { T("--int=zz"), NULL };
+    dropt_char* shortArgs[] = { T("-n"), T("-nqx"), NULL };
+
+    allocator.reallocate = counting_reallocate;
+    allocator.deallocate = counting_deallocate;
+    allocator.user_data = &counts;
+
+    context = dropt_new_context(options);
+    if (context == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        return false;
+    }
+
+    dropt_set_context_allocator(context, &allocator);
+    dropt_defer_error_details(context, 1);
+    dropt_parse(context, -1, goodArgs);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_none);
+    success &= VERIFY(!dropt_get_error_location(context, &location));
+    numAllocations = counts.numAllocations;
+
+    /* An argument taken from the next item. */
+    dropt_parse(context, -1, missingArgs);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_mismatch);
+    success &= VERIFY(counts.numAllocations == numAllocations);
+    success &= VERIFY(dropt_get_error_location(context, &location));
+    success &= VERIFY(location.option_index == 1);
+    success &= VERIFY(location.option_offset == 0);
+    success &= VERIFY(location.option_length == 5);
+    success &= VERIFY(location.has_argument);
+    success &= VERIFY(location.argument_index == 2);
+    success &= VERIFY(location.argument_offset == 0);
+
+    dropt_get_error_details(context, &optionName, &optionArgument);
+    success &= VERIFY(optionName != NULL && dropt_strcmp(optionName, T("--int")) == 0);
+    success &= VERIFY(optionArgument != NULL && dropt_strcmp(optionArgument, T("abc")) == 0);
+    success &= VERIFY(dropt_get_error_location(context, &location));
+    dropt_clear_error(context);
+    success &= VERIFY(!dropt_get_error_location(context, &location));
+
+    /* An argument specified with '='. */
+    numAllocations = counts.numAllocations;
+    dropt_parse(context, -1, equalsArgs);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_mismatch);
+    success &= VERIFY(counts.numAllocations == numAllocations);
+    success &= VERIFY(dropt_get_error_location(context, &location));
+    success &= VERIFY(location.option_index == 0);
+    success &= VERIFY(location.option_length == 5);
+    success &= VERIFY(location.argument_index == 0);
+    success &= VERIFY(location.argument_offset == 6);
+
+    /* A short option in a group. */
+    dropt_parse(context, -1, shortArgs);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+    success &= VERIFY(counts.numAllocations == numAllocations);
+    success &= VERIFY(dropt_get_error_location(context, &location));
+    success &= VERIFY(location.option_index == 1);
+    success &= VERIFY(location.option_offset == 3);
+    success &= VERIFY(location.option_length == 1);
+    success &= VERIFY(!location.has_argument);
+
+#ifndef DROPT_NO_STRING_BUFFERS
+    success &= VERIFY(dropt_strcmp(dropt_get_error_message(context),
+                                   T("Invalid option: -x")) == 0);
+#endif
+
+    dropt_free_context(context);
+    success &= VERIFY(counts.numOutstanding == 0);
+    return success;
+}
+
+
+static bool
+test_split_command_line(void)
+{
+    bool success = true;
+    dropt_char buffer[128];
+    dropt_char* argv[8];
+    size_t n;
+
+    /* Long runs exercise the block scanning. */
+    const dropt_char* longArg = T("--a-rather-long-option-name-that-spans-blocks");
+    dropt_char line[128] = T("  --a-rather-long-option-name-that-spans-blocks\t'a b'\n");
+
+    n = dropt_split_command_line(line, dropt_quoting_gnu, buffer,
+                                 argv, ARRAY_LENGTH(argv));
+    success &= VERIFY(n == 2);
+    success &= VERIFY(dropt_strcmp(argv[0], longArg) == 0);
+    success &= VERIFY(dropt_strcmp(argv[1], T("a b")) == 0);
+    success &= VERIFY(argv[2] == NULL);
+
+    /* Split in place. */
+    n = dropt_split_command_line(line, dropt_quoting_gnu, line,
+                                 argv, ARRAY_LENGTH(argv));
+    success &= VERIFY(n == 2);
+    success &= VERIFY(argv[0] == line);
+    success &= VERIFY(dropt_strcmp(argv[0], longArg) == 0);
+    success &= VERIFY(dropt_strcmp(argv[1], T("a b")) == 0);
+
+    n = dropt_split_command_line(T("a\\ b 'c\\'d' \"e\\f\""),
+                                 dropt_quoting_gnu, buffer,
+                                 argv, ARRAY_LENGTH(argv));
+    success &= VERIFY(n == 3);
+    success &= VERIFY(dropt_strcmp(argv[0], T("a b")) == 0);
+    success &= VERIFY(dropt_strcmp(argv[1], T("c'd")) == 0);
+    success &= VERIFY(dropt_strcmp(argv[2], T("ef")) == 0);
+
+    n = dropt_split_command_line(T("a\\ b 'c\\d' \"e\\f\\$\" g\\\nh \"\""),
+                                 dropt_quoting_posix, buffer,
+                                 argv, ARRAY_LENGTH(argv));
+    success &= VERIFY(n == 5);
+    success &= VERIFY(dropt_strcmp(argv[0], T("a b")) == 0);
+    success &= VERIFY(dropt_strcmp(argv[1], T("c\\d")) == 0);
+    success &= VERIFY(dropt_strcmp(argv[2], T("e\\f$")) == 0);
+    success &= VERIFY(dropt_strcmp(argv[3], T("gh")) == 0);
+    success &= VERIFY(dropt_strcmp(argv[4], T("")) == 0);
+
+    n = dropt_split_command_line(T("a\\\\b \"c d\" e\\\"f \"g\"\"h\" i\\\\\\\\\"j k\""),
+                                 dropt_quoting_msvc, buffer,
+                                 argv, ARRAY_LENGTH(argv));
+    success &= VERIFY(n == 5);
+    success &= VERIFY(dropt_strcmp(argv[0], T("a\\\\b")) == 0);
+    success &= VERIFY(dropt_strcmp(argv[1], T("c d")) == 0);
+    success &= VERIFY(dropt_strcmp(argv[2], T("e\"f")) == 0);
+    success &= VERIFY(dropt_strcmp(argv[3], T("g\"h")) == 0);
+    success &= VERIFY(dropt_strcmp(argv[4], T("i\\\\j k")) == 0);
+
+    /* Test an argument list that's too small. */
+    n = dropt_split_command_line(T("a b c"), dropt_quoting_posix, buffer,
+                                 argv, 2);
+    success &= VERIFY(n == 3);
+    success &= VERIFY(dropt_strcmp(argv[0], T("a")) == 0);
+    success &= VERIFY(argv[1] == NULL);
+
+    n = dropt_split_command_line(T(" \t "), dropt_quoting_posix, buffer,
+                                 argv, ARRAY_LENGTH(argv));
+    success &= VERIFY(n == 0);
+    success &= VERIFY(argv[0] == NULL);
+
+    return success;
+}
+
+
+/* An argument source over `NUL`-delimited arguments, as from `xargs -0`. */
+typedef struct
+{
+    dropt_char* p;
+    dropt_char* end;
+    size_t numPeeks;
+} nul_delimited_source;
+
+
+static dropt_char*
+nul_delimited_peek(void* sourceData)
+{
+    nul_delimited_source* source = sourceData;
+    source->numPeeks++;
+    return (source->p < source->end) ? source->p : NULL;
+}
+
+
+static void
+nul_delimited_next(void* sourceData)
+{
+    nul_delimited_source* source = sourceData;
+    source->p += dropt_strlen(source->p) + 1;
+}
+
+
+static bool
+test_dropt_parse_source(dropt_context* context)
+{
+    bool success = true;
+    dropt_arg_source source;
+    nul_delimited_source data;
+    dropt_char* optionName = NULL;
+
+    dropt_char args[] = T("--int\0") T("42\0") T("-n\0") T("file\0") T("-q");
+    dropt_char badArgs[] = T("-q\0") T("--bogus");
+
+    source.peek = nul_delimited_peek;
+    source.next = nul_delimited_next;
+    source.source_data = &data;
+
+    data.p = args;
+    data.end = args + ARRAY_LENGTH(args);
+    data.numPeeks = 0;
+
+    intVal = 0;
+    normalFlag = false;
+    quiet = false;
+    success &= VERIFY(dropt_parse_source(context, &source) == dropt_error_none);
+    success &= VERIFY(intVal == 42);
+    success &= VERIFY(normalFlag == true);
+    success &= VERIFY(quiet == false);
+    success &= VERIFY(data.p != NULL && dropt_strcmp(data.p, T("file")) == 0);
+    success &= VERIFY(data.numPeeks != 0);
+
+    /* Error details can't be deferred for sources. */
+    data.p = badArgs;
+    data.end = badArgs + ARRAY_LENGTH(badArgs);
+    dropt_defer_error_details(context, 1);
+    success &= VERIFY(dropt_parse_source(context, &source) == dropt_error_invalid_option);
+    dropt_get_error_details(context, &optionName, NULL);
+    success &= VERIFY(optionName != NULL && dropt_strcmp(optionName, T("--bogus")) == 0);
+    success &= VERIFY(data.p == badArgs + ARRAY_LENGTH(badArgs));
+    dropt_defer_error_details(context, 0);
+    dropt_clear_error(context);
+
+    return success;
+}
+
+
+static bool
+test_dropt_parse_chunk(dropt_context* context)
+{
+    bool success = true;
+    dropt_char** rest = NULL;
+    dropt_char* optionName = NULL;
+
+    dropt_char* chunk1[] = { T("-n"), T("--int"), NULL };
+    dropt_char* chunk2[] = { T("42"), T("-qs"), NULL };
+    dropt_char* chunk3[] = { T("hello"), T("-o"), NULL };
+    dropt_char* chunk4[] = { T("7"), T("file"), T("-n"), NULL };
+    dropt_char* chunk5[] = { T("-q"), NULL };
+    dropt_char* badChunk[] = { T("abc"), NULL };
+
+    /* An option's value can arrive in a later chunk. */
+    intVal = 0;
+    normalFlag = false;
+    quiet = false;
+    stringVal = NULL;
+    optionalUInt.is_set = false;
+    optionalUInt.value = 0;
+    dropt_begin_incremental_parse(context);
+    success &= VERIFY(dropt_parse_chunk(context, -1, chunk1, &rest) == dropt_chunk_need_argument);
+    success &= VERIFY(rest == &chunk1[2]);
+    success &= VERIFY(normalFlag == true);
+    success &= VERIFY(dropt_parse_chunk(context, 0, NULL, &rest) == dropt_chunk_need_argument);
+    success &= VERIFY(dropt_parse_chunk(context, -1, chunk2, &rest) == dropt_chunk_need_argument);
+    success &= VERIFY(intVal == 42);
+    success &= VERIFY(quiet == true);
+    success &= VERIFY(dropt_parse_chunk(context, -1, chunk3, &rest) == dropt_chunk_need_argument);
+    success &= VERIFY(stringVal != NULL && dropt_strcmp(stringVal, T("hello")) == 0);
+    success &= VERIFY(optionalUInt.is_set == false);
+
+    /* Parsing stops at the first non-option argument. */
+    normalFlag = false;
+    success &= VERIFY(dropt_parse_chunk(context, -1, chunk4, &rest) == dropt_chunk_done);
+    success &= VERIFY(optionalUInt.is_set == true && optionalUInt.value == 7);
+    success &= VERIFY(rest == &chunk4[1]);
+    success &= VERIFY(normalFlag == false);
+    quiet = false;
+    success &= VERIFY(dropt_parse_chunk(context, -1, chunk5, &rest) == dropt_chunk_done);
+    success &= VERIFY(rest == &chunk5[0]);
+    success &= VERIFY(quiet == false);
+    success &= VERIFY(dropt_end_incremental_parse(context) == dropt_error_none);
+
+    /* An optional value can be omitted at the end of the input. */
+    optionalUInt.is_set = false;
+    optionalUInt.value = 0;
+    dropt_begin_incremental_parse(context);
+    success &= VERIFY(dropt_parse_chunk(context, -1, chunk3 + 1, &rest) == dropt_chunk_need_argument);
+    success &= VERIFY(dropt_end_incremental_parse(context) == dropt_error_none);
+    success &= VERIFY(optionalUInt.is_set == true && optionalUInt.value == 0);
+
+    /* A required value can't. */
+    dropt_begin_incremental_parse(context);
+    success &= VERIFY(dropt_parse_chunk(context, -1, chunk1, &rest) == dropt_chunk_need_argument);
+    success &= VERIFY(dropt_end_incremental_parse(context) == dropt_error_insufficient_arguments);
+    dropt_get_error_details(context, &optionName, NULL);
+    success &= VERIFY(optionName != NULL && dropt_strcmp(optionName, T("--int")) == 0);
+    dropt_clear_error(context);
+
+    /* Errors in a later chunk report the option from the earlier one. */
+    dropt_begin_incremental_parse(context);
+    success &= VERIFY(dropt_parse_chunk(context, 1, chunk2 + 1, &rest) == dropt_chunk_need_argument);
+    success &= VERIFY(dropt_parse_chunk(context, -1, badChunk, &rest) == dropt_chunk_parsed);
+    success &= VERIFY(stringVal != NULL && dropt_strcmp(stringVal, T("abc")) == 0);
+    success &= VERIFY(dropt_parse_chunk(context, 1, chunk1 + 1, &rest) == dropt_chunk_need_argument);
+    success &= VERIFY(dropt_parse_chunk(context, -1, badChunk, &rest) == dropt_chunk_done);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_mismatch);
+    dropt_get_error_details(context, &optionName, NULL);
+    success &= VERIFY(optionName != NULL && dropt_strcmp(optionName, T("--int")) == 0);
+    success &= VERIFY(dropt_end_incremental_parse(context) == dropt_error_mismatch);
+    dropt_clear_error(context);
+
+    return success;
+}
+
+
+static bool
+write_file(const char* path, const char* contents)
+{
+    FILE* fp = fopen(path, "wb");
+    bool success;
+
+    if (fp == NULL) { return false; }
+    success = fputs(contents, fp) >= 0;
+    return (fclose(fp) == 0) && success;
+}
+
+
+/** make_temp_file
+  *
+  *     Creates an empty file with a unique name in the temporary directory.
+  *
+  * PARAMETERS:
+  *     OUT path : On output, the path to the file.
+  *                Must have room for `max_temp_path_length` characters.
+  *
+  * RETURNS:
+  *     true on success, false on failure.
+  */
+static bool
+make_temp_file(char* path)
+{
+#ifdef HAVE_MKSTEMP
+    static const char fileName[] = "/test_dropt_XXXXXX";
+    const char* dir = getenv("TMPDIR");
+    int fd;
+
+    if (dir == NULL || dir[0] == '\0') { dir = "/tmp"; }
+    if (strlen(dir) + sizeof fileName > max_temp_path_length) { return false; }
+
+    strcpy(path, dir);
+    strcat(path, fileName);
+    fd = mkstemp(path);
+    if (fd < 0) { return false; }
+    return close(fd) == 0;
+#else
+    char* name = tmpnam(NULL);
+    if (name == NULL || strlen(name) >= max_temp_path_length) { return false; }
+    strcpy(path, name);
+    return write_file(path, "");
+#endif
+}
+
+
+/** quote_path
+  *
+  *     Quotes a path so that it can be read back from a response file with
+  *     either GNU or MSVC quoting.  Backslashes are escaped for GNU quoting.
+  *
+  * PARAMETERS:
+  *     OUT quoted : On output, '@' followed by the quoted path.
+  *                  Must have room for `2 * max_temp_path_length + 4`
+  *                    characters.
+  *     IN path    : The path.
+  */
+static void
+quote_path(char* quoted, const char* path)
+{
+    *quoted++ = '"';
+    *quoted++ = '@';
+    for (; *path != '\0'; path++)
+    {
+        if (*path == '\\' || *path == '"') { *quoted++ = '\\'; }
+        *quoted++ = *path;
+    }
+    *quoted++ = '"';
+    *quoted = '\0';
+}
+
+
+/** make_response_file_arg
+  *
+  *     Converts a path to an argument that names a response file.
+  *
+  * PARAMETERS:
+  *     OUT arg : On output, '@' followed by the path.
+  *               Must have room for `max_temp_path_length + 1` characters.
+  *     IN path : The path.
+  */
+static void
+make_response_file_arg(dropt_char* arg, const char* path)
+{
+    arg[0] = T('@');
+#ifdef DROPT_USE_WCHAR
+    mbstowcs(&arg[1], path, max_temp_path_length);
+#else
+    strcpy(&arg[1], path);
+#endif
+}
+
+
+static bool
+test_response_files(void)
+{
+    bool success = true;
+    dropt_context* context = NULL;
+    dropt_char** rest;
+    size_t i;
+
+    /* Response files are created in the temporary directory:
+     * 1. GNU quoting, including file 2.
+     * 2. A single option.
+     * 3. MSVC quoting.
+     * 4. Includes itself.
+     * 5. Doesn't exist.
+     * 6. Many options.
+     */
+    char paths[6][max_temp_path_length];
+    size_t numPaths = 0;
+    char quoted[2 * max_temp_path_length + 4];
+    char contents[3 * max_temp_path_length];
+    dropt_char args[6][max_temp_path_length + 1];
+
+    dropt_char* gnuArgs[] = { T("-q"), args[0], T("file2"), NULL };
+    dropt_char* msvcArgs[] = { args[2], NULL };
+    dropt_char* missingArgs[] = { T("-n"), args[4], NULL };
+    dropt_char* recursiveArgs[] = { args[3], NULL };
+    dropt_char* singleArgs[] = { args[1], NULL };
+    dropt_char* manyArgs[] = { args[5], args[1], NULL };
+
+    for (numPaths = 0; numPaths < ARRAY_LENGTH(paths); numPaths++)
+    {
+        if (!make_temp_file(paths[numPaths])) { break; }
+        make_response_file_arg(args[numPaths], paths[numPaths]);
+    }
+    if (numPaths < ARRAY_LENGTH(paths))
+    {
+        fputts(T("Unable to create temporary files.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    remove(paths[4]);
+
+    strcpy(contents, "--int=42 \"-s\" 'hello world'\n");
+    quote_path(quoted, paths[1]);
+    strcat(contents, quoted);
+    strcat(contents, " file\\ 1");
+    if (   !write_file(paths[0], contents)
+        || !write_file(paths[1], "-n\n")
+        || !write_file(paths[2], "-s \"a \\\"b\\\" c\\\\\" \"x\"\"y\" \\\\z"))
+    {
+        fputts(T("Unable to write response files.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    strcpy(contents, "-n ");
+    quote_path(quoted, paths[3]);
+    strcat(contents, quoted);
+    if (!write_file(paths[3], contents))
+    {
+        fputts(T("Unable to write response files.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    contents[0] = '\0';
+    for (i = 0; i < 20; i++) { strcat(contents, "-n "); }
+    if (!write_file(paths[5], contents))
+    {
+        fputts(T("Unable to write response files.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    context = dropt_new_context(options);
+    if (context == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    /* Response files should be ignored unless enabled. */
+    rest = dropt_parse(context, -1, gnuArgs);
+    success &= VERIFY(rest == &gnuArgs[1]);
+
+    dropt_enable_response_files(context, dropt_quoting_gnu, 0);
+
+    quiet = false;
+    normalFlag = false;
+    intVal = 0;
+    stringVal = NULL;
+    rest = dropt_parse(context, -1, gnuArgs);
+    success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+    success &= VERIFY(quiet == true);
+    success &= VERIFY(intVal == 42);
+    success &= VERIFY(stringVal != NULL && dropt_strcmp(stringVal, T("hello world")) == 0);
+    success &= VERIFY(normalFlag == true);
+    success &= VERIFY(rest[0] != NULL && dropt_strcmp(rest[0], T("file 1")) == 0);
+    success &= VERIFY(rest[1] == gnuArgs[2]);
+    success &= VERIFY(rest[2] == NULL);
+
+    /* Files that can't be read should be left alone. */
+    rest = dropt_parse(context, -1, missingArgs);
+    success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+    success &= VERIFY(rest[0] != NULL && dropt_strcmp(rest[0], missingArgs[1]) == 0);
+
+    rest = dropt_parse(context, -1, recursiveArgs);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_response_file_depth);
+    success &= VERIFY(rest == recursiveArgs);
+    dropt_clear_error(context);
+
+    dropt_enable_response_files(context, dropt_quoting_msvc, 1);
+    stringVal = NULL;
+    rest = dropt_parse(context, -1, msvcArgs);
+    success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+    success &= VERIFY(stringVal != NULL && dropt_strcmp(stringVal, T("a \"b\" c\\")) == 0);
+    success &= VERIFY(rest[0] != NULL && dropt_strcmp(rest[0], T("x\"y")) == 0);
+    success &= VERIFY(rest[1] != NULL && dropt_strcmp(rest[1], T("\\\\z")) == 0);
+    success &= VERIFY(rest[2] == NULL);
+
+    /* Nesting should be limited. */
+    rest = dropt_parse(context, -1, gnuArgs);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_response_file_depth);
+    dropt_clear_error(context);
+
+    /* Resetting an arena-based context reclaims the expanded arguments, so
+     * later expansions must not reuse them.
+     */
+    dropt_free_context(context);
+    context = dropt_new_context_in_arena(options, NULL, 0);
+    if (context == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    dropt_enable_response_files(context, dropt_quoting_gnu, 0);
+    for (i = 0; i < 3; i++)
+    {
+        rest = dropt_parse(context, -1, singleArgs);
+        success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+        success &= VERIFY(rest != NULL && *rest == NULL);
+        dropt_reset_context(context);
+
+        rest = dropt_parse(context, -1, manyArgs);
+        success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+        success &= VERIFY(rest != NULL && *rest == NULL);
+        dropt_reset_context(context);
+    }
+
+exit:
+    dropt_free_context(context);
+    for (i = 0; i < numPaths; i++) { remove(paths[i]); }
+    return success;
+}
+
+
+static void
+init_generated_options(void)
+{
+    size_t i;
+    for (i = 0; i < num_generated_options; i++)
+    {
+        /* Write the digits in reverse so that the table isn't already
+         * sorted.
+         */
+        dropt_char* p = generatedNames[i];
+        size_t n = i;
+
+        *p++ = T('o');
+        *p++ = T('p');
+        *p++ = T('t');
+        do
+        {
+            *p++ = (dropt_char) (T('0') + n % 10);
+            n /= 10;
+        } while (n != 0);
+        *p = T('\0');
+
+        ZERO_MEMORY(&generatedOptions[i], sizeof generatedOptions[i]);
+        generatedOptions[i].long_name = generatedNames[i];
+        if (i < num_generated_short_names)
+        {
+            /* Exercise characters beyond 7-bit ASCII. */
+            generatedOptions[i].short_name = (dropt_char) (0x80 + i);
+        }
+        generatedOptions[i].description = generatedNames[i];
+        generatedOptions[i].handler = dropt_handle_const;
+        generatedOptions[i].dest = &generatedVal;
+        generatedOptions[i].extra_data = i;
+    }
+
+    ZERO_MEMORY(&generatedOptions[num_generated_options],
+                sizeof generatedOptions[num_generated_options]);
+}
+
+
+static bool
+test_generated_option_lookups(dropt_context* context)
+{
+    bool success = true;
+    dropt_char** rest;
+    size_t i;
+
+    for (i = 0; i < num_generated_options; i++)
+    {
+        dropt_char buf[32] = T("--");
+        dropt_char* args[] = { buf, NULL };
+        tcsncat(buf, generatedNames[i], ARRAY_LENGTH(buf) - 3);
+
+        generatedVal = (dropt_uintptr) -1;
+        rest = dropt_parse(context, -1, args);
+        if (   !VERIFY(get_and_print_dropt_error(context) == dropt_error_none)
+            || !VERIFY(generatedVal == i)
+            || !VERIFY(*rest == NULL))
+        {
+            success = false;
+            break;
+        }
+    }
+
+    for (i = 0; i < num_generated_short_names; i++)
+    {
+        dropt_char buf[] = T("-?");
+        dropt_char* args[] = { buf, NULL };
+        buf[1] = generatedOptions[i].short_name;
+
+        generatedVal = (dropt_uintptr) -1;
+        rest = dropt_parse(context, -1, args);
+        if (   !VERIFY(get_and_print_dropt_error(context) == dropt_error_none)
+            || !VERIFY(generatedVal == i)
+            || !VERIFY(*rest == NULL))
+        {
+            success = false;
+            break;
+        }
+    }
+
+    {
+        dropt_char* args[] = { T("-x"), NULL };
+        rest = dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        dropt_clear_error(context);
+    }
+
+    {
+        dropt_char* args[] = { T("--opt"), NULL };
+        rest = dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        dropt_clear_error(context);
+    }
+
+    {
+        dropt_char* args[] = { T("--opt1234567"), NULL };
+        rest = dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        dropt_clear_error(context);
+    }
+
+    {
+        dropt_char* args[] = { T("--opt21=1"), NULL };
+        rest = dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_mismatch);
+        dropt_clear_error(context);
+    }
+
+    return success;
+}
+
+
+static bool
+test_frozen_context(dropt_context* context)
+{
+    bool success = true;
+    dropt_context* parseContext1 = NULL;
+    dropt_context* parseContext2 = NULL;
+
+    success &= VERIFY(dropt_freeze_context(context) == dropt_error_none);
+    success &= VERIFY(dropt_freeze_context(context) == dropt_error_none);
+
+    parseContext1 = dropt_new_parse_context(context);
+    parseContext2 = dropt_new_parse_context(context);
+    if (parseContext1 == NULL || parseContext2 == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    success &= test_generated_option_lookups(parseContext1);
+
+    /* Errors should be tracked separately for each parse context. */
+    {
+        dropt_char* args[] = { T("--opt1234567"), NULL };
+        dropt_parse(parseContext1, -1, args);
+        success &= VERIFY(dropt_get_error(parseContext1) == dropt_error_invalid_option);
+        success &= VERIFY(dropt_get_error(parseContext2) == dropt_error_none);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_none);
+    }
+
+    /* A parse context may change its own settings without affecting the
+     * frozen context's shared lookup tables.
+     */
+    dropt_set_strncmp(parseContext2, dropt_strnicmp);
+    success &= test_generated_option_lookups(parseContext2);
+
+    dropt_clear_error(parseContext1);
+    success &= test_generated_option_lookups(parseContext1);
+
+#ifdef NDEBUG
+    /* Frozen contexts can't be used for parsing directly.  (Misuse aborts
+     * in debug builds.)
+     */
+    {
+        dropt_char* args[] = { T("--opt1234567"), NULL };
+        dropt_char** argvs[1];
+        dropt_parse_result result;
+
+        argvs[0] = args;
+
+        success &= VERIFY(dropt_parse(context, -1, args) == args);
+        success &= VERIFY(dropt_parse_batch(context, 1, NULL, argvs, &result) == 1);
+        success &= VERIFY(result.err == dropt_error_bad_configuration);
+
+        dropt_begin_incremental_parse(context);
+        success &= VERIFY(dropt_parse_chunk(context, -1, args, NULL)
+                          == dropt_chunk_done);
+        success &= VERIFY(dropt_end_incremental_parse(context)
+                          == dropt_error_bad_configuration);
+
+        dropt_reset_context(context);
+        dropt_clear_error(context);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_none);
+    }
+#endif
+
+    /* Each parse context should record to its own result tape. */
+    {
+        dropt_tape_entry tape1[2];
+        dropt_tape_entry tape2[2];
+        dropt_char* args1[] = { T("--opt1"), NULL };
+        dropt_char* args2[] = { T("--opt22"), T("--opt333"), NULL };
+
+        generatedVal = 0;
+        dropt_set_result_tape(parseContext1, tape1, ARRAY_LENGTH(tape1));
+        dropt_set_result_tape(parseContext2, tape2, ARRAY_LENGTH(tape2));
+        dropt_parse(parseContext1, -1, args1);
+        dropt_parse(parseContext2, -1, args2);
+        success &= VERIFY(get_and_print_dropt_error(parseContext1) == dropt_error_none);
+        success &= VERIFY(get_and_print_dropt_error(parseContext2) == dropt_error_none);
+        success &= VERIFY(dropt_get_tape_length(parseContext1) == 1);
+        success &= VERIFY(dropt_get_tape_length(parseContext2) == 2);
+        success &= VERIFY(dropt_get_tape_length(context) == 0);
+        success &= VERIFY(tape1[0].option_index == 1);
+        success &= VERIFY(tape2[0].option_index == 22);
+        success &= VERIFY(tape2[1].option_index == 333);
+
+        /* No handlers should have been called. */
+        success &= VERIFY(generatedVal == 0);
+
+        dropt_set_result_tape(parseContext1, NULL, 0);
+        dropt_set_result_tape(parseContext2, NULL, 0);
+    }
+
+exit:
+    dropt_free_context(parseContext2);
+    dropt_free_context(parseContext1);
+    return success;
+}
+
+
+static bool
+test_large_option_table(bool hashed)
+{
+    bool success = true;
+    void* index = NULL;
+    size_t indexSize;
+    dropt_context* indexedContext = NULL;
+
+    dropt_context* context = dropt_new_context(generatedOptions);
+    if (context == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        return false;
+    }
+
+    dropt_set_error_handler(context, my_dropt_error_handler, NULL);
+    dropt_enable_hashed_lookup(context, hashed);
+
+    success &= test_generated_option_lookups(context);
+
+    /* Test serialized lookup indices. */
+    indexSize = dropt_serialize_index(context, NULL, 0);
+    success &= VERIFY(indexSize != 0);
+    success &= VERIFY(dropt_serialize_index(context, NULL, indexSize - 1)
+                      == indexSize);
+
+    index = malloc(indexSize);
+    if (index == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    success &= VERIFY(dropt_serialize_index(context, index, indexSize)
+                      == indexSize);
+
+    success &= VERIFY(dropt_new_context_from_index(generatedOptions, index,
+                                                   indexSize - 1) == NULL);
+    success &= VERIFY(dropt_new_context_from_index(options, index,
+                                                   indexSize) == NULL);
+
+    indexedContext = dropt_new_context_from_index(generatedOptions, index,
+                                                  indexSize);
+    if (indexedContext == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    dropt_set_error_handler(indexedContext, my_dropt_error_handler, NULL);
+    success &= test_generated_option_lookups(indexedContext);
+
+    /* The context should discard the borrowed index and build its own. */
+    dropt_set_strncmp(indexedContext, dropt_strnicmp);
+    success &= test_generated_option_lookups(indexedContext);
+
+    success &= test_frozen_context(context);
+
+exit:
+    dropt_free_context(indexedContext);
+    free(index);
+    dropt_free_context(context);
+    return success;
+}
+
+
+/* Serializes the index of `serialized` and verifies that it's rejected for
+ * `other`, which has the same number of options.
+ */
+static bool
+verify_index_mismatch(const dropt_option* serialized,
+                      const dropt_option* other, bool hashed)
+{
+    bool success = true;
+    void* index = NULL;
+    size_t indexSize;
+
+    dropt_context* context = dropt_new_context(serialized);
+    if (context == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        return false;
+    }
+
+    dropt_enable_hashed_lookup(context, hashed);
+    indexSize = dropt_serialize_index(context, NULL, 0);
+    index = malloc(indexSize);
+    if (index == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    success &= VERIFY(dropt_serialize_index(context, index, indexSize)
+                      == indexSize);
+    success &= VERIFY(dropt_new_context_from_index(other, index, indexSize)
+                      == NULL);
+
+exit:
+    free(index);
+    dropt_free_context(context);
+    return success;
+}
+
+
+static bool
+test_mismatched_index(bool hashed)
+{
+    bool success = true;
+    unsigned int* index = NULL;
+    unsigned int* corrupted = NULL;
+    size_t indexSize;
+    size_t longCount;
+    dropt_context* context = NULL;
+    dropt_context* indexedContext = NULL;
+
+    static dropt_bool val;
+
+    static const dropt_option greek[] = {
+        { T('a'), T("alpha"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { T('b'), T("beta"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { T('g'), T("gamma"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { 0 }
+    };
+
+    /* The same length as "gamma". */
+    static const dropt_option renamed[] = {
+        { T('a'), T("alpha"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { T('b'), T("beta"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { T('g'), T("delta"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { 0 }
+    };
+
+    /* Two distinct long names instead of three. */
+    static const dropt_option duplicated[] = {
+        { T('a'), T("alpha"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { T('b'), T("beta"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { T('g'), T("alpha"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { 0 }
+    };
+
+    static const dropt_option reshorted[] = {
+        { T('a'), T("alpha"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { T('b'), T("beta"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { T('x'), T("gamma"), NULL, NULL, dropt_handle_bool, &val, 0, 0 },
+        { 0 }
+    };
+
+    success &= verify_index_mismatch(greek, renamed, hashed);
+    success &= verify_index_mismatch(greek, duplicated, hashed);
+    success &= verify_index_mismatch(duplicated, greek, hashed);
+    success &= verify_index_mismatch(greek, reshorted, hashed);
+
+    /* Corrupt individual entries of an otherwise valid index.  The header
+     * is followed by the lengths of the long names, the option indices, and
+     * then the name prefixes (see dropt_index.h).
+     */
+    context = dropt_new_context(greek);
+    if (context == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        return false;
+    }
+
+    dropt_enable_hashed_lookup(context, hashed);
+    indexSize = dropt_serialize_index(context, NULL, 0);
+    index = malloc(indexSize);
+    corrupted = malloc(indexSize);
+    if (index == NULL || corrupted == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    success &= VERIFY(dropt_serialize_index(context, index, indexSize)
+                      == indexSize);
+    longCount = index[DROPT_INDEX_FIELD_LONG_COUNT];
+    success &= VERIFY(longCount == 3);
+
+    indexedContext = dropt_new_context_from_index(greek, index, indexSize);
+    success &= VERIFY(indexedContext != NULL);
+
+    /* An out-of-range option index. */
+    memcpy(corrupted, index, indexSize);
+    corrupted[DROPT_INDEX_HEADER_LENGTH + longCount] = 3;
+    success &= VERIFY(dropt_new_context_from_index(greek, corrupted,
+                                                   indexSize) == NULL);
+
+    /* A wrong length. */
+    memcpy(corrupted, index, indexSize);
+    corrupted[DROPT_INDEX_HEADER_LENGTH]++;
+    success &= VERIFY(dropt_new_context_from_index(greek, corrupted,
+                                                   indexSize) == NULL);
+
+    /* A wrong prefix. */
+    memcpy(corrupted, index, indexSize);
+    ((dropt_char*) &corrupted[DROPT_INDEX_HEADER_LENGTH + 2 * longCount])[0]
+        = T('z');
+    success &= VERIFY(dropt_new_context_from_index(greek, corrupted,
+                                                   indexSize) == NULL);
+
+    /* Two entries for the same option. */
+    memcpy(corrupted, index, indexSize);
+    corrupted[DROPT_INDEX_HEADER_LENGTH + longCount + 1]
+        = corrupted[DROPT_INDEX_HEADER_LENGTH + longCount];
+    success &= VERIFY(dropt_new_context_from_index(greek, corrupted,
+                                                   indexSize) == NULL);
+
+exit:
+    dropt_free_context(indexedContext);
+    free(corrupted);
+    free(index);
+    dropt_free_context(context);
+    return success;
+}
+
+
+static bool
+test_case_insensitive(bool hashed)
+{
+    bool success = true;
+    dropt_context* context = NULL;
+    dropt_context* parseContext = NULL;
+    dropt_char** rest;
+    size_t i;
+
+    static dropt_uintptr val;
+
+    /* The last name is too long to be folded on the stack. */
+    static dropt_option caseOptions[] = {
+        { T('q'), T("quiet"), NULL, NULL, dropt_handle_const, &val, 0, 1 },
+        { T('Q'), T("Quiet"), NULL, NULL, dropt_handle_const, &val, 0, 2 },
+        { T('v'), T("verbose"), NULL, NULL, dropt_handle_const, &val, 0, 3 },
+        { T('\0'), T("showAllTheThings"), NULL, NULL, dropt_handle_const, &val, 0, 4 },
+        { T('\0'), T("a-very-long-option-name-that-does-not-fit-in-the-folding-buffer"),
+          NULL, NULL, dropt_handle_const, &val, 0, 5 },
+        { 0 }
+    };
+
+    struct
+    {
+        const dropt_char* arg;
+        dropt_uintptr expected;
+    } cases[] = {
+        { T("--quiet"), 1 },
+        { T("--Quiet"), 1 },
+        { T("--QUIET"), 1 },
+        { T("-q"), 1 },
+        { T("-Q"), 1 },
+        { T("-V"), 3 },
+        { T("--VERBOSE"), 3 },
+        { T("--showallthethings"), 4 },
+        { T("--SHOWALLTHETHINGS"), 4 },
+        { T("--A-Very-Long-Option-Name-That-Does-Not-Fit-In-The-Folding-Buffer"), 5 },
+    };
+
+    context = dropt_new_context(caseOptions);
+    if (context == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        return false;
+    }
+
+    dropt_set_error_handler(context, my_dropt_error_handler, NULL);
+    dropt_enable_hashed_lookup(context, hashed);
+
+    {
+        dropt_char* args[] = { T("--QUIET"), NULL };
+        rest = dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        dropt_clear_error(context);
+    }
+
+    dropt_set_case_insensitive(context, 1);
+
+    for (i = 0; i < ARRAY_LENGTH(cases); i++)
+    {
+        dropt_char* args[] = { NULL, NULL };
+        args[0] = (dropt_char*) cases[i].arg;
+
+        val = 0;
+        rest = dropt_parse(context, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+        success &= VERIFY(val == cases[i].expected);
+        success &= VERIFY(*rest == NULL);
+    }
+
+    {
+        dropt_char* args[] = { T("--quie"), NULL };
+        rest = dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        dropt_clear_error(context);
+    }
+
+    {
+        dropt_char* args[] = { T("--A-Very-Long-Option-Name-That-Does-Not-Fit-In-The-Folding-Buffers"), NULL };
+        rest = dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        dropt_clear_error(context);
+    }
+
+    /* Case-insensitive contexts can't be serialized. */
+    success &= VERIFY(dropt_serialize_index(context, NULL, 0) == 0);
+
+    /* Parse contexts should share the folded names. */
+    success &= VERIFY(dropt_freeze_context(context) == dropt_error_none);
+    parseContext = dropt_new_parse_context(context);
+    if (parseContext == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    for (i = 0; i < ARRAY_LENGTH(cases); i++)
+    {
+        dropt_char* args[] = { NULL, NULL };
+        args[0] = (dropt_char*) cases[i].arg;
+
+        val = 0;
+        rest = dropt_parse(parseContext, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(parseContext) == dropt_error_none);
+        success &= VERIFY(val == cases[i].expected);
+    }
+
+    /* Setting a comparison function turns case-insensitivity off. */
+    dropt_set_strncmp(parseContext, NULL);
+    {
+        dropt_char* args[] = { T("-Q"), NULL };
+        val = 0;
+        rest = dropt_parse(parseContext, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(parseContext) == dropt_error_none);
+        success &= VERIFY(val == 2);
+    }
+
+exit:
+    dropt_free_context(parseContext);
+    dropt_free_context(context);
+    return success;
+}
+
+
+static dropt_uintptr abbreviatedVal;
+
+static dropt_option abbreviatedOptions[] = {
+    { T('\0'), T("verbose"), NULL, NULL, dropt_handle_const, &abbreviatedVal, 0, 1 },
+    { T('\0'), T("version"), NULL, NULL, dropt_handle_const, &abbreviatedVal, 0, 2 },
+    { T('\0'), T("quiet"), NULL, NULL, dropt_handle_const, &abbreviatedVal, 0, 3 },
+    { T('\0'), T("query"), NULL, NULL, dropt_handle_const, &abbreviatedVal, 0, 4 },
+    { T('\0'), T("help"), NULL, NULL, dropt_handle_const, &abbreviatedVal, 0, 5 },
+    { T('\0'), T("helpful"), NULL, NULL, dropt_handle_const, &abbreviatedVal, 0, 6 },
+    { 0 }
+};
+
+
+static bool
+test_abbreviated_lookups(dropt_context* context)
+{
+    bool success = true;
+    const dropt_option* candidates[4];
+    size_t i;
+
+    static const struct
+    {
+        const dropt_char* arg;
+        dropt_uintptr expected;
+    } cases[] = {
+        { T("--verbo"), 1 },
+        { T("--vers"), 2 },
+        { T("--version"), 2 },
+        { T("--quie"), 3 },
+        { T("--quer"), 4 },
+        { T("--help"), 5 },
+        { T("--helpf"), 6 },
+    };
+
+    for (i = 0; i < ARRAY_LENGTH(cases); i++)
+    {
+        dropt_char* args[] = { NULL, NULL };
+        args[0] = (dropt_char*) cases[i].arg;
+
+        abbreviatedVal = 0;
+        dropt_parse(context, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+        success &= VERIFY(abbreviatedVal == cases[i].expected);
+    }
+
+    {
+        dropt_char* args[] = { T("--ver"), NULL };
+        dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_ambiguous_option);
+        success &= VERIFY(dropt_get_error_candidates(context, candidates,
+                                                     ARRAY_LENGTH(candidates))
+                          == 2);
+        success &= VERIFY(candidates[0] == &abbreviatedOptions[0]);
+        success &= VERIFY(candidates[1] == &abbreviatedOptions[1]);
+        dropt_clear_error(context);
+        success &= VERIFY(dropt_get_error_candidates(context, NULL, 0) == 0);
+    }
+
+    {
+        dropt_char* args[] = { T("--q=1"), NULL };
+        dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_ambiguous_option);
+        success &= VERIFY(dropt_get_error_candidates(context, candidates, 1) == 2);
+        success &= VERIFY(candidates[0] == &abbreviatedOptions[3]);
+        dropt_clear_error(context);
+    }
+
+    {
+        dropt_char* args[] = { T("--verbosely"), NULL };
+        dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        success &= VERIFY(dropt_get_error_candidates(context, NULL, 0) == 0);
+        dropt_clear_error(context);
+    }
+
+    {
+        dropt_char* args[] = { T("--x"), NULL };
+        dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        dropt_clear_error(context);
+    }
+
+    return success;
+}
+
+
+static bool
+test_abbreviations(bool hashed)
+{
+    bool success = true;
+    dropt_context* context = NULL;
+    dropt_context* parseContext = NULL;
+    dropt_context* generatedContext = NULL;
+
+    context = dropt_new_context(abbreviatedOptions);
+    generatedContext = dropt_new_context(generatedOptions);
+    if (context == NULL || generatedContext == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    dropt_set_error_handler(context, my_dropt_error_handler, NULL);
+    dropt_enable_hashed_lookup(context, hashed);
+
+    {
+        dropt_char* args[] = { T("--verbo"), NULL };
+        dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        dropt_clear_error(context);
+    }
+
+    dropt_allow_abbreviations(context, 1);
+    success &= test_abbreviated_lookups(context);
+
+    /* Custom comparison functions use the sorted index instead of the
+     * trie.
+     */
+    dropt_set_strncmp(context, dropt_strnicmp);
+    success &= test_abbreviated_lookups(context);
+
+    {
+        dropt_char* args[] = { T("--VERBO"), NULL };
+        abbreviatedVal = 0;
+        dropt_parse(context, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+        success &= VERIFY(abbreviatedVal == 1);
+    }
+
+    dropt_set_case_insensitive(context, 1);
+    success &= test_abbreviated_lookups(context);
+
+    {
+        dropt_char* args[] = { T("--QuE"), NULL };
+        abbreviatedVal = 0;
+        dropt_parse(context, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+        success &= VERIFY(abbreviatedVal == 4);
+    }
+
+    /* Parse contexts should share the trie. */
+    success &= VERIFY(dropt_freeze_context(context) == dropt_error_none);
+    parseContext = dropt_new_parse_context(context);
+    if (parseContext == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+    success &= test_abbreviated_lookups(parseContext);
+
+    /* Test a large table, in which every long name shares a prefix. */
+    dropt_set_error_handler(generatedContext, my_dropt_error_handler, NULL);
+    dropt_enable_hashed_lookup(generatedContext, hashed);
+    dropt_allow_abbreviations(generatedContext, 1);
+
+    {
+        /* Exact matches take precedence over abbreviations.  (The generated
+         * names spell the option numbers backwards.)
+         */
+        dropt_char* args[] = { T("--opt92"), T("--opt9992"), NULL };
+        generatedVal = 0;
+        dropt_parse(generatedContext, 1, args);
+        success &= VERIFY(get_and_print_dropt_error(generatedContext) == dropt_error_none);
+        success &= VERIFY(generatedVal == 29);
+        dropt_parse(generatedContext, 1, &args[1]);
+        success &= VERIFY(get_and_print_dropt_error(generatedContext) == dropt_error_none);
+        success &= VERIFY(generatedVal == 2999);
+    }
+
+    {
+        const dropt_option* candidates[1];
+        dropt_char* args[] = { T("--op"), NULL };
+        dropt_parse(generatedContext, -1, args);
+        success &= VERIFY(dropt_get_error(generatedContext) == dropt_error_ambiguous_option);
+        success &= VERIFY(dropt_get_error_candidates(generatedContext, candidates, 1)
+                          == num_generated_options);
+        success &= VERIFY(candidates[0] == &generatedOptions[0]);
+        dropt_clear_error(generatedContext);
+    }
+
+exit:
+    dropt_free_context(generatedContext);
+    dropt_free_context(parseContext);
+    dropt_free_context(context);
+    return success;
+}
+
+
+static dropt_option suggestedOptions[] = {
+    { T('\0'), T("verbose"), NULL, NULL, dropt_handle_const, &abbreviatedVal, 0, 1 },
+    { T('\0'), T("version"), NULL, NULL, dropt_handle_const, &abbreviatedVal, 0, 2 },
+    { T('\0'), T("color"), NULL, NULL, dropt_handle_const, &abbreviatedVal, 0, 3 },
+    { T('\0'), T("secret"), NULL, NULL, dropt_handle_const, &abbreviatedVal, dropt_attr_hidden, 4 },
+    { 0 }
+};
+
+
+static bool
+test_suggestions(void)
+{
+    bool success = true;
+    dropt_context* context = NULL;
+    dropt_context* generatedContext = NULL;
+    const dropt_option* candidates[8];
+
+    context = dropt_new_context(suggestedOptions);
+    generatedContext = dropt_new_context(generatedOptions);
+    if (context == NULL || generatedContext == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    dropt_set_error_handler(context, my_dropt_error_handler, NULL);
+
+    {
+        dropt_char* args[] = { T("--verbsoe"), NULL };
+        dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        success &= VERIFY(dropt_get_error_candidates(context, NULL, 0) == 0);
+        dropt_clear_error(context);
+    }
+
+    dropt_enable_suggestions(context, 4);
+
+    {
+        dropt_char* args[] = { T("--verbsoe"), NULL };
+        dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        success &= VERIFY(dropt_get_error_candidates(context, candidates,
+                                                     ARRAY_LENGTH(candidates))
+                          == 2);
+        success &= VERIFY(candidates[0] == &suggestedOptions[0]);
+        success &= VERIFY(candidates[1] == &suggestedOptions[1]);
+        dropt_clear_error(context);
+    }
+
+    {
+        dropt_char* args[] = { T("--colour=red"), NULL };
+        dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        success &= VERIFY(dropt_get_error_candidates(context, candidates, 1) == 1);
+        success &= VERIFY(candidates[0] == &suggestedOptions[2]);
+        dropt_clear_error(context);
+    }
+
+    /* Hidden options and distant names aren't suggested. */
+    {
+        dropt_char* args[] = { T("--secrte"), T("--xyzzy"), NULL };
+        dropt_parse(context, 1, args);
+        success &= VERIFY(dropt_get_error_candidates(context, NULL, 0) == 0);
+        dropt_clear_error(context);
+        dropt_parse(context, 1, &args[1]);
+        success &= VERIFY(dropt_get_error_candidates(context, NULL, 0) == 0);
+        dropt_clear_error(context);
+    }
+
+    dropt_enable_suggestions(context, 1);
+    dropt_set_case_insensitive(context, 1);
+    dropt_defer_error_details(context, 1);
+
+    {
+        dropt_char* optionName = NULL;
+        dropt_char* args[] = { T("--VERBSOE"), NULL };
+        dropt_parse(context, -1, args);
+        dropt_get_error_details(context, &optionName, NULL);
+        success &= VERIFY(dropt_strcmp(optionName, T("--VERBSOE")) == 0);
+        success &= VERIFY(dropt_get_error_candidates(context, candidates,
+                                                     ARRAY_LENGTH(candidates))
+                          == 1);
+        success &= VERIFY(candidates[0] == &suggestedOptions[0]);
+        dropt_clear_error(context);
+    }
+
+    /* Test a large table. */
+    dropt_set_error_handler(generatedContext, my_dropt_error_handler, NULL);
+    dropt_enable_suggestions(generatedContext, ARRAY_LENGTH(candidates));
+
+    {
+        dropt_char* args[] = { T("--opt12345"), NULL };
+        dropt_parse(generatedContext, -1, args);
+        success &= VERIFY(dropt_get_error(generatedContext) == dropt_error_invalid_option);
+        success &= VERIFY(dropt_get_error_candidates(generatedContext, candidates,
+                                                     ARRAY_LENGTH(candidates))
+                          == ARRAY_LENGTH(candidates));
+        dropt_clear_error(generatedContext);
+    }
+
+exit:
+    dropt_free_context(generatedContext);
+    dropt_free_context(context);
+    return success;
+}
+
+
+static dropt_uintptr subcommandVal;
+static dropt_uintptr subcommandGlobalVal;
+
+static dropt_option subcommandGlobalOptions[] = {
+    { T('v'), T("verbose"), NULL, NULL, dropt_handle_const, &subcommandGlobalVal, 0, 1 },
+    { T('\0'), T("color"), NULL, NULL, dropt_handle_const, &subcommandGlobalVal, 0, 2 },
+    { 0 }
+};
+
+static dropt_option commitOptions[] = {
+    { T('a'), T("all"), NULL, NULL, dropt_handle_const, &subcommandVal, 0, 1 },
+    { T('m'), T("message"), NULL, T("text"), dropt_handle_string, &stringVal, 0, 0 },
+    { 0 }
+};
+
+static dropt_option statusOptions[] = {
+    { T('s'), T("short"), NULL, NULL, dropt_handle_const, &subcommandVal, 0, 2 },
+    { 0 }
+};
+
+static dropt_subcommand subcommands[] = {
+    { T("commit"), commitOptions, T("Record changes.") },
+    { T("status"), statusOptions, T("Show the working tree status.") },
+    { NULL }
+};
+
+static dropt_option verbGlobalOptions[] = {
+    { T('\0'), T("verb"), NULL, NULL, dropt_handle_const, &subcommandGlobalVal, 0, 3 },
+    { 0 }
+};
+
+static dropt_option runOptions[] = {
+    { T('\0'), T("verbatim"), NULL, NULL, dropt_handle_const, &subcommandVal, 0, 3 },
+    { 0 }
+};
+
+static dropt_subcommand runSubcommands[] = {
+    { T("run"), runOptions, NULL },
+    { NULL }
+};
+
+static dropt_subcommand generatedSubcommands[num_generated_options + 1];
+
+
+static bool
+test_subcommands(void)
+{
+    bool success = true;
+    dropt_context* context = NULL;
+    dropt_context* parseContext = NULL;
+    dropt_context* generatedContext = NULL;
+    dropt_context* verbContext = NULL;
+    dropt_context* child;
+    const dropt_subcommand* subcommand;
+    dropt_char** rest;
+    size_t i;
+
+    context = dropt_new_context(subcommandGlobalOptions);
+    generatedContext = dropt_new_context(subcommandGlobalOptions);
+    if (context == NULL || generatedContext == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    dropt_set_error_handler(context, my_dropt_error_handler, NULL);
+    dropt_set_subcommands(context, subcommands);
+
+    success &= VERIFY(dropt_find_subcommand(context, T("commit")) == &subcommands[0]);
+    success &= VERIFY(dropt_find_subcommand(context, T("status")) == &subcommands[1]);
+    success &= VERIFY(dropt_find_subcommand(context, T("stat")) == NULL);
+    success &= VERIFY(dropt_find_subcommand(context, T("")) == NULL);
+
+    {
+        dropt_char* args[] = { T("-v"), T("commit"), T("-a"), T("--color"),
+                               T("-m"), T("hello"), T("file"), NULL };
+
+        subcommandVal = 0;
+        subcommandGlobalVal = 0;
+        stringVal = NULL;
+
+        rest = dropt_parse(context, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+        success &= VERIFY(rest == &args[1]);
+        success &= VERIFY(subcommandGlobalVal == 1);
+
+        subcommand = dropt_find_subcommand(context, *rest);
+        success &= VERIFY(subcommand == &subcommands[0]);
+
+        child = dropt_get_subcommand_context(context, subcommand);
+        if (child == NULL)
+        {
+            fputts(T("Insufficient memory.\n"), stderr);
+            success = false;
+            goto exit;
+        }
+        success &= VERIFY(dropt_get_subcommand_context(context, subcommand) == child);
+        success &= VERIFY(dropt_get_options(child) == commitOptions);
+
+        /* Global options may follow the subcommand. */
+        rest = dropt_parse(child, -1, rest + 1);
+        success &= VERIFY(get_and_print_dropt_error(child) == dropt_error_none);
+        success &= VERIFY(rest == &args[6]);
+        success &= VERIFY(subcommandVal == 1);
+        success &= VERIFY(subcommandGlobalVal == 2);
+        success &= VERIFY(string_equal(stringVal, T("hello")));
+    }
+
+    /* The error handler is inherited, but other subcommands' options
+     * aren't visible.
+     */
+    {
+        dropt_char* args[] = { T("--short"), NULL };
+        rest = dropt_parse(child, -1, args);
+        success &= VERIFY(dropt_get_error(child) == dropt_error_invalid_option);
+        success &= VERIFY(dropt_get_error_message(child) != NULL);
+        dropt_clear_error(child);
+    }
+
+    /* Inherited options are numbered after the subcommand's own on result
+     * tapes.
+     */
+    {
+        dropt_tape_entry tape[4];
+        dropt_char* args[] = { T("-v"), T("-a"), T("--color"), NULL };
+
+        dropt_set_result_tape(child, tape, ARRAY_LENGTH(tape));
+        rest = dropt_parse(child, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(child) == dropt_error_none);
+        success &= VERIFY(dropt_get_tape_length(child) == 3);
+        success &= VERIFY(tape[0].option_index == ARRAY_LENGTH(commitOptions) - 1);
+        success &= VERIFY(tape[1].option_index == 0);
+        success &= VERIFY(tape[2].option_index == ARRAY_LENGTH(commitOptions));
+        dropt_set_result_tape(child, NULL, 0);
+    }
+
+    /* Frozen contexts share their subcommand hash with parse contexts,
+     * which create their own subcommand contexts.
+     */
+    success &= VERIFY(dropt_freeze_context(context) == dropt_error_none);
+    parseContext = dropt_new_parse_context(context);
+    if (parseContext == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    {
+        dropt_char* args[] = { T("status"), T("-sv"), NULL };
+
+        subcommandVal = 0;
+        subcommandGlobalVal = 0;
+
+        subcommand = dropt_find_subcommand(parseContext, args[0]);
+        success &= VERIFY(subcommand == &subcommands[1]);
+        child = dropt_get_subcommand_context(parseContext, subcommand);
+        if (child == NULL)
+        {
+            fputts(T("Insufficient memory.\n"), stderr);
+            success = false;
+            goto exit;
+        }
+
+        rest = dropt_parse(child, -1, &args[1]);
+        success &= VERIFY(get_and_print_dropt_error(child) == dropt_error_none);
+        success &= VERIFY(subcommandVal == 2);
+        success &= VERIFY(subcommandGlobalVal == 1);
+    }
+
+    /* Test many subcommands. */
+    for (i = 0; i < num_generated_options; i++)
+    {
+        generatedSubcommands[i].name = generatedNames[i];
+        generatedSubcommands[i].options = generatedOptions;
+        generatedSubcommands[i].description = NULL;
+    }
+    generatedSubcommands[num_generated_options].name = NULL;
+
+    dropt_set_subcommands(generatedContext, generatedSubcommands);
+    for (i = 0; i < num_generated_options; i++)
+    {
+        success &= VERIFY(dropt_find_subcommand(generatedContext, generatedNames[i])
+                          == &generatedSubcommands[i]);
+    }
+    success &= VERIFY(dropt_find_subcommand(generatedContext, T("opt")) == NULL);
+
+    {
+        dropt_char* args[] = { T("--opt92"), T("-v"), NULL };
+
+        generatedVal = 0;
+        subcommandGlobalVal = 0;
+
+        child = dropt_get_subcommand_context(generatedContext,
+                                             &generatedSubcommands[2999]);
+        if (child == NULL)
+        {
+            fputts(T("Insufficient memory.\n"), stderr);
+            success = false;
+            goto exit;
+        }
+
+        rest = dropt_parse(child, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(child) == dropt_error_none);
+        success &= VERIFY(generatedVal == 29);
+        success &= VERIFY(subcommandGlobalVal == 1);
+    }
+
+    /* Replacing the subcommands frees their contexts. */
+    dropt_set_subcommands(generatedContext, NULL);
+    success &= VERIFY(dropt_find_subcommand(generatedContext, generatedNames[0]) == NULL);
+
+    /* An exact match in an ancestor takes precedence over an abbreviation
+     * in the subcommand.
+     */
+    verbContext = dropt_new_context(verbGlobalOptions);
+    if (verbContext == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+    dropt_set_error_handler(verbContext, my_dropt_error_handler, NULL);
+    dropt_allow_abbreviations(verbContext, 1);
+    dropt_set_subcommands(verbContext, runSubcommands);
+
+    child = dropt_get_subcommand_context(verbContext, &runSubcommands[0]);
+    if (child == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    {
+        dropt_char* args[] = { T("--verb"), NULL };
+
+        subcommandVal = 0;
+        subcommandGlobalVal = 0;
+
+        rest = dropt_parse(child, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(child) == dropt_error_none);
+        success &= VERIFY(subcommandGlobalVal == 3);
+        success &= VERIFY(subcommandVal == 0);
+    }
+
+    {
+        dropt_char* args[] = { T("--verba"), NULL };
+
+        subcommandVal = 0;
+        subcommandGlobalVal = 0;
+
+        rest = dropt_parse(child, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(child) == dropt_error_none);
+        success &= VERIFY(subcommandGlobalVal == 0);
+        success &= VERIFY(subcommandVal == 3);
+    }
+
+exit:
+    dropt_free_context(verbContext);
+    dropt_free_context(generatedContext);
+    dropt_free_context(parseContext);
+    dropt_free_context(context);
+    return success;
+}
+
+
+static dropt_uintptr compositeVal;
+
+static dropt_option loggingOptions[] = {
+    { T('v'), T("verbose"), NULL, NULL, dropt_handle_const, &compositeVal, 0, 1 },
+    { T('q'), T("quiet"), NULL, NULL, dropt_handle_const, &compositeVal, 0, 2 },
+    { 0 }
+};
+
+static dropt_option tracingOptions[] = {
+    { T('t'), T("trace"), NULL, NULL, dropt_handle_const, &compositeVal, 0, 3 },
+    { T('\0'), T("verbose"), NULL, NULL, dropt_handle_const, &compositeVal, 0, 4 },
+    { T('\0'), T("trace-file"), NULL, NULL, dropt_handle_const, &compositeVal, 0, 5 },
+    { 0 }
+};
+
+static dropt_option storageOptions[] = {
+    { T('d'), T("dir"), NULL, NULL, dropt_handle_const, &compositeVal, 0, 6 },
+    { T('\0'), T("opt92"), NULL, NULL, dropt_handle_const, &compositeVal, 0, 7 },
+    { T('\0'), T("alpha"), NULL, NULL, dropt_handle_const, &compositeVal, 0, 8 },
+    { 0 }
+};
+
+
+static bool
+test_composite_contexts(void)
+{
+    bool success = true;
+    dropt_context* parts[3] = { NULL, NULL, NULL };
+    dropt_context* generatedParts[2] = { NULL, NULL };
+    dropt_context* sortedParts[2] = { NULL, NULL };
+    dropt_context* context = NULL;
+    dropt_context* generatedContext = NULL;
+    dropt_context* sortedContext = NULL;
+    void* mergedIndex = NULL;
+    void* sortedIndex = NULL;
+    const dropt_option* candidates[4];
+    size_t indexSize;
+    size_t i;
+
+    parts[0] = dropt_new_context(loggingOptions);
+    parts[1] = dropt_new_context(tracingOptions);
+    parts[2] = dropt_new_context(storageOptions);
+    if (parts[0] == NULL || parts[1] == NULL || parts[2] == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    /* Frozen parts can be shared. */
+    success &= VERIFY(dropt_freeze_context(parts[1]) == dropt_error_none);
+
+    context = dropt_new_composite_context(parts, ARRAY_LENGTH(parts));
+    if (context == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    dropt_set_error_handler(context, my_dropt_error_handler, NULL);
+
+    success &= VERIFY(dropt_get_options(context) == NULL);
+    success &= VERIFY(dropt_get_option(context, 0) == &loggingOptions[0]);
+    success &= VERIFY(dropt_get_option(context, 3) == &tracingOptions[1]);
+    success &= VERIFY(dropt_get_option(context, 7) == &storageOptions[2]);
+    success &= VERIFY(dropt_get_option(context, 8) == NULL);
+
+    {
+        static const struct
+        {
+            const dropt_char* arg;
+            dropt_uintptr expected;
+        } tests[] = {
+            /* The first of any options with the same name wins. */
+            { T("--verbose"), 1 },
+            { T("-q"), 2 },
+            { T("-t"), 3 },
+            { T("--trace-file"), 5 },
+            { T("-d"), 6 },
+            { T("--alpha"), 8 }
+        };
+
+        for (i = 0; i < ARRAY_LENGTH(tests); i++)
+        {
+            dropt_char* args[2];
+            args[0] = (dropt_char*) tests[i].arg;
+            args[1] = NULL;
+
+            compositeVal = 0;
+            dropt_parse(context, -1, args);
+            success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+            success &= VERIFY(compositeVal == tests[i].expected);
+        }
+    }
+
+    {
+        dropt_char* args[] = { T("--bogus"), NULL };
+        dropt_parse(context, -1, args);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+        dropt_clear_error(context);
+    }
+
+    /* Options are numbered through each part in turn. */
+    {
+        dropt_tape_entry tape[2];
+        dropt_char* args[] = { T("-q"), T("--dir"), NULL };
+
+        dropt_set_result_tape(context, tape, ARRAY_LENGTH(tape));
+        dropt_parse(context, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+        success &= VERIFY(dropt_get_tape_length(context) == 2);
+        success &= VERIFY(dropt_get_option(context, tape[0].option_index) == &loggingOptions[1]);
+        success &= VERIFY(dropt_get_option(context, tape[1].option_index) == &storageOptions[0]);
+        dropt_set_result_tape(context, NULL, 0);
+    }
+
+    /* The parts' comparisons no longer match ours, so the index is sorted
+     * instead of merged.
+     */
+    dropt_set_case_insensitive(context, 1);
+    dropt_allow_abbreviations(context, 1);
+
+    {
+        dropt_char* args[] = { T("--TRACE-F"), T("--tr"), NULL };
+
+        compositeVal = 0;
+        dropt_parse(context, 1, args);
+        success &= VERIFY(get_and_print_dropt_error(context) == dropt_error_none);
+        success &= VERIFY(compositeVal == 5);
+
+        dropt_parse(context, 1, &args[1]);
+        success &= VERIFY(dropt_get_error(context) == dropt_error_ambiguous_option);
+        success &= VERIFY(dropt_get_error_candidates(context, candidates,
+                                                     ARRAY_LENGTH(candidates))
+                          == 2);
+        success &= VERIFY(candidates[0] == &tracingOptions[0]);
+        success &= VERIFY(candidates[1] == &tracingOptions[2]);
+        dropt_clear_error(context);
+    }
+
+    /* Test large parts.  Merging the parts' indices should give the same
+     * index as sorting all of the names.
+     */
+    generatedParts[0] = dropt_new_context(generatedOptions);
+    generatedParts[1] = dropt_new_context(storageOptions);
+    sortedParts[0] = dropt_new_context(generatedOptions);
+    sortedParts[1] = dropt_new_context(storageOptions);
+    if (   generatedParts[0] == NULL || generatedParts[1] == NULL
+        || sortedParts[0] == NULL || sortedParts[1] == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    dropt_set_strncmp(sortedParts[0], dropt_strnicmp);
+    dropt_set_strncmp(sortedParts[1], dropt_strnicmp);
+
+    generatedContext = dropt_new_composite_context(generatedParts,
+                                                   ARRAY_LENGTH(generatedParts));
+    sortedContext = dropt_new_composite_context(sortedParts,
+                                                ARRAY_LENGTH(sortedParts));
+    if (generatedContext == NULL || sortedContext == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    dropt_set_error_handler(generatedContext, my_dropt_error_handler, NULL);
+    success &= test_generated_option_lookups(generatedContext);
+
+    {
+        dropt_char* args[] = { T("--alpha"), NULL };
+
+        compositeVal = 0;
+        dropt_parse(generatedContext, -1, args);
+        success &= VERIFY(get_and_print_dropt_error(generatedContext) == dropt_error_none);
+        success &= VERIFY(compositeVal == 8);
+    }
+
+    indexSize = dropt_serialize_index(generatedContext, NULL, 0);
+    success &= VERIFY(indexSize != 0);
+    success &= VERIFY(dropt_serialize_index(sortedContext, NULL, 0) == indexSize);
+
+    mergedIndex = malloc(indexSize);
+    sortedIndex = malloc(indexSize);
+    if (mergedIndex == NULL || sortedIndex == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    success &= VERIFY(dropt_serialize_index(generatedContext, mergedIndex, indexSize)
+                      == indexSize);
+    success &= VERIFY(dropt_serialize_index(sortedContext, sortedIndex, indexSize)
+                      == indexSize);
+    success &= VERIFY(memcmp(mergedIndex, sortedIndex, indexSize) == 0);
+
+exit:
+    free(sortedIndex);
+    free(mergedIndex);
+    dropt_free_context(sortedContext);
+    dropt_free_context(generatedContext);
+    dropt_free_context(context);
+    for (i = 0; i < ARRAY_LENGTH(sortedParts); i++)
+    {
+        dropt_free_context(sortedParts[i]);
+        dropt_free_context(generatedParts[i]);
+    }
+    for (i = 0; i < ARRAY_LENGTH(parts); i++)
+    {
+        dropt_free_context(parts[i]);
+    }
+    return success;
+}
+
+
+#ifdef DROPT_USE_WCHAR
+int
+wmain(int argc, wchar_t** argv)
+#else
+int
+main(int argc, char** argv)
+#endif
+{
+    dropt_char** rest;
+    dropt_context* droptContext = NULL;
+
+    bool success = test_strings();
+    if (!success) { goto exit; }
+
+    droptContext = dropt_new_context(options);
+    if (droptContext == NULL)
+    {
+        fputts(T("Insufficient memory.\n"), stderr);
+        success = false;
+        goto exit;
+    }
+
+    success = test_dropt_handlers(droptContext);
+    if (!success) { goto exit; }
+
+    dropt_set_error_handler(droptContext, my_dropt_error_handler, NULL);
+
+    init_option_defaults();
+    success = test_dropt_parse(droptContext);
+    if (!success) { goto exit; }
+
+    success = test_dropt_parse_batch(droptContext);
+    if (!success) { goto exit; }
+
+    success = test_dropt_result_tape(droptContext);
+    if (!success) { goto exit; }
+
+    success = test_dropt_parse_source(droptContext);
+    if (!success) { goto exit; }
+
+    success = test_dropt_parse_chunk(droptContext);
+    if (!success) { goto exit; }
+
+    success = test_allocators();
+    if (!success) { goto exit; }
+
+    success = test_arena_context();
+    if (!success) { goto exit; }
+
+    success = test_deferred_error_details();
+    if (!success) { goto exit; }
+
+    success = test_split_command_line();
+    if (!success) { goto exit; }
+
+    success = test_response_files();
+    if (!success) { goto exit; }
+
+    init_option_defaults();
+    dropt_enable_hashed_lookup(droptContext, 1);
+    success = test_dropt_parse(droptContext);
+    dropt_enable_hashed_lookup(droptContext, 0);
+    if (!success) { goto exit; }
+
+    init_generated_options();
+    success = test_large_option_table(false) && test_large_option_table(true);
+    if (!success) { goto exit; }
+
+    success = test_mismatched_index(false) && test_mismatched_index(true);
+    if (!success) { goto exit; }
+
+    success = test_arena_lookup_tables();
+    if (!success) { goto exit; }
+
+    success = test_case_insensitive(false) && test_case_insensitive(true);
+    if (!success) { goto exit; }
+
+    success = test_abbreviations(false) && test_abbreviations(true);
+    if (!success) { goto exit; }
+
+    success = test_suggestions();
+    if (!success) { goto exit; }
+
+    success = test_subcommands();
+    if (!success) { goto exit; }
+
+    success = test_composite_contexts();
     if (!success) { goto exit; }
 
     init_option_defaults();
@@ -0,0 +1,136 @@
+/** test_dropt_gen.c
+  *
+  * Unit tests for dropt_gen.  test_dropt_gen_options.spec is compiled
+  * into an option table when building.
+  *
+  * Copyright (C) 2007-2018 James D. Lin <jamesdlin@berkeley.edu>
+  *
+  * This software is provided 'as-is', without any express or implied
+  * warranty.  In no event will the authors be held liable for any damages
+  * arising from the use of this software.
+  *
+  * Permission is granted to anyone to use this software for any purpose,
+  * including commercial applications, and to alter it and redistribute it
+  * freely, subject to the following restrictions:
+  *
+  * 1. The origin of this software must not be misrepresented; you must not
+  *    claim that you wrote the original software. If you use this software
+  *    in a product, an acknowledgment in the product documentation would be
+  *    appreciated but is not required.
+  * 2. Altered source versions must be plainly marked as such, and must not be
+  *    misrepresented as being the original software.
+  * 3. This notice may not be removed or altered from any source distribution.
+  */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dropt.h"
+#include "dropt_string.h"
+#include "test_dropt_gen.h"
+#include "test_dropt_gen_options.h"
+
+#define T(s) DROPT_TEXT_LITERAL(s)
+
+#if __STDC_VERSION__ >= 199901L
+    #include <stdbool.h>
+#else
+    typedef enum { false, true } bool;
+#endif
+
+
+dropt_bool genShowHelp;
+dropt_bool genVerbose;
+dropt_bool genQuiet;
+unsigned int genLevel;
+dropt_char* genName;
+
+
+#define VERIFY(expr) verify(expr, #expr, __LINE__)
+static bool
+verify(bool b, const char* s, unsigned int line)
+{
+    if (!b) { fprintf(stderr, "FAILED: %s (line: %u)\n", s, line); }
+    return b;
+}
+
+
+static bool
+test_parse(dropt_context* context)
+{
+    bool success = true;
+    dropt_char** rest;
+
+    dropt_char* args[] = {
+        T("-v"), T("--level-of-detail=7"), T("--name"), T("dropt"), T("-q"),
+        T("operand"), NULL
+    };
+
+    genShowHelp = 0;
+    genVerbose = 0;
+    genQuiet = 0;
+    genLevel = 0;
+    genName = NULL;
+
+    rest = dropt_parse(context, -1, args);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_none);
+    success &= VERIFY(rest == &args[5]);
+    success &= VERIFY(genVerbose && genQuiet && !genShowHelp);
+    success &= VERIFY(genLevel == 7);
+    success &= VERIFY(   genName != NULL
+                      && dropt_strcmp(genName, T("dropt")) == 0);
+
+    {
+        dropt_char* badArgs[] = { T("--verb"), NULL };
+        dropt_parse(context, -1, badArgs);
+        success &= VERIFY(dropt_get_error(context)
+                          == dropt_error_invalid_option);
+        dropt_clear_error(context);
+    }
+
+    return success;
+}
+
+
+int
+main(void)
+{
+    bool success = true;
+    dropt_context* context;
+    const void* index;
+    size_t indexSize;
+
+    /* The description-only line is part of the table. */
+    success &= VERIFY(test_gen_options[0].description != NULL);
+    success &= VERIFY(test_gen_options[0].long_name == NULL);
+    success &= VERIFY(test_gen_options[5].short_name == T('q'));
+    success &= VERIFY(test_gen_options[6].long_name == NULL);
+
+    /* The generated index must be usable as is. */
+    index = test_gen_options_get_index(&indexSize);
+    context = dropt_new_context_from_index(test_gen_options, index,
+                                           indexSize);
+    success &= VERIFY(context != NULL);
+    if (context != NULL)
+    {
+        success &= test_parse(context);
+        dropt_free_context(context);
+    }
+
+    context = test_gen_options_new_context();
+    success &= VERIFY(context != NULL);
+    if (context != NULL)
+    {
+        success &= test_parse(context);
+        dropt_free_context(context);
+    }
+
+    if (!success) { fputs("One or more tests failed.\n", stderr); }
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
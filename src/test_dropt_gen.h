@@ -0,0 +1,41 @@
+/** test_dropt_gen.h
+  *
+  * Declarations used by the option table generated from
+  * test_dropt_gen_options.spec.
+  *
+  * Copyright (C) 2007-2018 James D. Lin <jamesdlin@berkeley.edu>
+  *
+  * This software is provided 'as-is', without any express or implied
+  * warranty.  In no event will the authors be held liable for any damages
+  * arising from the use of this software.
+  *
+  * Permission is granted to anyone to use this software for any purpose,
+  * including commercial applications, and to alter it and redistribute it
+  * freely, subject to the following restrictions:
+  *
+  * 1. The origin of this software must not be misrepresented; you must not
+  *    claim that you wrote the original software. If you use this software
+  *    in a product, an acknowledgment in the product documentation would be
+  *    appreciated but is not required.
+  * 2. Altered source versions must be plainly marked as such, and must not be
+  *    misrepresented as being the original software.
+  * 3. This notice may not be removed or altered from any source distribution.
+  */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+
+#ifndef TEST_DROPT_GEN_H
+#define TEST_DROPT_GEN_H
+
+#include "dropt.h"
+
+extern dropt_bool genShowHelp;
+extern dropt_bool genVerbose;
+extern dropt_bool genQuiet;
+extern unsigned int genLevel;
+extern dropt_char* genName;
+
+#endif /* TEST_DROPT_GEN_H */
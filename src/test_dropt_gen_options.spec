@@ -0,0 +1,12 @@
+# A dropt_gen specification used by test_dropt_gen.c.
+
+name test_gen_options
+include "test_dropt_gen.h"
+hashed
+
+description="Basic options:"
+-h --help description="Shows help." handler=dropt_handle_bool dest=&genShowHelp attr=dropt_attr_halt
+-v --verbose description="Verbose output." handler=dropt_handle_bool dest=&genVerbose
+-l --level-of-detail description="Detail level." arg_description="n" handler=dropt_handle_uint dest=&genLevel
+--name description="A name." arg_description="text" handler=dropt_handle_string dest=&genName
+-q handler=dropt_handle_bool dest=&genQuiet attr=dropt_attr_hidden
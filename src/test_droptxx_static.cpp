@@ -0,0 +1,159 @@
+/** test_droptxx_static.cpp
+  *
+  * Unit tests for droptxx_static.hpp.  Requires C++17.
+  *
+  * Copyright (C) 2007-2018 James D. Lin <jamesdlin@berkeley.edu>
+  *
+  * This software is provided 'as-is', without any express or implied
+  * warranty.  In no event will the authors be held liable for any damages
+  * arising from the use of this software.
+  *
+  * Permission is granted to anyone to use this software for any purpose,
+  * including commercial applications, and to alter it and redistribute it
+  * freely, subject to the following restrictions:
+  *
+  * 1. The origin of this software must not be misrepresented; you must not
+  *    claim that you wrote the original software. If you use this software
+  *    in a product, an acknowledgment in the product documentation would be
+  *    appreciated but is not required.
+  * 2. Altered source versions must be plainly marked as such, and must not be
+  *    misrepresented as being the original software.
+  * 3. This notice may not be removed or altered from any source distribution.
+  */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "droptxx_static.hpp"
+
+#define T(s) DROPT_TEXT_LITERAL(s)
+
+
+static dropt_bool verbose;
+static dropt_bool quiet;
+static unsigned int level;
+static dropt_bool hidden;
+
+static constexpr dropt_option options[] = {
+    { T('v'), T("verbose"), T("Verbose output."), NULL, dropt_handle_bool, &verbose, 0, 0 },
+    { T('q'), T("quiet"), T("Quiet output."), NULL, dropt_handle_bool, &quiet, 0, 0 },
+    { T('l'), T("level-of-detail"), T("Detail level."), T("n"), dropt_handle_uint, &level, 0, 0 },
+    { T('\0'), T("hidden"), NULL, NULL, dropt_handle_bool, &hidden, dropt_attr_hidden, 0 },
+    { T('\0'), T("help"), T("Help."), NULL, dropt_handle_bool, &hidden, 0, 0 },
+    {}
+};
+
+static constexpr auto table = dropt::make_static_table(options);
+
+static_assert(table.size() == 5);
+static_assert(table.options() == options);
+static_assert(table.find_long(T("verbose")) == &options[0]);
+static_assert(table.find_long(T("level-of-detail")) == &options[2]);
+static_assert(table.find_long(T("help")) == &options[4]);
+static_assert(table.find_long(T("hidden")) == &options[3]);
+static_assert(table.find_long(T("verb")) == nullptr);
+static_assert(table.find_long(T("verbosely")) == nullptr);
+static_assert(table.find_short(T('q')) == &options[1]);
+static_assert(table.find_short(T('l')) == &options[2]);
+static_assert(table.find_short(T('x')) == nullptr);
+
+#if    !defined DROPT_USE_WCHAR \
+    && (defined DROPT_STATIC_LITTLE_ENDIAN || defined DROPT_STATIC_BIG_ENDIAN)
+    #define HAVE_STATIC_INDEX 1
+static_assert(table.index_size() != 0);
+#else
+static_assert(table.index_size() == 0);
+#endif
+
+
+#define VERIFY(expr) verify(expr, #expr, __LINE__)
+static bool
+verify(bool b, const char* s, unsigned int line)
+{
+    if (!b) { std::fprintf(stderr, "FAILED: %s (line: %u)\n", s, line); }
+    return b;
+}
+
+
+static bool
+test_parse(dropt_context* context)
+{
+    bool success = true;
+
+    dropt_char arg0[] = T("--verbose");
+    dropt_char arg1[] = T("-q");
+    dropt_char arg2[] = T("--level-of-detail=3");
+    dropt_char arg3[] = T("--hidden");
+    dropt_char arg4[] = T("operand");
+    dropt_char* args[] = { arg0, arg1, arg2, arg3, arg4, NULL };
+
+    verbose = 0;
+    quiet = 0;
+    level = 0;
+    hidden = 0;
+
+    dropt_char** rest = dropt_parse(context, -1, args);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_none);
+    success &= VERIFY(rest == &args[4]);
+    success &= VERIFY(verbose && quiet && hidden);
+    success &= VERIFY(level == 3);
+
+    dropt_char bad[] = T("--verb");
+    dropt_char* badArgs[] = { bad, NULL };
+    dropt_parse(context, -1, badArgs);
+    success &= VERIFY(dropt_get_error(context) == dropt_error_invalid_option);
+    dropt_clear_error(context);
+
+    return success;
+}
+
+
+#ifdef DROPT_USE_WCHAR
+int
+wmain()
+#else
+int
+main()
+#endif
+{
+    bool success = true;
+
+#ifdef HAVE_STATIC_INDEX
+    {
+        // The precomputed index must be accepted as is.
+        dropt_context* context
+            = dropt_new_context_from_index(table.options(), table.index(),
+                                           table.index_size());
+        success &= VERIFY(context != NULL);
+        if (context != NULL)
+        {
+            success &= test_parse(context);
+            dropt_free_context(context);
+        }
+
+        // It matches the index that dropt builds for the same options.
+        context = dropt_new_context(table.options());
+        success &= VERIFY(context != NULL);
+        if (context != NULL)
+        {
+            std::size_t size = dropt_serialize_index(context, NULL, 0);
+            success &= VERIFY(size == table.index_size());
+            dropt_free_context(context);
+        }
+    }
+#endif
+
+    {
+        dropt::context context(table.options(), table.index(),
+                               table.index_size());
+        success &= test_parse(context.raw());
+    }
+
+    if (!success) { std::fputs("One or more tests failed.\n", stderr); }
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}